@@ -0,0 +1,59 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include <zeroeq/directory.h>
+#include <zeroeq/uri.h>
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+volatile std::sig_atomic_t _running = 1;
+
+void _stop(int)
+{
+    _running = 0;
+}
+
+int _usage(const char* name)
+{
+    std::cerr << "Usage: " << name << " [--uri host:port]" << std::endl
+              << "  Runs a directory of publishers and servers until "
+              << "interrupted" << std::endl;
+    return EXIT_FAILURE;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    zeroeq::URI uri;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (::strcmp(argv[i], "--uri") == 0 && i + 1 < argc)
+            uri = zeroeq::URI(argv[++i]);
+        else
+            return _usage(argv[0]);
+    }
+
+    try
+    {
+        zeroeq::Directory directory(uri);
+        std::cout << "export " << zeroeq::ENV_DIRECTORY << "="
+                  << directory.getURI() << std::endl;
+
+        std::signal(SIGINT, _stop);
+        std::signal(SIGTERM, _stop);
+        while (_running)
+            directory.receive(100);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
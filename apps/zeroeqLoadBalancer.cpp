@@ -0,0 +1,90 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include <zeroeq/loadBalancer.h>
+#include <zeroeq/uri.h>
+
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+volatile std::sig_atomic_t _running = 1;
+
+void _stop(int)
+{
+    _running = 0;
+}
+
+int _usage(const char* name)
+{
+    std::cerr << "Usage: " << name
+              << " [--session name] [--uri host:port] [--depth requests]"
+                 " [--stats seconds]"
+              << std::endl
+              << "  Dispatches client requests to the least loaded server of "
+              << "a session until interrupted" << std::endl;
+    return EXIT_FAILURE;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    std::string session = zeroeq::DEFAULT_SESSION;
+    zeroeq::URI uri;
+    size_t depth = 1;
+    unsigned interval = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (::strcmp(argv[i], "--session") == 0 && i + 1 < argc)
+            session = argv[++i];
+        else if (::strcmp(argv[i], "--uri") == 0 && i + 1 < argc)
+            uri = zeroeq::URI(argv[++i]);
+        else if (::strcmp(argv[i], "--depth") == 0 && i + 1 < argc)
+            depth = std::strtoul(argv[++i], nullptr, 10);
+        else if (::strcmp(argv[i], "--stats") == 0 && i + 1 < argc)
+            interval = std::strtoul(argv[++i], nullptr, 10);
+        else
+            return _usage(argv[0]);
+    }
+
+    try
+    {
+        zeroeq::LoadBalancer balancer(uri, session);
+        balancer.setMaxQueueDepth(depth);
+        std::cout << "Balancing session " << balancer.getSession() << " on "
+                  << balancer.getURI() << std::endl;
+
+        std::signal(SIGINT, _stop);
+        std::signal(SIGTERM, _stop);
+
+        using Clock = std::chrono::steady_clock;
+        auto next = Clock::now() + std::chrono::seconds(interval);
+        while (_running)
+        {
+            balancer.receive(100);
+            if (interval == 0 || Clock::now() < next)
+                continue;
+
+            std::cout << balancer.getQueueSize() << " queued requests"
+                      << std::endl;
+            for (const auto& stats : balancer.getStats())
+                std::cout << "  " << stats.uri << ": " << stats.queueDepth
+                          << " outstanding, " << stats.replies << " replies, "
+                          << float(stats.latency) / 1000.f << " ms mean, "
+                          << float(stats.maxLatency) / 1000.f << " ms max"
+                          << std::endl;
+            next += std::chrono::seconds(interval);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
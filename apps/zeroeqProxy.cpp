@@ -0,0 +1,85 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include <zeroeq/proxy.h>
+#include <zeroeq/uri.h>
+
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+volatile std::sig_atomic_t _running = 1;
+
+void _stop(int)
+{
+    _running = 0;
+}
+
+int _usage(const char* name)
+{
+    std::cerr << "Usage: " << name
+              << " [--session name] [--uri host:port] [--stats seconds]"
+              << std::endl
+              << "  Relays the publishers of a session to the subscribers on "
+              << "this node until interrupted" << std::endl;
+    return EXIT_FAILURE;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    std::string session = zeroeq::DEFAULT_SESSION;
+    zeroeq::URI uri;
+    unsigned interval = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (::strcmp(argv[i], "--session") == 0 && i + 1 < argc)
+            session = argv[++i];
+        else if (::strcmp(argv[i], "--uri") == 0 && i + 1 < argc)
+            uri = zeroeq::URI(argv[++i]);
+        else if (::strcmp(argv[i], "--stats") == 0 && i + 1 < argc)
+            interval = std::strtoul(argv[++i], nullptr, 10);
+        else
+            return _usage(argv[0]);
+    }
+
+    try
+    {
+        zeroeq::Proxy proxy(uri, session);
+        std::cout << "Relaying session " << proxy.getSession() << " on "
+                  << proxy.getURI() << std::endl;
+
+        std::signal(SIGINT, _stop);
+        std::signal(SIGTERM, _stop);
+
+        using Clock = std::chrono::steady_clock;
+        auto next = Clock::now() + std::chrono::seconds(interval);
+        zeroeq::Proxy::Stats last;
+        while (_running)
+        {
+            proxy.receive(100);
+            if (interval == 0 || Clock::now() < next)
+                continue;
+
+            const zeroeq::Proxy::Stats& stats = proxy.getStats();
+            std::cout << (stats.messages - last.messages) / interval
+                      << " events/s, "
+                      << (stats.bytes - last.bytes) / interval / 1024
+                      << " KB/s, " << stats.subscriptions << " subscriptions"
+                      << std::endl;
+            last = stats;
+            next += std::chrono::seconds(interval);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,81 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include <zeroeq/recorder.h>
+#include <zeroeq/subscriber.h>
+#include <zeroeq/uri.h>
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace
+{
+volatile std::sig_atomic_t _running = 1;
+
+void _stop(int)
+{
+    _running = 0;
+}
+
+int _usage(const char* name)
+{
+    std::cerr << "Usage: " << name << " [--session name] [--uri host:port]... "
+              << "journal event..." << std::endl
+              << "  Records the given events, identified by their type name, "
+              << "until interrupted" << std::endl;
+    return EXIT_FAILURE;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    std::string session = zeroeq::DEFAULT_SESSION;
+    zeroeq::URIs uris;
+    std::vector<std::string> args;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (::strcmp(argv[i], "--session") == 0 && i + 1 < argc)
+            session = argv[++i];
+        else if (::strcmp(argv[i], "--uri") == 0 && i + 1 < argc)
+            uris.push_back(zeroeq::URI(argv[++i]));
+        else if (argv[i][0] == '-')
+            return _usage(argv[0]);
+        else
+            args.push_back(argv[i]);
+    }
+    if (args.size() < 2)
+        return _usage(argv[0]);
+
+    try
+    {
+        std::unique_ptr<zeroeq::Subscriber> subscriber(
+            uris.empty() ? new zeroeq::Subscriber(session)
+                         : new zeroeq::Subscriber(uris));
+        zeroeq::Recorder recorder(args[0]);
+        for (size_t i = 1; i < args.size(); ++i)
+        {
+            const auto event = zeroeq::make_uint128(args[i]);
+            subscriber->subscribe(event, recorder.getRecordFunc(event));
+        }
+
+        std::signal(SIGINT, _stop);
+        std::signal(SIGTERM, _stop);
+        while (_running)
+            subscriber->receive(100);
+
+        std::cout << "Recorded " << recorder.getNumRecords() << " events to "
+                  << args[0] << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,80 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include <zeroeq/player.h>
+#include <zeroeq/publisher.h>
+#include <zeroeq/uri.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+namespace
+{
+int _usage(const char* name)
+{
+    std::cerr << "Usage: " << name << " [--session name] [--uri host:port] "
+              << "[--speed factor] [--wait ms] journal" << std::endl
+              << "  Replays the journal at the given speed factor, 0 for as "
+              << "fast as possible, after waiting for subscribers to connect"
+              << std::endl;
+    return EXIT_FAILURE;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    std::string session = zeroeq::DEFAULT_SESSION;
+    std::string uri;
+    std::string journal;
+    float speed = 1.f;
+    unsigned wait = 1000;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (::strcmp(argv[i], "--session") == 0 && i + 1 < argc)
+            session = argv[++i];
+        else if (::strcmp(argv[i], "--uri") == 0 && i + 1 < argc)
+            uri = argv[++i];
+        else if (::strcmp(argv[i], "--speed") == 0 && i + 1 < argc)
+            speed = float(std::atof(argv[++i]));
+        else if (::strcmp(argv[i], "--wait") == 0 && i + 1 < argc)
+            wait = unsigned(std::atoi(argv[++i]));
+        else if (argv[i][0] == '-' || !journal.empty())
+            return _usage(argv[0]);
+        else
+            journal = argv[i];
+    }
+    if (journal.empty())
+        return _usage(argv[0]);
+
+    try
+    {
+        std::unique_ptr<zeroeq::Publisher> publisher(
+            uri.empty() ? new zeroeq::Publisher(session)
+                        : new zeroeq::Publisher(zeroeq::URI(uri), session));
+        zeroeq::Player player(journal, *publisher);
+        player.setSpeed(speed);
+
+        std::cout << "Replaying " << player.getNumRecords() << " events on "
+                  << publisher->getURI() << std::endl;
+        std::this_thread::sleep_for(std::chrono::milliseconds(wait));
+
+        const auto start = std::chrono::steady_clock::now();
+        const size_t published = player.play();
+        const std::chrono::duration<float> elapsed =
+            std::chrono::steady_clock::now() - start;
+        std::cout << "Published " << published << " events in "
+                  << elapsed.count() << " s" << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -11,12 +11,15 @@
 
 #include <servus/servus.h>
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <thread>
 
 typedef std::unique_ptr<zeroeq::connection::Broker> BrokerPtr;
+typedef std::vector<std::string> Addresses;
 std::string _broker;
 zeroeq::Publisher* _publisher = 0;
 
@@ -228,6 +231,87 @@ BOOST_AUTO_TEST_CASE(named_broker_port_used)
     _publisher = 0;
 }
 
+BOOST_AUTO_TEST_CASE(concurrent_registration)
+{
+    const size_t numThreads = 100;
+    const size_t numCalls = 10; // per thread
+
+    zeroeq::Subscriber subscriber(zeroeq::NULL_SESSION);
+    zeroeq::connection::Broker broker("127.0.0.1:0", subscriber);
+    const std::string address = broker.getAddress();
+
+    std::atomic<size_t> accepted(0);
+    std::atomic<size_t> running(numThreads);
+    const auto startTime = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < numThreads; ++i)
+        threads.emplace_back([&, i] {
+            for (size_t j = 0; j < numCalls; ++j)
+            {
+                // Publishers are not needed, the subscriber keeps connecting
+                const uint16_t port = uint16_t(20000 + i * numCalls + j);
+                accepted += zeroeq::connection::Service::subscribe(
+                    address, Addresses{"127.0.0.1:" + std::to_string(port)});
+            }
+            --running;
+        });
+
+    while (running > 0)
+        subscriber.receive(10);
+    const auto endTime = std::chrono::high_resolution_clock::now();
+    for (auto& thread : threads)
+        thread.join();
+
+    BOOST_CHECK_EQUAL(accepted, numThreads * numCalls);
+    std::cout << numThreads * numCalls << " concurrent registrations in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                     endTime - startTime)
+                     .count()
+              << " ms" << std::endl;
+
+    // batched registration, the invalid address is not accepted
+    std::thread thread([&] {
+        accepted = zeroeq::connection::Service::subscribe(
+            address,
+            Addresses{"127.0.0.1:19998", "127.0.0.1:19999", "invalid"});
+        running = 1;
+    });
+    while (running == 0)
+        subscriber.receive(10);
+    thread.join();
+    BOOST_CHECK_EQUAL(accepted, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(async_registration)
+{
+    zeroeq::Subscriber subscriber1(zeroeq::NULL_SESSION);
+    zeroeq::Subscriber subscriber2(zeroeq::NULL_SESSION, subscriber1);
+    zeroeq::connection::Broker broker1("127.0.0.1:0", subscriber1);
+    zeroeq::connection::Broker broker2("127.0.0.1:0", subscriber2);
+    const Addresses addresses{"127.0.0.1:19996", "127.0.0.1:19997"};
+
+    zeroeq::connection::Service service(500 /*ms*/);
+    for (size_t i = 0; i < 2; ++i) // second round uses cached connections
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        auto result1 = service.subscribeAsync(broker1.getAddress(), addresses);
+        auto result2 = service.subscribeAsync(broker2.getAddress(), addresses);
+        auto unreachable = service.subscribeAsync("127.0.0.1:1", addresses);
+
+        while (unreachable.wait_for(std::chrono::milliseconds(0)) !=
+               std::future_status::ready)
+        {
+            subscriber1.receive(10);
+        }
+        BOOST_CHECK_EQUAL(result1.get(), 2u);
+        BOOST_CHECK_EQUAL(result2.get(), 2u);
+        BOOST_CHECK_EQUAL(unreachable.get(), 0u);
+        BOOST_CHECK(std::chrono::steady_clock::now() - startTime >=
+                    std::chrono::milliseconds(500));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(invalid_broker)
 {
     zeroeq::Subscriber subscriber(zeroeq::URI("127.0.0.1:1234"));
@@ -235,3 +319,25 @@ BOOST_AUTO_TEST_CASE(invalid_broker)
                                                  subscriber),
                       std::runtime_error);
 }
+
+BOOST_AUTO_TEST_CASE(slow_broker_registration)
+{
+    zeroeq::Subscriber subscriber(zeroeq::NULL_SESSION);
+    zeroeq::connection::Broker broker("127.0.0.1:0", subscriber);
+    zeroeq::connection::Service service(500 /*ms*/);
+
+    // the broker does not answer before the first request times out
+    const std::string address = broker.getAddress();
+    auto early = service.subscribeAsync(address, Addresses{"127.0.0.1:19994"});
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    auto late = service.subscribeAsync(address, Addresses{"127.0.0.1:19995"});
+    BOOST_CHECK_EQUAL(early.get(), 0u);
+
+    // the timeout of the first request does not fail the second one
+    while (late.wait_for(std::chrono::milliseconds(0)) !=
+           std::future_status::ready)
+    {
+        subscriber.receive(10);
+    }
+    BOOST_CHECK_EQUAL(late.get(), 1u);
+}
@@ -0,0 +1,92 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#define BOOST_TEST_MODULE zeroeq_directory
+
+#include "common.h"
+
+#include <zeroeq/detail/constants.h>
+#include <zeroeq/detail/registration.h>
+#include <zeroeq/detail/sender.h>
+
+#include <chrono>
+
+namespace
+{
+const auto event = zeroeq::make_uint128("zeroeq::test::Directory");
+const std::string session("zeroeq_test_directory");
+
+bool waitForRegistrations(zeroeq::Directory& directory, const size_t expected)
+{
+    for (size_t i = 0; i < 50; ++i)
+    {
+        if (directory.getNumRegistrations() == expected)
+            return true;
+        directory.receive(100);
+    }
+    return false;
+}
+}
+
+BOOST_AUTO_TEST_CASE(register_discover)
+{
+    zeroeq::Directory directory(zeroeq::URI("127.0.0.1"));
+    setenv(zeroeq::ENV_DIRECTORY.c_str(),
+           std::to_string(directory.getURI()).c_str(), 1);
+    {
+        zeroeq::Publisher publisher(session);
+        BOOST_CHECK(waitForRegistrations(directory, 1));
+
+        zeroeq::detail::Sender::getUUID() =
+            servus::make_UUID(); // different process
+        zeroeq::Subscriber subscriber(session);
+        bool received = false;
+        BOOST_CHECK(subscriber.subscribe(event, [&] { received = true; }));
+
+        for (size_t i = 0; i < 200 && !received; ++i)
+        {
+            publisher.publish(event);
+            directory.receive(10);
+            subscriber.receive(10);
+        }
+        BOOST_CHECK(received);
+    }
+    unsetenv(zeroeq::ENV_DIRECTORY.c_str());
+
+    // unregistered on destruction
+    BOOST_CHECK(waitForRegistrations(directory, 0));
+}
+
+BOOST_AUTO_TEST_CASE(lease_expiry)
+{
+    zeroeq::Directory directory(zeroeq::URI("127.0.0.1"));
+    zeroeq::Client client({directory.getURI()});
+
+    const zeroeq::detail::Registration registration{
+        PUBLISHER_SERVICE, "localhost:1234", {{KEY_SESSION, session}}};
+    const std::string request = "1\n" + registration.getKey() + '\t' +
+                                zeroeq::detail::serialize(
+                                    registration.properties) +
+                                '\n';
+
+    std::string accepted;
+    BOOST_CHECK(client.request(DIRECTORY_REGISTER, request.data(),
+                               request.size(),
+                               [&](const zeroeq::uint128_t&, const void* data,
+                                   const size_t size) {
+                                   accepted.assign((const char*)data, size);
+                               }));
+    BOOST_CHECK(directory.receive(1000));
+    BOOST_CHECK(client.receive(1000));
+    BOOST_CHECK_EQUAL(accepted, "1");
+    BOOST_CHECK_EQUAL(directory.getNumRegistrations(), 1u);
+
+    // not renewed within one second
+    const auto start = std::chrono::steady_clock::now();
+    BOOST_CHECK(waitForRegistrations(directory, 0));
+    BOOST_CHECK_GE(std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count(),
+                   900);
+}
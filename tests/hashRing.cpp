@@ -0,0 +1,122 @@
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#define BOOST_TEST_MODULE zeroeq_hash_ring
+
+#include <zeroeq/detail/hashRing.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+const size_t numKeys = 10000;
+const size_t numNodes = 10;
+
+std::string getNode(const size_t index)
+{
+    return "tcp://node" + std::to_string(index) + ":1234";
+}
+
+/** @return the owner of each key. */
+std::vector<std::string> getOwners(const zeroeq::detail::HashRing& ring)
+{
+    std::vector<std::string> owners;
+    for (size_t i = 0; i < numKeys; ++i)
+    {
+        const std::string key = "dataset" + std::to_string(i);
+        const std::string* owner =
+            ring.find(zeroeq::detail::HashRing::hash(key.data(), key.size()),
+                      [](const std::string&) { return true; });
+        BOOST_REQUIRE(owner);
+        owners.push_back(*owner);
+    }
+    return owners;
+}
+}
+
+BOOST_AUTO_TEST_CASE(empty)
+{
+    const zeroeq::detail::HashRing ring;
+    BOOST_CHECK_EQUAL(ring.size(), 0u);
+    BOOST_CHECK(!ring.find(42, [](const std::string&) { return true; }));
+}
+
+BOOST_AUTO_TEST_CASE(balance)
+{
+    zeroeq::detail::HashRing ring;
+    for (size_t i = 0; i < numNodes; ++i)
+        ring.add(getNode(i));
+    ring.add(getNode(0)); // no-op
+    BOOST_CHECK_EQUAL(ring.size(), numNodes);
+
+    std::map<std::string, size_t> counts;
+    for (const auto& owner : getOwners(ring))
+        ++counts[owner];
+    BOOST_CHECK_EQUAL(counts.size(), numNodes);
+    for (const auto& count : counts)
+    {
+        BOOST_CHECK_GT(count.second, numKeys / numNodes / 2);
+        BOOST_CHECK_LT(count.second, numKeys / numNodes * 2);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(join_and_leave)
+{
+    zeroeq::detail::HashRing ring;
+    for (size_t i = 0; i < numNodes; ++i)
+        ring.add(getNode(i));
+    const std::vector<std::string> before = getOwners(ring);
+
+    // only keys of the joined node move, about 1/(N+1) of all keys
+    const std::string joined = getNode(numNodes);
+    ring.add(joined);
+    const std::vector<std::string> joinedOwners = getOwners(ring);
+    size_t moved = 0;
+    for (size_t i = 0; i < numKeys; ++i)
+    {
+        if (joinedOwners[i] == before[i])
+            continue;
+        BOOST_CHECK_EQUAL(joinedOwners[i], joined);
+        ++moved;
+    }
+    BOOST_CHECK_GT(moved, numKeys / (numNodes + 1) / 2);
+    BOOST_CHECK_LT(moved, numKeys / (numNodes + 1) * 2);
+
+    // only keys of the leaving node move, about 1/N of all keys
+    const std::string left = getNode(0);
+    ring.remove(left);
+    ring.remove(left); // no-op
+    BOOST_CHECK_EQUAL(ring.size(), numNodes);
+    const std::vector<std::string> leftOwners = getOwners(ring);
+    moved = 0;
+    for (size_t i = 0; i < numKeys; ++i)
+    {
+        if (leftOwners[i] == joinedOwners[i])
+            continue;
+        BOOST_CHECK_EQUAL(joinedOwners[i], left);
+        ++moved;
+    }
+    BOOST_CHECK_GT(moved, numKeys / numNodes / 2);
+    BOOST_CHECK_LT(moved, numKeys / numNodes * 2);
+}
+
+BOOST_AUTO_TEST_CASE(filter)
+{
+    zeroeq::detail::HashRing ring;
+    for (size_t i = 0; i < numNodes; ++i)
+        ring.add(getNode(i));
+
+    // a rejected owner is replaced by the next node on the ring
+    const uint64_t key = zeroeq::detail::HashRing::hash("key", 3);
+    const std::string owner =
+        *ring.find(key, [](const std::string&) { return true; });
+    const std::string* next =
+        ring.find(key, [&](const std::string& node) { return node != owner; });
+    BOOST_REQUIRE(next);
+    BOOST_CHECK_NE(*next, owner);
+    BOOST_CHECK(!ring.find(key, [](const std::string&) { return false; }));
+}
@@ -0,0 +1,89 @@
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#define BOOST_TEST_MODULE zeroeq_hash_trie
+
+#include <zeroeq/detail/hashTrie.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <string>
+
+namespace
+{
+using Trie = zeroeq::detail::HashTrie<int>;
+const int numKeys = 10000;
+
+bool equals(const Trie& trie, const std::map<std::string, int>& expected)
+{
+    if (trie.size() != expected.size())
+        return false;
+
+    size_t visited = 0;
+    bool equal = true;
+    trie.forEach([&](const std::string& key, const int value) {
+        const auto i = expected.find(key);
+        equal = equal && i != expected.end() && i->second == value;
+        ++visited;
+    });
+    return equal && visited == expected.size();
+}
+}
+
+BOOST_AUTO_TEST_CASE(empty)
+{
+    const Trie trie;
+    BOOST_CHECK(trie.empty());
+    BOOST_CHECK(!trie.find("key"));
+    BOOST_CHECK(trie.erase("key").empty());
+}
+
+BOOST_AUTO_TEST_CASE(set_and_erase)
+{
+    Trie trie;
+    std::map<std::string, int> expected;
+    for (int i = 0; i < numKeys; ++i)
+    {
+        const std::string key = "key" + std::to_string(i);
+        trie = trie.set(key, i);
+        expected[key] = i;
+    }
+    BOOST_CHECK(equals(trie, expected));
+
+    for (int i = 0; i < numKeys; i += 2)
+    {
+        const std::string key = "key" + std::to_string(i);
+        trie = trie.set(key, -i).erase("key" + std::to_string(i + 1));
+        expected[key] = -i;
+        expected.erase("key" + std::to_string(i + 1));
+    }
+    BOOST_CHECK(equals(trie, expected));
+    BOOST_REQUIRE(trie.find("key42"));
+    BOOST_CHECK_EQUAL(*trie.find("key42"), -42);
+    BOOST_CHECK(!trie.find("key43"));
+
+    for (int i = 0; i < numKeys; ++i)
+        trie = trie.erase("key" + std::to_string(i));
+    BOOST_CHECK(trie.empty());
+    BOOST_CHECK(!trie.find("key42"));
+}
+
+BOOST_AUTO_TEST_CASE(versions)
+{
+    Trie trie;
+    for (int i = 0; i < 100; ++i)
+        trie = trie.set("key" + std::to_string(i), i);
+
+    const Trie modified = trie.set("key1", -1).erase("key2").set("new", 0);
+    BOOST_CHECK_EQUAL(trie.size(), 100);
+    BOOST_CHECK_EQUAL(*trie.find("key1"), 1);
+    BOOST_CHECK(trie.find("key2"));
+    BOOST_CHECK(!trie.find("new"));
+
+    BOOST_CHECK_EQUAL(modified.size(), 100);
+    BOOST_CHECK_EQUAL(*modified.find("key1"), -1);
+    BOOST_CHECK(!modified.find("key2"));
+    BOOST_CHECK_EQUAL(*modified.find("new"), 0);
+    BOOST_CHECK_EQUAL(*modified.find("key99"), 99);
+}
@@ -0,0 +1,253 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#define BOOST_TEST_MODULE zeroeq_history
+
+#include "common.h"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <dirent.h>
+#endif
+
+namespace
+{
+const auto event = zeroeq::make_uint128("zeroeq::test::History");
+
+std::string historyName(const std::string& test)
+{
+    return "zeroeq.test." + test + "." + std::to_string(getpid());
+}
+
+void removeHistory(const std::string& directory)
+{
+#ifndef _WIN32
+    DIR* dir = ::opendir(directory.c_str());
+    if (!dir)
+        return;
+    while (const dirent* entry = ::readdir(dir))
+        std::remove((directory + "/" + entry->d_name).c_str());
+    ::closedir(dir);
+    std::remove(directory.c_str());
+#endif
+}
+
+bool publish(zeroeq::Publisher& publisher, const uint64_t value,
+             const size_t size = sizeof(uint64_t))
+{
+    std::vector<uint64_t> payload(size / sizeof(uint64_t), value);
+    return publisher.publish(event, payload.data(),
+                             payload.size() * sizeof(uint64_t));
+}
+
+bool waitForSubscriber(zeroeq::Publisher& publisher)
+{
+    for (size_t i = 0; i < 100; ++i)
+    {
+        if (publisher.hasSubscribers(event))
+            return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+class Viewer
+{
+public:
+    Viewer(const zeroeq::URI& publisher, const zeroeq::URI& server)
+        : subscriber(publisher)
+        , client({server}, subscriber)
+    {
+        BOOST_CHECK(subscriber.subscribe(
+            event,
+            zeroeq::EventPayloadFunc([this](const void* data, size_t) {
+                received.push_back(*static_cast<const uint64_t*>(data));
+            })));
+    }
+
+    bool catchUp(zeroeq::Server& server, const uint64_t sequence)
+    {
+        for (size_t i = 0; i < 100; ++i)
+        {
+            if (subscriber.getSequence(event) == sequence)
+                return true;
+            server.receive(0);
+            subscriber.receive(10);
+        }
+        return false;
+    }
+
+    zeroeq::Subscriber subscriber;
+    zeroeq::Client client;
+    std::vector<uint64_t> received;
+};
+}
+
+BOOST_AUTO_TEST_CASE(catch_up)
+{
+    const auto directory = historyName("catch_up");
+    zeroeq::Publisher publisher(
+        zeroeq::URI("inproc://zeroeq.test.history.catch_up.publisher"),
+        zeroeq::NULL_SESSION);
+    zeroeq::Server server(
+        zeroeq::URI("inproc://zeroeq.test.history.catch_up.server"),
+        zeroeq::NULL_SESSION);
+    publisher.enableHistory(directory);
+    BOOST_CHECK(publisher.serveHistory(server));
+    BOOST_CHECK(!publisher.serveHistory(server));
+
+    for (uint64_t i = 1; i <= 10; ++i) // nobody listens
+        BOOST_CHECK(publish(publisher, i));
+
+    Viewer viewer(publisher.getURI(), server.getURI());
+    BOOST_CHECK_EQUAL(viewer.subscriber.getSequence(event), 0u);
+    BOOST_CHECK(viewer.subscriber.requestHistory(event, 3, viewer.client));
+    BOOST_CHECK(!viewer.subscriber.requestHistory(event, 3, viewer.client));
+
+    for (uint64_t i = 11; i <= 15; ++i) // live while catching up
+        BOOST_CHECK(publish(publisher, i));
+
+    BOOST_CHECK(viewer.catchUp(server, 15));
+    std::vector<uint64_t> expected;
+    for (uint64_t i = 4; i <= 15; ++i)
+        expected.push_back(i);
+    BOOST_CHECK_EQUAL_COLLECTIONS(viewer.received.begin(),
+                                  viewer.received.end(), expected.begin(),
+                                  expected.end());
+
+    // live events after catch-up
+    BOOST_REQUIRE(waitForSubscriber(publisher));
+    BOOST_CHECK(publish(publisher, 16));
+    BOOST_CHECK(viewer.catchUp(server, 16));
+    BOOST_CHECK_EQUAL(viewer.received.back(), 16u);
+    BOOST_CHECK_EQUAL(viewer.received.size(), 13u);
+
+    removeHistory(directory);
+}
+
+BOOST_AUTO_TEST_CASE(restart)
+{
+    const auto directory = historyName("restart");
+    {
+        zeroeq::Publisher publisher(
+            zeroeq::URI("inproc://zeroeq.test.history.restart.publisher"),
+            zeroeq::NULL_SESSION);
+        publisher.enableHistory(directory);
+        for (uint64_t i = 1; i <= 5; ++i)
+            BOOST_CHECK(publish(publisher, i));
+    }
+
+    zeroeq::Publisher publisher(
+        zeroeq::URI("inproc://zeroeq.test.history.restart.restarted"),
+        zeroeq::NULL_SESSION);
+    zeroeq::Server server(zeroeq::URI("inproc://zeroeq.test.history.restart"),
+                          zeroeq::NULL_SESSION);
+    publisher.enableHistory(directory);
+    BOOST_CHECK(publisher.serveHistory(server));
+    BOOST_CHECK(publish(publisher, 6));
+
+    Viewer viewer(publisher.getURI(), server.getURI());
+    BOOST_CHECK(viewer.subscriber.requestHistory(event, 0, viewer.client));
+    BOOST_CHECK(viewer.catchUp(server, 6));
+    BOOST_REQUIRE_EQUAL(viewer.received.size(), 6u);
+    BOOST_CHECK_EQUAL(viewer.received.front(), 1u);
+    BOOST_CHECK_EQUAL(viewer.received.back(), 6u);
+
+    removeHistory(directory);
+}
+
+BOOST_AUTO_TEST_CASE(retention)
+{
+    const auto directory = historyName("retention");
+    zeroeq::Publisher publisher(
+        zeroeq::URI("inproc://zeroeq.test.history.retention.publisher"),
+        zeroeq::NULL_SESSION);
+    zeroeq::Server server(
+        zeroeq::URI("inproc://zeroeq.test.history.retention.server"),
+        zeroeq::NULL_SESSION);
+    publisher.enableHistory(directory, 256 * 1024);
+    BOOST_CHECK(publisher.serveHistory(server));
+
+    const size_t size = 16 * 1024;
+    for (uint64_t i = 1; i <= 100; ++i)
+        BOOST_CHECK(publish(publisher, i, size));
+
+    Viewer viewer(publisher.getURI(), server.getURI());
+    BOOST_CHECK(viewer.subscriber.requestHistory(event, 0, viewer.client));
+    BOOST_CHECK(viewer.catchUp(server, 100));
+    BOOST_CHECK_LT(viewer.received.size(), 100u);
+    BOOST_CHECK_GE(viewer.received.size() * size, 128u * 1024);
+    BOOST_CHECK_EQUAL(viewer.received.back(), 100u);
+
+    removeHistory(directory);
+}
+
+BOOST_AUTO_TEST_CASE(retention_of_idle_events)
+{
+    const auto directory = historyName("retention_of_idle_events");
+    zeroeq::Publisher publisher(
+        zeroeq::URI("inproc://zeroeq.test.history.idle.publisher"),
+        zeroeq::NULL_SESSION);
+    zeroeq::Server server(
+        zeroeq::URI("inproc://zeroeq.test.history.idle.server"),
+        zeroeq::NULL_SESSION);
+    publisher.enableHistory(directory, 256 * 1024, 1);
+    BOOST_CHECK(publisher.serveHistory(server));
+
+    const size_t size = 16 * 1024; // several segments
+    for (uint64_t i = 1; i <= 20; ++i)
+        BOOST_CHECK(publish(publisher, i, size));
+
+    // expired segments are not served, even though nothing was published
+    std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+    Viewer viewer(publisher.getURI(), server.getURI());
+    BOOST_CHECK(viewer.subscriber.requestHistory(event, 0, viewer.client));
+    BOOST_CHECK(viewer.catchUp(server, 20));
+    BOOST_CHECK_LT(viewer.received.size(), 20u);
+    BOOST_CHECK_GT(viewer.received.front(), 1u);
+    BOOST_CHECK_EQUAL(viewer.received.back(), 20u);
+
+    removeHistory(directory);
+}
+
+BOOST_AUTO_TEST_CASE(serve_while_publishing)
+{
+    const auto directory = historyName("serve_while_publishing");
+    zeroeq::Publisher publisher(
+        zeroeq::URI("inproc://zeroeq.test.history.concurrent.publisher"),
+        zeroeq::NULL_SESSION);
+    zeroeq::Server server(
+        zeroeq::URI("inproc://zeroeq.test.history.concurrent.server"),
+        zeroeq::NULL_SESSION);
+    publisher.enableHistory(directory, 256 * 1024);
+    BOOST_CHECK(publisher.serveHistory(server));
+    BOOST_CHECK(publish(publisher, 1));
+
+    Viewer viewer(publisher.getURI(), server.getURI());
+    BOOST_CHECK(waitForSubscriber(publisher));
+
+    // publish and roll segments while the history is served in this thread
+    const uint64_t numEvents = 500;
+    std::thread publishing([&publisher, numEvents] {
+        for (uint64_t i = 2; i <= numEvents; ++i)
+            BOOST_CHECK(publish(publisher, i, 1024));
+    });
+    for (size_t i = 0; i < 20; ++i)
+    {
+        // false while the previous request is pending
+        viewer.subscriber.requestHistory(event, 0, viewer.client);
+        server.receive(0);
+        viewer.subscriber.receive(10);
+    }
+    publishing.join();
+
+    BOOST_CHECK(viewer.catchUp(server, numEvents));
+    BOOST_CHECK_EQUAL(viewer.received.back(), numEvents);
+
+    removeHistory(directory);
+}
@@ -0,0 +1,163 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#define BOOST_TEST_MODULE zeroeq_journal
+
+#include "common.h"
+
+#include <zeroeq/player.h>
+#include <zeroeq/recorder.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+const auto event = zeroeq::make_uint128("zeroeq::test::Journal");
+const auto ready = zeroeq::make_uint128("zeroeq::test::Ready");
+
+std::string journalName(const std::string& test)
+{
+    return "zeroeq.test." + test + "." + std::to_string(getpid()) + ".journal";
+}
+
+void removeJournal(const std::string& filename)
+{
+    std::remove(filename.c_str());
+    std::remove((filename + ".index").c_str());
+}
+
+std::vector<uint8_t> makePayload(const size_t size)
+{
+    std::vector<uint8_t> payload(size);
+    for (size_t i = 0; i < size; ++i)
+        payload[i] = uint8_t(i * 7 + size);
+    return payload;
+}
+
+const std::vector<size_t> sizes{0, 1, 7, 8, 9, 1024, 200000, 3};
+
+void record(const std::string& filename)
+{
+    zeroeq::Recorder recorder(filename);
+    for (const size_t size : sizes)
+    {
+        const auto payload = makePayload(size);
+        BOOST_CHECK(recorder.record(event, payload.data(), payload.size()));
+    }
+    BOOST_CHECK_EQUAL(recorder.getNumRecords(), sizes.size());
+}
+
+// publish until the subscription is established
+bool connect(zeroeq::Publisher& publisher, zeroeq::Subscriber& subscriber)
+{
+    // stays subscribed, pending ready events may arrive during replay
+    auto received = std::make_shared<bool>(false);
+    subscriber.subscribe(ready, [received] { *received = true; });
+    for (size_t i = 0; i < 100 && !*received; ++i)
+    {
+        publisher.publish(ready);
+        subscriber.receive(10);
+    }
+    return *received;
+}
+
+void replay(const std::string& filename)
+{
+    zeroeq::Publisher publisher(
+        zeroeq::URI("inproc://zeroeq.test.journal.replay"),
+        zeroeq::NULL_SESSION);
+    zeroeq::Subscriber subscriber(publisher.getURI());
+
+    std::vector<std::vector<uint8_t>> received;
+    BOOST_CHECK(subscriber.subscribe(
+        event,
+        zeroeq::EventPayloadFunc([&](const void* data, const size_t size) {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            received.emplace_back(bytes, bytes + size);
+        })));
+    BOOST_REQUIRE(connect(publisher, subscriber));
+
+    zeroeq::Player player(filename, publisher);
+    player.setSpeed(zeroeq::Player::SPEED_UNLIMITED);
+    BOOST_CHECK_EQUAL(player.getNumRecords(), sizes.size());
+    BOOST_CHECK_EQUAL(player.play(), sizes.size());
+    BOOST_CHECK_EQUAL(player.getPosition(), sizes.size());
+    BOOST_CHECK(!player.step());
+
+    while (received.size() < sizes.size() && subscriber.receive(1000))
+        /* NOP */;
+    BOOST_REQUIRE_EQUAL(received.size(), sizes.size());
+    for (size_t i = 0; i < sizes.size(); ++i)
+        BOOST_CHECK(received[i] == makePayload(sizes[i]));
+}
+}
+
+BOOST_AUTO_TEST_CASE(record_replay)
+{
+    const auto filename = journalName("record_replay");
+    record(filename);
+    replay(filename);
+    removeJournal(filename);
+}
+
+BOOST_AUTO_TEST_CASE(replay_without_index)
+{
+    const auto filename = journalName("replay_without_index");
+    record(filename);
+    std::remove((filename + ".index").c_str());
+    replay(filename);
+    removeJournal(filename);
+}
+
+BOOST_AUTO_TEST_CASE(replay_pace)
+{
+    const auto filename = journalName("replay_pace");
+    {
+        zeroeq::Recorder recorder(filename);
+        auto func = recorder.getRecordFunc(event);
+        for (size_t i = 0; i < 3; ++i)
+        {
+            func(&i, sizeof(i));
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+
+    zeroeq::Publisher publisher(zeroeq::NULL_SESSION);
+    zeroeq::Player player(filename, publisher);
+    BOOST_CHECK_EQUAL(player.getSpeed(), 1.f);
+
+    auto start = std::chrono::steady_clock::now();
+    BOOST_CHECK_EQUAL(player.play(), 3u);
+    BOOST_CHECK(std::chrono::steady_clock::now() - start >=
+                std::chrono::milliseconds(100));
+
+    player.seek(0);
+    player.setSpeed(4.f);
+    start = std::chrono::steady_clock::now();
+    BOOST_CHECK_EQUAL(player.play(), 3u);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    BOOST_CHECK(elapsed >= std::chrono::milliseconds(25));
+    BOOST_CHECK(elapsed < std::chrono::milliseconds(100));
+    removeJournal(filename);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_journal)
+{
+    zeroeq::Publisher publisher(zeroeq::NULL_SESSION);
+    BOOST_CHECK_THROW(zeroeq::Player("zeroeq.test.nonexistent.journal",
+                                     publisher),
+                      std::runtime_error);
+
+    const auto filename = journalName("invalid_journal");
+    {
+        std::ofstream file(filename);
+        file << "Not a journal, but long enough to have a header";
+    }
+    BOOST_CHECK_THROW(zeroeq::Player(filename, publisher), std::runtime_error);
+    removeJournal(filename);
+}
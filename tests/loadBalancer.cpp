@@ -0,0 +1,91 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#define BOOST_TEST_MODULE zeroeq_load_balancer
+
+#include "common.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+const auto request = zeroeq::make_uint128("zeroeq::test::LoadBalancer");
+
+class Runner
+{
+public:
+    Runner(const std::string& name, const unsigned serviceTime)
+        : server(zeroeq::URI("inproc://zeroeq.test.load_balancer." + name),
+                 zeroeq::NULL_SESSION)
+    {
+        server.handle(request, [serviceTime](const void*, size_t) {
+            std::this_thread::sleep_for(
+                std::chrono::milliseconds(serviceTime));
+            return zeroeq::ReplyData{request, {}};
+        });
+        thread = std::thread([this] {
+            while (running)
+                server.receive(10);
+        });
+    }
+
+    ~Runner()
+    {
+        running = false;
+        thread.join();
+    }
+
+    zeroeq::Server server;
+    std::atomic<bool> running{true};
+    std::thread thread;
+};
+}
+
+BOOST_AUTO_TEST_CASE(least_loaded)
+{
+    Runner fast("fast", 1);
+    Runner slow("slow", 50);
+    zeroeq::LoadBalancer balancer(zeroeq::URIs{fast.server.getURI(),
+                                               slow.server.getURI()},
+                                  zeroeq::URI("inproc://zeroeq.test.balancer"));
+    BOOST_CHECK_EQUAL(balancer.getMaxQueueDepth(), 1u);
+    balancer.setMaxQueueDepth(0);
+    BOOST_CHECK_EQUAL(balancer.getMaxQueueDepth(), 1u);
+
+    zeroeq::Client client(zeroeq::URIs{balancer.getURI()}, balancer);
+    const size_t numRequests = 50;
+    size_t replies = 0;
+    for (size_t i = 0; i < numRequests; ++i)
+        BOOST_CHECK(client.request(request, nullptr, 0,
+                                   [&](const zeroeq::uint128_t& replyID,
+                                       const void*, size_t) {
+                                       BOOST_CHECK_EQUAL(replyID, request);
+                                       ++replies;
+                                   }));
+
+    const auto startTime = std::chrono::steady_clock::now();
+    while (replies < numRequests &&
+           std::chrono::steady_clock::now() - startTime <
+               std::chrono::seconds(10))
+    {
+        client.receive(100);
+    }
+    BOOST_CHECK_EQUAL(replies, numRequests);
+    BOOST_CHECK_EQUAL(balancer.getQueueSize(), 0u);
+
+    // the fast server served while the slow one was busy
+    const auto stats = balancer.getStats();
+    BOOST_REQUIRE_EQUAL(stats.size(), 2u);
+    const auto& fastStats = stats[0].uri < stats[1].uri ? stats[0] : stats[1];
+    const auto& slowStats = stats[0].uri < stats[1].uri ? stats[1] : stats[0];
+    BOOST_CHECK_EQUAL(fastStats.requests + slowStats.requests, numRequests);
+    BOOST_CHECK_EQUAL(fastStats.replies + slowStats.replies, numRequests);
+    BOOST_CHECK_GT(fastStats.requests, slowStats.requests * 4);
+    BOOST_CHECK_EQUAL(fastStats.queueDepth, 0u);
+    BOOST_CHECK_GE(slowStats.latency, 50000u);
+    BOOST_CHECK_GE(slowStats.maxLatency, slowStats.latency);
+    BOOST_CHECK_LT(fastStats.latency, slowStats.latency);
+}
@@ -8,13 +8,26 @@
 #define BOOST_TEST_MODULE zeroeq_perf
 
 #include "common.h"
+#include <zeroeq/detail/connections.h>
+#include <zeroeq/detail/context.h>
+#include <zeroeq/detail/sender.h>
 #include <servus/servus.h>
 #include <servus/uri.h>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
 #include <thread>
 
+#ifndef _WIN32
+#include <dirent.h>
+#endif
+
 using std::chrono::duration_cast;
 using std::chrono::high_resolution_clock;
 using std::chrono::milliseconds;
@@ -165,6 +178,201 @@ BOOST_AUTO_TEST_CASE(pubsub_inproc)
     runPubSub("inproc://zeroeq.test.pubsub_inproc");
 }
 
+BOOST_AUTO_TEST_CASE(pubsub_publishers)
+{
+    const zeroeq::uint128_t event =
+        servus::make_uint128("zeroeq::test::Publishers");
+    std::cout << "tcp pub-sub: publishers, subscribe ms, MB/s, P/s, loss"
+              << std::endl;
+
+    for (const size_t numPublishers : {1, 32, 256})
+    {
+        std::vector<std::unique_ptr<zeroeq::Publisher>> publishers;
+        zeroeq::URIs uris;
+        while (publishers.size() < numPublishers)
+        {
+            publishers.emplace_back(
+                new zeroeq::Publisher(zeroeq::URI("127.0.0.1"),
+                                      zeroeq::NULL_SESSION));
+            uris.push_back(publishers.back()->getURI());
+        }
+        zeroeq::Subscriber subscriber(uris);
+
+        // subscribe latency: until an event of each publisher is received
+        std::vector<bool> seen(numPublishers, false);
+        size_t numSeen = 0;
+        size_t received = 0;
+        auto startTime = high_resolution_clock::now();
+        subscriber.subscribe(event, [&](const void* data, const size_t size) {
+            ++received;
+            uint32_t index;
+            if (size < sizeof(index))
+                return;
+            ::memcpy(&index, data, sizeof(index));
+            if (!seen[index])
+            {
+                seen[index] = true;
+                ++numSeen;
+            }
+        });
+
+        std::vector<uint8_t> payload(msgSize);
+        while (numSeen < numPublishers)
+        {
+            for (uint32_t i = 0; i < numPublishers; ++i)
+                if (!seen[i])
+                    publishers[i]->publish(event, &i, sizeof(i));
+            subscriber.receive(10);
+        }
+        const auto subscribeTime = duration_cast<milliseconds>(
+                                       high_resolution_clock::now() -
+                                       startTime)
+                                       .count();
+        while (subscriber.receive(100)) /* flush pending messages */
+            ;
+
+        // receive throughput: round-robin over all publishers
+        received = 0;
+        size_t sent = 0;
+        bool running = true;
+        startTime = high_resolution_clock::now();
+        std::thread thread([&] {
+            while (running)
+                for (auto& publisher : publishers)
+                {
+                    publisher->publish(event, payload.data(), payload.size());
+                    ++sent;
+                }
+        });
+
+        while (duration_cast<milliseconds>(high_resolution_clock::now() -
+                                           startTime)
+                   .count() < 500)
+        {
+            subscriber.receive(100);
+        }
+        running = false;
+        thread.join();
+        while (received < sent && subscriber.receive(100))
+            /* nop */;
+
+        const float seconds =
+            float(duration_cast<milliseconds>(high_resolution_clock::now() -
+                                              startTime)
+                      .count()) /
+            1000.f;
+        const int loss =
+            std::round(float(sent - received) / float(sent) * 100.f);
+        std::cout << numPublishers << ", " << subscribeTime << ", "
+                  << float(received * msgSize) / 1024.f / 1024.f / seconds
+                  << ", " << float(received) / seconds << ", " << loss << "%"
+                  << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(connection_churn)
+{
+    const size_t numConnections = 4096;
+    const size_t numRounds = 16;
+    const zeroeq::zmq::SocketPtr shared(new int, [](void* socket) {
+        delete static_cast<int*>(socket);
+    });
+
+    std::cout << "connection churn: sockets, connections, add+remove/s"
+              << std::endl;
+    for (const bool isShared : {true, false})
+    {
+        std::vector<zeroeq::zmq::SocketPtr> sockets;
+        std::vector<std::string> keys;
+        for (size_t i = 0; i < numConnections; ++i)
+        {
+            sockets.push_back(
+                isShared ? shared
+                         : zeroeq::zmq::SocketPtr(new int, [](void* socket) {
+                               delete static_cast<int*>(socket);
+                           }));
+            keys.push_back("127.0.0.1:" + std::to_string(1024 + i));
+        }
+
+        zeroeq::detail::Connections connections;
+        const auto startTime = high_resolution_clock::now();
+        for (size_t round = 0; round < numRounds; ++round)
+        {
+            for (size_t i = 0; i < numConnections; ++i)
+                connections.add(keys[i], "tcp://" + keys[i], sockets[i]);
+            BOOST_CHECK_EQUAL(connections.size(), numConnections);
+            BOOST_CHECK_EQUAL(connections.getEntries().size(),
+                              isShared ? 1u : numConnections);
+
+            // remove in a different order than added
+            for (size_t i = 0; i < numConnections; ++i)
+                BOOST_CHECK(connections.remove(keys[(i * 7) % numConnections]));
+            BOOST_CHECK_EQUAL(connections.size(), 0u);
+            BOOST_CHECK(connections.getEntries().empty());
+        }
+        const float seconds =
+            float(duration_cast<std::chrono::microseconds>(
+                      high_resolution_clock::now() - startTime)
+                      .count()) /
+            1000000.f;
+
+        std::cout << (isShared ? 1 : numConnections) << ", " << numConnections
+                  << ", " << float(numRounds * numConnections) / seconds
+                  << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(startup_latency)
+{
+    // Time from construction to first received event, discovered using the
+    // servus test driver. The first cached run fills the discovery cache.
+    const std::string cache =
+        "zeroeq.test.cache." + std::to_string(getpid());
+    const zeroeq::uint128_t event =
+        servus::make_uint128("zeroeq::test::Startup");
+    zeroeq::Publisher publisher(zeroeq::TEST_SESSION);
+
+    std::cout << "startup latency: discovery cache, ms" << std::endl;
+    for (const bool useCache : {false, true, true})
+    {
+        if (useCache)
+            setenv(zeroeq::ENV_DISCOVERY_CACHE.c_str(), cache.c_str(), 1);
+        zeroeq::detail::Sender::getUUID() =
+            servus::make_UUID(); // different machine
+
+        const auto startTime = high_resolution_clock::now();
+        zeroeq::Subscriber subscriber(zeroeq::TEST_SESSION);
+        bool received = false;
+        subscriber.subscribe(event,
+                             [&](const void*, size_t) { received = true; });
+        while (!received)
+        {
+            publisher.publish(event);
+            subscriber.receive(1);
+        }
+        const auto time = duration_cast<std::chrono::microseconds>(
+                              high_resolution_clock::now() - startTime)
+                              .count();
+
+        std::cout << (useCache ? "on" : "off") << ", " << float(time) / 1000.f
+                  << std::endl;
+    }
+    unsetenv(zeroeq::ENV_DISCOVERY_CACHE.c_str());
+    std::cout << std::endl;
+
+#ifndef _WIN32
+    if (DIR* dir = ::opendir(cache.c_str()))
+    {
+        while (const dirent* entry = ::readdir(dir))
+            std::remove((cache + "/" + entry->d_name).c_str());
+        ::closedir(dir);
+        std::remove(cache.c_str());
+    }
+#endif
+}
+
 namespace
 {
 class Server
@@ -381,3 +589,288 @@ BOOST_AUTO_TEST_CASE(reqrep_servers)
     }
     std::cout << std::endl;
 }
+
+namespace
+{
+/** @return the latencies of requests sent round-robin by a DEALER socket. */
+std::vector<uint64_t> runDealer(const zeroeq::URIs& uris,
+                                const size_t numRequests, const size_t depth)
+{
+    std::shared_ptr<void> dealer(zmq_socket(zeroeq::detail::getContext().get(),
+                                            ZMQ_DEALER),
+                                 [](void* s) { ::zmq_close(s); });
+    const int timeout = 1000;
+    zmq_setsockopt(dealer.get(), ZMQ_RCVTIMEO, &timeout, sizeof(timeout));
+    for (const auto& uri : uris)
+        BOOST_REQUIRE_EQUAL(zmq_connect(dealer.get(),
+                                        std::to_string(uri).c_str()),
+                            0);
+    std::this_thread::sleep_for(milliseconds(100)); // connect to all servers
+
+    // [id][empty][request ID] and [id][empty][reply ID][payload]*
+    std::map<uint64_t, high_resolution_clock::time_point> starts;
+    std::vector<uint64_t> latencies;
+    uint64_t sent = 0;
+    while (latencies.size() < numRequests)
+    {
+        while (sent < numRequests && sent - latencies.size() < depth)
+        {
+            starts[sent] = high_resolution_clock::now();
+            BOOST_REQUIRE_NE(zmq_send(dealer.get(), &sent, sizeof(sent),
+                                      ZMQ_SNDMORE),
+                             -1);
+            BOOST_REQUIRE_NE(zmq_send(dealer.get(), nullptr, 0, ZMQ_SNDMORE),
+                             -1);
+            BOOST_REQUIRE_NE(zmq_send(dealer.get(), &typeID, sizeof(typeID),
+                                      0),
+                             -1);
+            ++sent;
+        }
+
+        uint64_t id = 0;
+        BOOST_REQUIRE_EQUAL(zmq_recv(dealer.get(), &id, sizeof(id), 0),
+                            int(sizeof(id)));
+        int more = 1;
+        size_t size = sizeof(more);
+        while (zmq_getsockopt(dealer.get(), ZMQ_RCVMORE, &more, &size) == 0 &&
+               more)
+        {
+            zmq_recv(dealer.get(), nullptr, 0, 0);
+        }
+
+        const auto i = starts.find(id);
+        BOOST_REQUIRE(i != starts.end());
+        latencies.push_back(duration_cast<std::chrono::microseconds>(
+                                high_resolution_clock::now() - i->second)
+                                .count());
+        starts.erase(i);
+    }
+    return latencies;
+}
+}
+
+BOOST_AUTO_TEST_CASE(reqrep_load_balancer)
+{
+    // Request latency with one slow server among fast ones, dispatched
+    // round-robin by a plain DEALER socket, by the latency-aware client or to
+    // the least loaded by a LoadBalancer
+    const std::vector<unsigned> serviceTimes{1, 1, 1, 20}; // milliseconds
+    const size_t numRequests = 400;
+    const size_t depth = 8; // outstanding requests of the client
+
+    std::vector<zeroeq::Server> servers;
+    zeroeq::URIs uris;
+    for (const unsigned serviceTime : serviceTimes)
+    {
+        servers.emplace_back(
+            zeroeq::Server(zeroeq::URI("127.0.0.1"), zeroeq::NULL_SESSION));
+        servers.back().handle(typeID, [serviceTime](const void*, size_t) {
+            std::this_thread::sleep_for(milliseconds(serviceTime));
+            return zeroeq::ReplyData{typeID, {}};
+        });
+        uris.push_back(servers.back().getURI());
+    }
+    zeroeq::LoadBalancer balancer(uris, zeroeq::URI("127.0.0.1"));
+
+    std::atomic<bool> running{true};
+    std::vector<std::thread> threads;
+    for (auto& server : servers)
+        threads.emplace_back([&server, &running] {
+            while (running)
+                server.receive(10);
+        });
+    threads.emplace_back([&balancer, &running] {
+        while (running)
+            balancer.receive(10);
+    });
+
+    std::cout << "tcp req-rep with a slow server: dispatch, p50 ms, p99 ms, "
+                 "max ms"
+              << std::endl;
+    const auto report = [numRequests](const std::string& dispatch,
+                                      std::vector<uint64_t>& latencies) {
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << dispatch << ", "
+                  << float(latencies[numRequests / 2]) / 1000.f << ", "
+                  << float(latencies[numRequests * 99 / 100]) / 1000.f << ", "
+                  << float(latencies.back()) / 1000.f << std::endl;
+    };
+
+    std::vector<uint64_t> baseline = runDealer(uris, numRequests, depth);
+    report("dealer", baseline);
+
+    for (const bool balanced : {false, true})
+    {
+        zeroeq::Client client(balanced ? zeroeq::URIs{balancer.getURI()}
+                                       : uris);
+        std::vector<uint64_t> latencies;
+        size_t sent = 0;
+        while (latencies.size() < numRequests)
+        {
+            while (sent < numRequests && sent - latencies.size() < depth)
+            {
+                const auto start = high_resolution_clock::now();
+                client.request(typeID, nullptr, 0,
+                               [&latencies, start](const zeroeq::uint128_t&,
+                                                   const void*, size_t) {
+                                   latencies.push_back(
+                                       duration_cast<std::chrono::microseconds>(
+                                           high_resolution_clock::now() -
+                                           start)
+                                           .count());
+                               });
+                ++sent;
+            }
+            BOOST_REQUIRE(client.receive(1000));
+        }
+
+        report(balanced ? "load balancer" : "client", latencies);
+    }
+    std::cout << std::endl;
+
+    running = false;
+    for (auto& thread : threads)
+        thread.join();
+}
+
+BOOST_AUTO_TEST_CASE(reqrep_hedging)
+{
+    // Request latency with servers which stall occasionally, sent one at a
+    // time by a client with and without hedging
+    const size_t numServers = 4;
+    const size_t numRequests = 1000;
+    const unsigned serviceTime = 1; // milliseconds
+    const unsigned stallTime = 30;  // milliseconds, every 20th request
+
+    std::vector<zeroeq::Server> servers;
+    zeroeq::URIs uris;
+    for (size_t i = 0; i < numServers; ++i)
+    {
+        servers.emplace_back(
+            zeroeq::Server(zeroeq::URI("127.0.0.1"), zeroeq::NULL_SESSION));
+        auto counter = std::make_shared<size_t>(i * 7);
+        servers.back().handle(typeID, [=](const void*, size_t) {
+            const bool stall = ++*counter % 20 == 0;
+            std::this_thread::sleep_for(
+                milliseconds(stall ? stallTime : serviceTime));
+            return zeroeq::ReplyData{typeID, {}};
+        });
+        uris.push_back(servers.back().getURI());
+    }
+
+    std::atomic<bool> running{true};
+    std::vector<std::thread> threads;
+    for (auto& server : servers)
+        threads.emplace_back([&server, &running] {
+            while (running)
+                server.receive(10);
+        });
+
+    std::cout << "tcp req-rep with stalling servers: hedging, p50 ms, p99 ms, "
+                 "max ms, hedged"
+              << std::endl;
+    for (const bool hedging : {false, true})
+    {
+        zeroeq::Client client(uris);
+        if (hedging)
+            client.enableHedging(0.9f);
+
+        std::vector<uint64_t> latencies;
+        while (latencies.size() < numRequests)
+        {
+            const size_t expected = latencies.size() + 1;
+            const auto start = high_resolution_clock::now();
+            client.request(typeID, nullptr, 0,
+                           [&latencies, start](const zeroeq::uint128_t&,
+                                               const void*, size_t) {
+                               latencies.push_back(
+                                   duration_cast<std::chrono::microseconds>(
+                                       high_resolution_clock::now() - start)
+                                       .count());
+                           });
+            while (latencies.size() < expected)
+                BOOST_REQUIRE(client.receive(1000));
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << (hedging ? "p90" : "off") << ", "
+                  << float(latencies[numRequests / 2]) / 1000.f << ", "
+                  << float(latencies[numRequests * 99 / 100]) / 1000.f << ", "
+                  << float(latencies.back()) / 1000.f << ", "
+                  << client.getNumHedged() << std::endl;
+    }
+    std::cout << std::endl;
+
+    running = false;
+    for (auto& thread : threads)
+        thread.join();
+}
+
+BOOST_AUTO_TEST_CASE(reqrep_batch)
+{
+    // Throughput of tiny lookups sent as single requests or in batches
+    const size_t numLookups = 20000;
+    zeroeq::Server server(zeroeq::URI("127.0.0.1"), zeroeq::NULL_SESSION);
+    server.handleBatch(typeID, [](const zeroeq::Payloads& batch) {
+        std::vector<zeroeq::ReplyData> replies;
+        replies.reserve(batch.size());
+        for (const auto& payload : batch)
+        {
+            zeroeq::ReplyData reply{typeID, {}};
+            reply.second.ptr = std::shared_ptr<const void>(payload.data,
+                                                           [](const void*) {});
+            reply.second.size = payload.size;
+            replies.push_back(reply);
+        }
+        return replies;
+    });
+
+    std::atomic<bool> running{true};
+    std::thread thread([&server, &running] {
+        while (running)
+            server.receive(10);
+    });
+
+    zeroeq::Client client({server.getURI()});
+    std::cout << "tcp req-rep lookups: batch size, lookups/s" << std::endl;
+    for (const size_t batchSize : {1, 10, 100, 1000})
+    {
+        size_t handled = 0;
+        const zeroeq::ReplyFunc func = [&handled](const zeroeq::uint128_t&,
+                                                  const void*, size_t) {
+            ++handled;
+        };
+        std::vector<uint64_t> keys(batchSize);
+        zeroeq::Payloads payloads;
+        for (const uint64_t& key : keys)
+            payloads.push_back({&key, sizeof(key)});
+        const std::vector<zeroeq::ReplyFunc> funcs(batchSize, func);
+
+        const auto start = high_resolution_clock::now();
+        for (size_t sent = 0; sent < numLookups; sent += batchSize)
+        {
+            for (size_t i = 0; i < batchSize; ++i)
+                keys[i] = sent + i;
+            if (batchSize == 1)
+                client.request(typeID, &keys[0], sizeof(uint64_t), func);
+            else
+                client.request(typeID, payloads, funcs);
+
+            // keep up to 10 batches in flight
+            while (sent + batchSize - handled > 10 * batchSize)
+                BOOST_REQUIRE(client.receive(1000));
+        }
+        while (handled < numLookups)
+            BOOST_REQUIRE(client.receive(1000));
+
+        const float time =
+            std::chrono::duration<float>(high_resolution_clock::now() - start)
+                .count();
+        std::cout << batchSize << ", " << float(numLookups) / time
+                  << std::endl;
+    }
+    std::cout << std::endl;
+
+    running = false;
+    thread.join();
+}
@@ -0,0 +1,174 @@
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+// Performance test measuring pub-sub latency and publisher load with many
+// subscribers, connected directly or in a fan-out tree. Runs in its own
+// process, since it raises the socket and file descriptor limits.
+
+#define BOOST_TEST_MODULE zeroeq_perf_fan_out
+
+#include "common.h"
+#include <zeroeq/detail/context.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <time.h>
+#endif
+
+#include <zmq.h>
+
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::chrono::milliseconds;
+
+#ifndef _WIN32
+namespace
+{
+uint64_t getMicroseconds()
+{
+    return duration_cast<std::chrono::microseconds>(
+               high_resolution_clock::now().time_since_epoch())
+        .count();
+}
+
+uint64_t getThreadMicroseconds()
+{
+    timespec time;
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return uint64_t(time.tv_sec) * 1000000 + uint64_t(time.tv_nsec) / 1000;
+}
+}
+
+BOOST_AUTO_TEST_CASE(pubsub_fan_out)
+{
+    // End-to-end latency and publisher CPU time per event over inproc, with
+    // all subscribers connected to the publisher or in a fan-out tree
+    const zeroeq::uint128_t event =
+        servus::make_uint128("zeroeq::test::FanOut");
+    const size_t fanOut = 10;
+    const size_t numEvents = 100;
+
+    // Two sockets per subscriber and proxy, each using file descriptors. The
+    // socket limit of the context only applies before it creates its first
+    // socket, which is why this benchmark runs in its own process.
+    rlimit limit;
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < 8192)
+    {
+        limit.rlim_cur = std::min(rlim_t(8192), limit.rlim_max);
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    const zeroeq::zmq::ContextPtr context = zeroeq::detail::getContext();
+    zmq_ctx_set(context.get(), ZMQ_MAX_SOCKETS, 8192);
+
+    std::cout << "inproc pub-sub: subscribers, fan-out, proxies, latency us, "
+                 "publisher us/event, loss"
+              << std::endl;
+    for (const size_t numSubscribers : {10, 100, 1000})
+    {
+        for (const size_t maxChildren : {size_t(0), fanOut})
+        {
+            const std::string name = "inproc://zeroeq.test.fan_out." +
+                                     std::to_string(numSubscribers) + "." +
+                                     std::to_string(maxChildren);
+            zeroeq::Publisher publisher(zeroeq::URI(name),
+                                        zeroeq::NULL_SESSION);
+            publisher.setFanOut(maxChildren);
+            const zeroeq::URIs upstream{publisher.getURI()};
+
+            // each proxy takes one slot in the tree and adds fanOut slots
+            const size_t numProxies =
+                maxChildren == 0 || numSubscribers <= fanOut
+                    ? 0
+                    : (numSubscribers - 2) / (fanOut - 1);
+
+            zeroeq::Receiver* group = nullptr; // receives for all nodes
+            std::vector<std::unique_ptr<zeroeq::Proxy>> proxies;
+            while (proxies.size() < numProxies)
+            {
+                const zeroeq::URI uri(name + ".proxy" +
+                                      std::to_string(proxies.size()));
+                proxies.emplace_back(
+                    group ? new zeroeq::Proxy(upstream, uri, *group)
+                          : new zeroeq::Proxy(upstream, uri));
+                group = proxies.front().get();
+                publisher.publish(event); // proxies join first, in order
+                group->receive(0);
+            }
+
+            std::vector<std::unique_ptr<zeroeq::Subscriber>> subscribers;
+            std::vector<size_t> received(numSubscribers, 0);
+            uint64_t latency = 0;
+            size_t numReceived = 0;
+            for (size_t i = 0; i < numSubscribers; ++i)
+            {
+                subscribers.emplace_back(
+                    group ? new zeroeq::Subscriber(upstream, *group)
+                          : new zeroeq::Subscriber(upstream));
+                group = group ? group : subscribers.front().get();
+                subscribers.back()->subscribe(
+                    event, [&, i](const void* data, const size_t size) {
+                        ++received[i];
+                        uint64_t sent;
+                        if (size != sizeof(sent))
+                            return;
+                        ::memcpy(&sent, data, sizeof(sent));
+                        latency += getMicroseconds() - sent;
+                        ++numReceived;
+                    });
+            }
+
+            // until the tree is built and each subscriber receives once
+            for (size_t i = 0; i < 100; ++i)
+            {
+                std::fill(received.begin(), received.end(), 0);
+                publisher.publish(event);
+                while (group->receive(50))
+                    /* drain */;
+                if (size_t(std::count(received.begin(), received.end(), 1)) ==
+                    numSubscribers)
+                {
+                    break;
+                }
+            }
+
+            uint64_t cpuTime = 0;
+            std::thread thread([&] {
+                const uint64_t start = getThreadMicroseconds();
+                for (size_t i = 0; i < numEvents; ++i)
+                {
+                    const uint64_t sent = getMicroseconds();
+                    publisher.publish(event, &sent, sizeof(sent));
+                    std::this_thread::sleep_for(milliseconds(1));
+                }
+                cpuTime = getThreadMicroseconds() - start;
+            });
+
+            const size_t expected = numEvents * numSubscribers;
+            const auto startTime = high_resolution_clock::now();
+            while (numReceived < expected &&
+                   duration_cast<milliseconds>(high_resolution_clock::now() -
+                                               startTime)
+                           .count() < 10000)
+            {
+                group->receive(10);
+            }
+            thread.join();
+
+            std::cout << numSubscribers << ", " << maxChildren << ", "
+                      << numProxies << ", "
+                      << float(latency) / float(std::max(numReceived, size_t(1)))
+                      << ", " << float(cpuTime) / float(numEvents) << ", "
+                      << expected - numReceived << std::endl;
+            BOOST_CHECK_EQUAL(numReceived, expected);
+        }
+    }
+    std::cout << std::endl;
+}
+#endif
@@ -0,0 +1,208 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#define BOOST_TEST_MODULE zeroeq_proxy
+
+#include "common.h"
+
+#include <zeroeq/detail/fanOut.h>
+#include <zeroeq/detail/sender.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+const auto event = zeroeq::make_uint128("zeroeq::test::Proxy");
+}
+
+BOOST_AUTO_TEST_CASE(relay)
+{
+    zeroeq::Publisher publisher(zeroeq::TEST_SESSION);
+    zeroeq::detail::Sender::getUUID() =
+        servus::make_UUID(); // different process
+    zeroeq::Proxy proxy(publisher.getSession());
+    BOOST_CHECK_EQUAL(proxy.getSession(), publisher.getSession());
+
+    zeroeq::URI uri = proxy.getURI();
+    uri.setHost("127.0.0.1");
+    zeroeq::Subscriber subscriber(zeroeq::URIs{uri}, proxy);
+
+    bool received = false;
+    BOOST_CHECK(subscriber.subscribe(test::Echo::IDENTIFIER(),
+                                     zeroeq::EventPayloadFunc(
+                                         [&](const void* data, size_t size) {
+                                             test::onEchoEvent(data, size);
+                                             received = true;
+                                         })));
+    for (size_t i = 0; i < 50 && !received; ++i)
+    {
+        BOOST_CHECK(publisher.publish(test::Echo(test::echoMessage)));
+        subscriber.receive(100);
+    }
+    BOOST_CHECK(received);
+
+    const zeroeq::Proxy::Stats& stats = proxy.getStats();
+    BOOST_CHECK_GT(stats.messages, 0u);
+    BOOST_CHECK_GE(stats.bytes, stats.messages * test::echoMessage.size());
+    BOOST_CHECK_GT(stats.subscriptions, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(prefer_local_relay_zeroconf)
+{
+    zeroeq::Publisher publisher(zeroeq::TEST_SESSION);
+    zeroeq::detail::Sender::getUUID() =
+        servus::make_UUID(); // different process
+    zeroeq::Proxy proxy(publisher.getSession());
+    zeroeq::detail::Sender::getUUID() = servus::make_UUID();
+    zeroeq::Subscriber subscriber(publisher.getSession(), proxy);
+
+    size_t received = 0;
+    BOOST_CHECK(subscriber.subscribe(event, [&] { ++received; }));
+    for (size_t i = 0; i < 50 && received == 0; ++i)
+    {
+        BOOST_CHECK(publisher.publish(event));
+        subscriber.receive(100);
+    }
+    BOOST_CHECK_GT(received, 0u);
+    BOOST_CHECK_GT(proxy.getStats().messages, 0u);
+
+    // received only through the relay on this node, not also directly
+    while (subscriber.receive(100))
+        /* drain */;
+    received = 0;
+    const uint64_t forwarded = proxy.getStats().messages;
+    BOOST_CHECK(publisher.publish(event));
+    while (subscriber.receive(200))
+        /* NOP */;
+    BOOST_CHECK_EQUAL(received, 1u);
+    BOOST_CHECK_EQUAL(proxy.getStats().messages, forwarded + 1);
+}
+
+BOOST_AUTO_TEST_CASE(fan_out_tree)
+{
+    zeroeq::Publisher publisher(
+        zeroeq::URI("inproc://zeroeq.test.proxy.fan_out_tree"),
+        zeroeq::NULL_SESSION);
+    publisher.setFanOut(2);
+    BOOST_CHECK_EQUAL(publisher.getFanOut(), 2u);
+
+    const zeroeq::URIs upstream{publisher.getURI()};
+    zeroeq::Proxy first(upstream, zeroeq::URI(
+                                      "inproc://zeroeq.test.proxy.first"));
+    std::unique_ptr<zeroeq::Proxy> second(
+        new zeroeq::Proxy(upstream,
+                          zeroeq::URI("inproc://zeroeq.test.proxy.second"),
+                          first));
+    for (size_t i = 0; i < 10; ++i) // proxies join the tree first
+    {
+        BOOST_CHECK(publisher.publish(event));
+        first.receive(10);
+    }
+
+    // all subscribers connect to the publisher, two are redirected to each
+    // proxy
+    std::vector<size_t> received(4, 0);
+    std::vector<std::unique_ptr<zeroeq::Subscriber>> subscribers;
+    for (size_t& count : received)
+    {
+        subscribers.emplace_back(new zeroeq::Subscriber(upstream, first));
+        BOOST_CHECK(subscribers.back()->subscribe(event, [&] { ++count; }));
+    }
+
+    const auto deliver = [&] {
+        std::fill(received.begin(), received.end(), 0);
+        BOOST_CHECK(publisher.publish(event));
+        while (first.receive(50))
+            /* drain */;
+        return size_t(std::count(received.begin(), received.end(), 1)) ==
+               received.size();
+    };
+
+    bool converged = false;
+    for (size_t i = 0; i < 100 && !converged; ++i)
+    {
+        const uint64_t forwarded[] = {first.getStats().messages,
+                                      second->getStats().messages};
+        converged = deliver() &&
+                    first.getStats().messages == forwarded[0] + 1 &&
+                    second->getStats().messages == forwarded[1] + 1;
+    }
+    BOOST_CHECK(converged);
+
+    // children of a destroyed proxy move back to the publisher
+    second.reset();
+    converged = false;
+    for (size_t i = 0; i < 100 && !converged; ++i)
+        converged = deliver();
+    BOOST_CHECK(converged);
+}
+
+BOOST_AUTO_TEST_CASE(late_subscriber_delta)
+{
+    zeroeq::Publisher publisher(
+        zeroeq::URI("inproc://zeroeq.test.proxy.late_subscriber_delta"),
+        zeroeq::NULL_SESSION);
+    zeroeq::Proxy proxy(zeroeq::URIs{publisher.getURI()},
+                        zeroeq::URI("inproc://zeroeq.test.proxy.delta_relay"));
+    publisher.enableDelta(event, 1000); // no periodic keyframe in this test
+
+    std::vector<uint8_t> payload(64 * 1024, 0);
+    std::vector<uint8_t> received[2];
+    const auto subscribe = [&](zeroeq::Subscriber& subscriber,
+                               std::vector<uint8_t>& into) {
+        BOOST_CHECK(subscriber.subscribe(
+            event,
+            zeroeq::EventPayloadFunc([&into](const void* data, size_t size) {
+                const uint8_t* bytes = static_cast<const uint8_t*>(data);
+                into.assign(bytes, bytes + size);
+            })));
+    };
+    const auto publish = [&](const size_t i) {
+        payload[i * 997 % payload.size()] ^= 0xff;
+        BOOST_CHECK(publisher.publish(event, payload.data(), payload.size()));
+    };
+
+    zeroeq::Subscriber subscriber(zeroeq::URIs{proxy.getURI()}, proxy);
+    subscribe(subscriber, received[0]);
+    for (size_t i = 0; i < 50 && received[0].empty(); ++i)
+    {
+        publish(i);
+        subscriber.receive(100);
+    }
+    while (subscriber.receive(100))
+        /* NOP to drain */;
+    BOOST_REQUIRE(received[0] == payload);
+
+    // the relay forwards the subscription of the late subscriber, which
+    // triggers a keyframe instead of deltas it can not decode
+    zeroeq::Subscriber lateSubscriber(zeroeq::URIs{proxy.getURI()}, proxy);
+    subscribe(lateSubscriber, received[1]);
+    for (size_t i = 0; i < 50 && received[1].empty(); ++i)
+    {
+        publish(i);
+        while (lateSubscriber.receive(100))
+            /* NOP to drain */;
+    }
+    BOOST_CHECK(received[1] == payload);
+    BOOST_CHECK(received[0] == payload);
+}
+
+BOOST_AUTO_TEST_CASE(fan_out_endpoints)
+{
+    using zeroeq::detail::fanout::matches;
+    const std::string host =
+        zeroeq::Publisher(zeroeq::NULL_SESSION).getURI().getHost();
+
+    BOOST_CHECK(matches("tcp://node1:4242", "tcp://node1:4242"));
+    BOOST_CHECK(matches("tcp://Node1:4242", "tcp://node1:4242"));
+    BOOST_CHECK(matches("tcp://127.0.0.1:4242", "tcp://*:4242"));
+    BOOST_CHECK(matches("tcp://" + host + ":4242", "tcp://localhost:4242"));
+    BOOST_CHECK(matches("tcp://[::1]:4242", "tcp://0.0.0.0:4242"));
+
+    BOOST_CHECK(!matches("tcp://node1:4242", "tcp://node2:4242"));
+    BOOST_CHECK(!matches("tcp://node1:4242", "tcp://node1:4243"));
+    BOOST_CHECK(!matches("tcp://127.0.0.1:4242", "tcp://127.0.0.1:4243"));
+    BOOST_CHECK(!matches("ipc://node1:4242", "tcp://node1:4242"));
+}
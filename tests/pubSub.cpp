@@ -13,7 +13,10 @@
 #include <servus/uri.h>
 
 #include <chrono>
+#include <cstdio>
+#include <fstream>
 #include <thread>
+#include <vector>
 
 BOOST_AUTO_TEST_CASE(publish_receive_serializable)
 {
@@ -290,6 +293,269 @@ BOOST_AUTO_TEST_CASE(publish_receive_filters)
                             << std::chrono::nanoseconds(echoTime).count());
 }
 
+namespace
+{
+class CountingEcho : public test::Echo
+{
+public:
+    explicit CountingEcho(const std::string& message)
+        : Echo(message)
+    {
+    }
+
+    mutable size_t serialized{0};
+
+private:
+    Data _toBinary() const final
+    {
+        ++serialized;
+        Data data;
+        data.ptr = std::shared_ptr<const void>(getMessage().data(),
+                                               [](const void*) {});
+        data.size = getMessage().length();
+        return data;
+    }
+};
+}
+
+BOOST_AUTO_TEST_CASE(publish_without_subscribers)
+{
+    zeroeq::Publisher publisher(
+        zeroeq::URI("inproc://zeroeq.test.publish_without_subscribers"),
+        zeroeq::NULL_SESSION);
+    CountingEcho echo(test::echoMessage);
+
+    BOOST_CHECK(!publisher.hasSubscribers(test::Echo::IDENTIFIER()));
+    BOOST_CHECK(publisher.publish(echo));
+    BOOST_CHECK_EQUAL(echo.serialized, 0);
+
+    zeroeq::Subscriber subscriber(publisher.getURI());
+    BOOST_CHECK(
+        subscriber.subscribe(test::Echo::IDENTIFIER(),
+                             zeroeq::EventPayloadFunc(&test::onEchoEvent)));
+    for (size_t i = 0; i < 20; ++i)
+    {
+        if (publisher.hasSubscribers(test::Echo::IDENTIFIER()))
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    BOOST_CHECK(publisher.hasSubscribers(test::Echo::IDENTIFIER()));
+    BOOST_CHECK(!publisher.hasSubscribers(test::Empty::IDENTIFIER()));
+
+    BOOST_CHECK(publisher.publish(echo));
+    BOOST_CHECK_EQUAL(echo.serialized, 1);
+    BOOST_CHECK(subscriber.receive(1000));
+
+    BOOST_CHECK(subscriber.unsubscribe(test::Echo::IDENTIFIER()));
+    for (size_t i = 0; i < 20; ++i)
+    {
+        if (!publisher.hasSubscribers(test::Echo::IDENTIFIER()))
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    BOOST_CHECK(!publisher.hasSubscribers(test::Echo::IDENTIFIER()));
+    BOOST_CHECK(publisher.publish(echo));
+    BOOST_CHECK_EQUAL(echo.serialized, 1);
+}
+
+BOOST_AUTO_TEST_CASE(has_subscribers_multiple)
+{
+    zeroeq::Publisher publisher(
+        zeroeq::URI("inproc://zeroeq.test.has_subscribers_multiple"),
+        zeroeq::NULL_SESSION);
+    const auto waitFor = [&](const bool expected) {
+        for (size_t i = 0; i < 20; ++i)
+        {
+            if (publisher.hasSubscribers(test::Echo::IDENTIFIER()) == expected)
+                return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return false;
+    };
+
+    zeroeq::Subscriber subscriber1(publisher.getURI());
+    zeroeq::Subscriber subscriber2(publisher.getURI());
+    for (auto subscriber : {&subscriber1, &subscriber2})
+        BOOST_CHECK(subscriber->subscribe(
+            test::Echo::IDENTIFIER(),
+            zeroeq::EventPayloadFunc(&test::onEchoEvent)));
+    BOOST_CHECK(waitFor(true));
+
+    // the topic has subscribers until the last one left
+    BOOST_CHECK(subscriber1.unsubscribe(test::Echo::IDENTIFIER()));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    BOOST_CHECK(publisher.hasSubscribers(test::Echo::IDENTIFIER()));
+
+    BOOST_CHECK(subscriber2.unsubscribe(test::Echo::IDENTIFIER()));
+    BOOST_CHECK(waitFor(false));
+}
+
+BOOST_AUTO_TEST_CASE(publish_deduplicated)
+{
+    zeroeq::Publisher publisher(
+        zeroeq::URI("inproc://zeroeq.test.publish_deduplicated"),
+        zeroeq::NULL_SESSION);
+    zeroeq::Subscriber subscriber(publisher.getURI());
+    size_t received = 0;
+    BOOST_CHECK(subscriber.subscribe(
+        test::Echo::IDENTIFIER(),
+        zeroeq::EventPayloadFunc([&](const void* data, const size_t size) {
+            test::onEchoEvent(data, size);
+            ++received;
+        })));
+
+    // establish subscription
+    for (size_t i = 0; i < 20 && received == 0; ++i)
+    {
+        BOOST_CHECK(publisher.publish(test::Echo(test::echoMessage)));
+        subscriber.receive(100);
+    }
+    BOOST_REQUIRE_GT(received, 0);
+    while (subscriber.receive(100))
+        /* NOP to drain */;
+
+    const size_t keyframeInterval = 4;
+    publisher.enableDeduplication(keyframeInterval);
+    received = 0;
+    for (size_t i = 0; i < 10; ++i)
+        BOOST_CHECK(publisher.publish(test::Echo(test::echoMessage)));
+    while (subscriber.receive(100))
+        /* NOP to drain */;
+
+    // first publish and one keyframe after every four suppressed ones
+    BOOST_CHECK_EQUAL(received, 2);
+    BOOST_CHECK_EQUAL(publisher.getNumSuppressed(), 8);
+
+    publisher.disableDeduplication();
+    received = 0;
+    for (size_t i = 0; i < 10; ++i)
+        BOOST_CHECK(publisher.publish(test::Echo(test::echoMessage)));
+    while (subscriber.receive(100))
+        /* NOP to drain */;
+    BOOST_CHECK_EQUAL(received, 10);
+    BOOST_CHECK_EQUAL(publisher.getNumSuppressed(), 8);
+}
+
+BOOST_AUTO_TEST_CASE(publish_receive_delta)
+{
+    zeroeq::Publisher publisher(
+        zeroeq::URI("inproc://zeroeq.test.publish_receive_delta"),
+        zeroeq::NULL_SESSION);
+    zeroeq::Subscriber subscriber(publisher.getURI());
+
+    const auto event = zeroeq::make_uint128("Mask");
+    std::vector<uint8_t> mask(1024 * 1024, 0);
+    std::vector<uint8_t> received;
+    BOOST_CHECK(subscriber.subscribe(
+        event,
+        zeroeq::EventPayloadFunc([&](const void* data, const size_t size) {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            received.assign(bytes, bytes + size);
+        })));
+
+    const size_t keyframeInterval = 5;
+    publisher.enableDelta(event, keyframeInterval);
+
+    // establish subscription
+    for (size_t i = 0; i < 20 && received.empty(); ++i)
+    {
+        BOOST_CHECK(publisher.publish(event, mask.data(), mask.size()));
+        subscriber.receive(100);
+    }
+    BOOST_REQUIRE(!received.empty());
+
+    for (size_t i = 0; i < 3 * keyframeInterval; ++i)
+    {
+        for (size_t j = i; j < mask.size(); j += 997)
+            mask[j] ^= uint8_t(i + 1);
+        if (i == keyframeInterval)
+            mask.resize(mask.size() + 42, 0xaa);
+
+        BOOST_CHECK(publisher.publish(event, mask.data(), mask.size()));
+        BOOST_CHECK(subscriber.receive(1000));
+        BOOST_CHECK(received == mask);
+    }
+
+    // late subscriber receives a keyframe first
+    zeroeq::Subscriber lateSubscriber(publisher.getURI());
+    std::vector<uint8_t> lateReceived;
+    BOOST_CHECK(lateSubscriber.subscribe(
+        event,
+        zeroeq::EventPayloadFunc([&](const void* data, const size_t size) {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            lateReceived.assign(bytes, bytes + size);
+        })));
+
+    for (size_t i = 0; i < 20 && lateReceived.empty(); ++i)
+    {
+        mask[i] ^= 0xff;
+        BOOST_CHECK(publisher.publish(event, mask.data(), mask.size()));
+        lateSubscriber.receive(100);
+        while (subscriber.receive(0))
+            /* NOP to drain */;
+    }
+    BOOST_CHECK(lateReceived == mask);
+    BOOST_CHECK(received == mask);
+}
+
+BOOST_AUTO_TEST_CASE(publish_receive_delta_two_publishers)
+{
+    zeroeq::Publisher publisher1(
+        zeroeq::URI("inproc://zeroeq.test.publish_receive_delta_1"),
+        zeroeq::NULL_SESSION);
+    zeroeq::Publisher publisher2(
+        zeroeq::URI("inproc://zeroeq.test.publish_receive_delta_2"),
+        zeroeq::NULL_SESSION);
+    zeroeq::Subscriber subscriber(
+        zeroeq::URIs{publisher1.getURI(), publisher2.getURI()});
+
+    // both sequences start at 1, the first byte tells the masks apart
+    const auto event = zeroeq::make_uint128("Mask");
+    std::vector<uint8_t> mask1(64 * 1024, 1);
+    std::vector<uint8_t> mask2(64 * 1024, 2);
+    std::vector<std::vector<uint8_t>> received;
+    BOOST_CHECK(subscriber.subscribe(
+        event,
+        zeroeq::EventPayloadFunc([&](const void* data, const size_t size) {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            received.emplace_back(bytes, bytes + size);
+        })));
+    publisher1.enableDelta(event, 1000); // no periodic keyframe in this test
+    publisher2.enableDelta(event, 1000);
+
+    // establish subscriptions
+    bool has1 = false, has2 = false;
+    for (size_t i = 0; i < 20 && !(has1 && has2); ++i)
+    {
+        BOOST_CHECK(publisher1.publish(event, mask1.data(), mask1.size()));
+        BOOST_CHECK(publisher2.publish(event, mask2.data(), mask2.size()));
+        while (subscriber.receive(100))
+            /* NOP to drain */;
+        for (const auto& payload : received)
+        {
+            has1 = has1 || payload[0] == 1;
+            has2 = has2 || payload[0] == 2;
+        }
+    }
+    BOOST_REQUIRE(has1 && has2);
+
+    // deltas of each publisher are applied to its own keyframe
+    for (size_t i = 1; i < 10; ++i)
+    {
+        mask1[i * 997] ^= uint8_t(i);
+        mask2[i * 991] ^= uint8_t(i);
+        received.clear();
+        BOOST_CHECK(publisher1.publish(event, mask1.data(), mask1.size()));
+        BOOST_CHECK(publisher2.publish(event, mask2.data(), mask2.size()));
+        for (size_t j = 0; j < 10 && received.size() < 2; ++j)
+            subscriber.receive(100);
+
+        BOOST_REQUIRE_EQUAL(received.size(), 2);
+        for (const auto& payload : received)
+            BOOST_CHECK(payload == (payload[0] == 1 ? mask1 : mask2));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(publish_receive_late_zeroconf)
 {
     zeroeq::Subscriber subscriber(zeroeq::TEST_SESSION);
@@ -329,6 +595,111 @@ BOOST_AUTO_TEST_CASE(publish_receive_empty_event_zeroconf)
     BOOST_CHECK(!"received");
 }
 
+BOOST_AUTO_TEST_CASE(publish_receive_priority_zeroconf)
+{
+    zeroeq::Publisher publisher(zeroeq::TEST_SESSION);
+    zeroeq::detail::Sender::getUUID() =
+        servus::make_UUID(); // different machine
+    zeroeq::Subscriber subscriber(publisher.getSession());
+
+    const auto bulkEvent = zeroeq::make_uint128("Bulk");
+    publisher.setPriority(test::Echo::IDENTIFIER(),
+                          zeroeq::Publisher::PRIORITY_HIGH);
+    BOOST_CHECK_EQUAL(publisher.getPriority(test::Echo::IDENTIFIER()),
+                      zeroeq::Publisher::PRIORITY_HIGH);
+    BOOST_CHECK_EQUAL(publisher.getPriority(bulkEvent),
+                      zeroeq::Publisher::PRIORITY_NORMAL);
+
+    size_t bulkReceived = 0;
+    size_t bulkBeforeEcho = 0;
+    bool echoReceived = false;
+    BOOST_CHECK(subscriber.subscribe(bulkEvent, zeroeq::EventFunc([&] {
+                                         ++bulkReceived;
+                                     })));
+    BOOST_CHECK(subscriber.subscribe(
+        test::Echo::IDENTIFIER(),
+        zeroeq::EventPayloadFunc([&](const void* data, const size_t size) {
+            test::onEchoEvent(data, size);
+            bulkBeforeEcho = bulkReceived;
+            echoReceived = true;
+        })));
+
+    // establish both lanes
+    for (size_t i = 0; i < 20 && (!echoReceived || bulkReceived == 0); ++i)
+    {
+        BOOST_CHECK(publisher.publish(bulkEvent));
+        BOOST_CHECK(publisher.publish(test::Echo(test::echoMessage)));
+        while (subscriber.receive(100))
+            /* NOP to drain */;
+    }
+    BOOST_REQUIRE(echoReceived);
+    BOOST_REQUIRE(bulkReceived > 0);
+
+    // high priority event overtakes queued bulk events
+    const size_t numBulk = 100;
+    const std::string payload(1024 * 1024, 'b');
+    bulkReceived = 0;
+    echoReceived = false;
+    for (size_t i = 0; i < numBulk; ++i)
+        BOOST_CHECK(
+            publisher.publish(bulkEvent, payload.data(), payload.size()));
+    BOOST_CHECK(publisher.publish(test::Echo(test::echoMessage)));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    while (bulkReceived < numBulk && subscriber.receive(1000))
+        /* NOP to drain */;
+
+    BOOST_CHECK(echoReceived);
+    BOOST_CHECK_EQUAL(bulkReceived, numBulk);
+    BOOST_CHECK_LT(bulkBeforeEcho, numBulk);
+}
+
+BOOST_AUTO_TEST_CASE(publish_receive_priority_explicit_uri)
+{
+    zeroeq::Publisher publisher(zeroeq::TEST_SESSION);
+    zeroeq::detail::Sender::getUUID() =
+        servus::make_UUID(); // different machine
+    zeroeq::Subscriber zeroconf(publisher.getSession());
+    zeroeq::Subscriber explicitURI(publisher.getURI());
+    publisher.setPriority(test::Echo::IDENTIFIER(),
+                          zeroeq::Publisher::PRIORITY_HIGH);
+
+    size_t received[2] = {0, 0};
+    zeroeq::Subscriber* subscribers[2] = {&zeroconf, &explicitURI};
+    for (size_t i = 0; i < 2; ++i)
+        BOOST_CHECK(subscribers[i]->subscribe(
+            test::Echo::IDENTIFIER(),
+            zeroeq::EventPayloadFunc([&received, i](const void* data,
+                                                    const size_t size) {
+                test::onEchoEvent(data, size);
+                ++received[i];
+            })));
+
+    const auto drain = [&] {
+        for (auto subscriber : subscribers)
+            while (subscriber->receive(100))
+                /* NOP to drain */;
+    };
+
+    // the subscriber without high priority lane receives high priority events
+    for (size_t i = 0; i < 20 && (received[0] == 0 || received[1] == 0); ++i)
+    {
+        BOOST_CHECK(publisher.publish(test::Echo(test::echoMessage)));
+        drain();
+    }
+    BOOST_REQUIRE_GT(received[0], 0);
+    BOOST_REQUIRE_GT(received[1], 0);
+
+    // each event is received once by all subscribers
+    const size_t numEvents = 10;
+    received[0] = received[1] = 0;
+    for (size_t i = 0; i < numEvents; ++i)
+        BOOST_CHECK(publisher.publish(test::Echo(test::echoMessage)));
+    drain();
+    BOOST_CHECK_EQUAL(received[0], numEvents);
+    BOOST_CHECK_EQUAL(received[1], numEvents);
+}
+
 namespace
 {
 class Publisher
@@ -379,3 +750,89 @@ BOOST_AUTO_TEST_CASE(publish_blocking_receive_zeroconf)
     publisher.running = false;
     thread.join();
 }
+
+namespace
+{
+std::string getAddress(const zeroeq::Publisher& publisher)
+{
+    return publisher.getURI().getHost() + ":" +
+           std::to_string(int(publisher.getURI().getPort()));
+}
+
+size_t publishReceive(zeroeq::Publisher& publisher,
+                      zeroeq::Subscriber& subscriber, size_t& received)
+{
+    for (size_t i = 0; i < 50 && received == 0; ++i)
+    {
+        publisher.publish(test::Echo(test::echoMessage));
+        subscriber.receive(100);
+    }
+    return received;
+}
+}
+
+BOOST_AUTO_TEST_CASE(publish_receive_static_env)
+{
+    zeroeq::Publisher publisher(zeroeq::NULL_SESSION);
+    setenv(zeroeq::ENV_PUBLISHERS.c_str(), getAddress(publisher).c_str(), 1);
+    zeroeq::Subscriber subscriber("zeroeq_test_static_env");
+    unsetenv(zeroeq::ENV_PUBLISHERS.c_str());
+
+    size_t received = 0;
+    BOOST_CHECK(subscriber.subscribe(test::Echo::IDENTIFIER(),
+                                     [&](const void*, size_t) { ++received; }));
+    BOOST_CHECK_GT(publishReceive(publisher, subscriber, received), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(publish_receive_static_file)
+{
+    const std::string filename =
+        "zeroeq.test.publishers." + std::to_string(getpid());
+    zeroeq::Publisher publisher1(zeroeq::NULL_SESSION);
+    zeroeq::Publisher publisher2(zeroeq::NULL_SESSION);
+    std::ofstream(filename) << "# test publishers" << std::endl
+                            << getAddress(publisher1) << std::endl;
+
+    setenv(zeroeq::ENV_PUBLISHERS_FILE.c_str(), filename.c_str(), 1);
+    zeroeq::Subscriber subscriber("zeroeq_test_static_file");
+    unsetenv(zeroeq::ENV_PUBLISHERS_FILE.c_str());
+
+    size_t received = 0;
+    BOOST_CHECK(subscriber.subscribe(test::Echo::IDENTIFIER(),
+                                     [&](const void*, size_t) { ++received; }));
+    BOOST_CHECK_GT(publishReceive(publisher1, subscriber, received), 0u);
+
+    // new entries are connected without restart
+    std::ofstream(filename, std::ios::app) << getAddress(publisher2)
+                                           << std::endl;
+    received = 0;
+    BOOST_CHECK_GT(publishReceive(publisher2, subscriber, received), 0u);
+
+    std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(publish_receive_static_and_zeroconf)
+{
+    zeroeq::Publisher publisher(zeroeq::TEST_SESSION);
+    zeroeq::detail::Sender::getUUID() =
+        servus::make_UUID(); // different machine
+    setenv(zeroeq::ENV_PUBLISHERS.c_str(), getAddress(publisher).c_str(), 1);
+    zeroeq::Subscriber subscriber(publisher.getSession());
+    unsetenv(zeroeq::ENV_PUBLISHERS.c_str());
+
+    size_t received = 0;
+    BOOST_CHECK(subscriber.subscribe(test::Echo::IDENTIFIER(),
+                                     [&](const void*, size_t) { ++received; }));
+    BOOST_CHECK_GT(publishReceive(publisher, subscriber, received), 0u);
+    for (size_t i = 0; i < 10; ++i) // let zeroconf find the same publisher
+        subscriber.receive(100);
+
+    // connected once, although discovered statically and by zeroconf
+    const size_t numEvents = 10;
+    received = 0;
+    for (size_t i = 0; i < numEvents; ++i)
+        BOOST_CHECK(publisher.publish(test::Echo(test::echoMessage)));
+    while (subscriber.receive(100))
+        /* NOP to drain */;
+    BOOST_CHECK_EQUAL(received, numEvents);
+}
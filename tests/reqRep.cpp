@@ -12,6 +12,8 @@
 
 #include <atomic>
 #include <chrono>
+#include <memory>
+#include <set>
 #include <thread>
 
 namespace
@@ -454,6 +456,642 @@ BOOST_AUTO_TEST_CASE(two_clients_shared)
     BOOST_CHECK(serverHandled);
 }
 
+namespace
+{
+zeroeq::HandleFunc sleeper(const std::atomic<unsigned>& milliseconds)
+{
+    return [&milliseconds](const void*, size_t) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+        return zeroeq::ReplyData{test::Empty::IDENTIFIER(), {}};
+    };
+}
+
+/** @return the reply latency in milliseconds, or TIMEOUT */
+float requestOnce(zeroeq::Client& client, const uint32_t timeout = 10)
+{
+    const auto start = std::chrono::steady_clock::now();
+    bool handled = false;
+    client.request(test::Empty::IDENTIFIER(), nullptr, 0,
+                   [&](const zeroeq::uint128_t&, const void*, size_t) {
+                       handled = true;
+                   });
+
+    float elapsed = 0.f;
+    while (!handled && elapsed < TIMEOUT)
+    {
+        client.receive(timeout);
+        elapsed = std::chrono::duration<float, std::milli>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+    }
+    return handled ? elapsed : TIMEOUT;
+}
+}
+
+BOOST_AUTO_TEST_CASE(latency_aware)
+{
+    const std::atomic<unsigned> fastTime{1};
+    const std::atomic<unsigned> slowTime{30};
+    zeroeq::Server fast(zeroeq::NULL_SESSION);
+    zeroeq::Server slow(zeroeq::NULL_SESSION);
+    fast.handle(test::Empty::IDENTIFIER(), sleeper(fastTime));
+    slow.handle(test::Empty::IDENTIFIER(), sleeper(slowTime));
+    zeroeq::Client client({fast.getURI(), slow.getURI()});
+
+    std::atomic<bool> running{true};
+    std::thread fastThread([&] {
+        while (running)
+            fast.receive(10);
+    });
+    std::thread slowThread([&] {
+        while (running)
+            slow.receive(10);
+    });
+
+    for (size_t i = 0; i < 20; ++i)
+        BOOST_CHECK_LT(requestOnce(client), TIMEOUT);
+
+    running = false;
+    fastThread.join();
+    slowThread.join();
+
+    // both servers are probed, then the fast one is preferred
+    const auto stats = client.getStats();
+    BOOST_REQUIRE_EQUAL(stats.size(), 2);
+    const auto& slowStats =
+        stats[0].latency > stats[1].latency ? stats[0] : stats[1];
+    const auto& fastStats =
+        stats[0].latency > stats[1].latency ? stats[1] : stats[0];
+    BOOST_CHECK_GE(slowStats.latency, 20000);
+    BOOST_CHECK_GE(slowStats.requests, 1);
+    BOOST_CHECK_LE(slowStats.requests, 2);
+    BOOST_CHECK_EQUAL(fastStats.requests + slowStats.requests, 20);
+    BOOST_CHECK_EQUAL(fastStats.outstanding, 0);
+    BOOST_CHECK_EQUAL(client.getNumHedged(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(hedging)
+{
+    const std::atomic<unsigned> steadyTime{5};
+    std::atomic<unsigned> stallingTime{1};
+    zeroeq::Server steady(zeroeq::NULL_SESSION);
+    zeroeq::Server stalling(zeroeq::NULL_SESSION);
+    steady.handle(test::Empty::IDENTIFIER(), sleeper(steadyTime));
+    stalling.handle(test::Empty::IDENTIFIER(), sleeper(stallingTime));
+    zeroeq::Client client({steady.getURI(), stalling.getURI()});
+    BOOST_CHECK_THROW(client.enableHedging(0.f), std::runtime_error);
+    client.enableHedging(0.5f);
+
+    std::atomic<bool> running{true};
+    std::thread steadyThread([&] {
+        while (running)
+            steady.receive(10);
+    });
+    std::thread stallingThread([&] {
+        while (running)
+            stalling.receive(10);
+    });
+
+    // learn that the stalling server is the fastest, then stall it
+    for (size_t i = 0; i < 20; ++i)
+        BOOST_CHECK_LT(requestOnce(client), TIMEOUT);
+    BOOST_CHECK_EQUAL(client.getNumHedged(), 0);
+    stallingTime = 300;
+
+    // hedges are sent during a long receive(), not only after it returned
+    for (size_t i = 0; i < 5; ++i)
+        BOOST_CHECK_LT(requestOnce(client, zeroeq::TIMEOUT_INDEFINITE), 150.f);
+    BOOST_CHECK_GE(client.getNumHedged(), 1);
+
+    running = false;
+    steadyThread.join();
+    stallingThread.join();
+}
+
+BOOST_AUTO_TEST_CASE(routing_key)
+{
+    const size_t numServers = 3;
+    const size_t numKeys = 30;
+    std::vector<zeroeq::Server> servers;
+    std::vector<std::set<std::string>> keys(numServers);
+    zeroeq::URIs uris;
+    for (size_t i = 0; i < numServers; ++i)
+    {
+        servers.emplace_back(zeroeq::Server(zeroeq::NULL_SESSION));
+        std::set<std::string>& served = keys[i];
+        servers.back().handle(test::Empty::IDENTIFIER(),
+                              [&served](const void* data, size_t size) {
+                                  served.insert(std::string(
+                                      static_cast<const char*>(data), size));
+                                  return zeroeq::ReplyData{
+                                      test::Empty::IDENTIFIER(), {}};
+                              });
+        uris.push_back(servers.back().getURI());
+    }
+    zeroeq::Client client(uris);
+
+    std::atomic<bool> running{true};
+    std::vector<std::thread> threads;
+    for (auto& server : servers)
+        threads.emplace_back([&server, &running] {
+            while (running)
+                server.receive(10);
+        });
+
+    size_t handled = 0;
+    for (size_t round = 0; round < 2; ++round)
+    {
+        for (size_t i = 0; i < numKeys; ++i)
+        {
+            const std::string key = "dataset" + std::to_string(i);
+            BOOST_CHECK(client.request(key, test::Empty::IDENTIFIER(),
+                                       key.data(), key.size(),
+                                       [&](const zeroeq::uint128_t&,
+                                           const void*, size_t) {
+                                           ++handled;
+                                       }));
+        }
+        while (handled < (round + 1) * numKeys)
+            BOOST_REQUIRE(client.receive(TIMEOUT));
+    }
+
+    running = false;
+    for (auto& thread : threads)
+        thread.join();
+
+    // each key is served by one server, and all servers serve keys
+    size_t numServed = 0;
+    for (const auto& served : keys)
+    {
+        BOOST_CHECK(!served.empty());
+        numServed += served.size();
+    }
+    BOOST_CHECK_EQUAL(numServed, numKeys);
+}
+
+BOOST_AUTO_TEST_CASE(routing_key_failover)
+{
+    std::unique_ptr<zeroeq::Server> servers[2];
+    std::set<std::string> keys[2];
+    zeroeq::URIs uris;
+    for (size_t i = 0; i < 2; ++i)
+    {
+        servers[i].reset(new zeroeq::Server(zeroeq::NULL_SESSION));
+        std::set<std::string>& served = keys[i];
+        servers[i]->handle(test::Empty::IDENTIFIER(),
+                           [&served](const void* data, size_t size) {
+                               served.insert(std::string(
+                                   static_cast<const char*>(data), size));
+                               return zeroeq::ReplyData{
+                                   test::Empty::IDENTIFIER(), {}};
+                           });
+        uris.push_back(servers[i]->getURI());
+    }
+    zeroeq::Client client(uris);
+
+    bool handled = false;
+    const auto request = [&](const std::string& key) {
+        handled = false;
+        BOOST_CHECK(client.request(key, test::Empty::IDENTIFIER(), key.data(),
+                                   key.size(),
+                                   [&](const zeroeq::uint128_t&, const void*,
+                                       size_t) { handled = true; }));
+        for (size_t i = 0; i < 100 && !handled; ++i)
+        {
+            for (const auto& server : servers)
+                if (server)
+                    server->receive(0);
+            client.receive(10);
+        }
+        return handled;
+    };
+
+    for (size_t i = 0; i < 20; ++i)
+        BOOST_CHECK(request("dataset" + std::to_string(i)));
+    BOOST_REQUIRE(!keys[0].empty());
+
+    // the keys of an unreachable owner go to the next server on the ring
+    const std::string key = *keys[0].begin();
+    servers[0].reset();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const auto start = std::chrono::steady_clock::now();
+    BOOST_CHECK(request(key));
+    BOOST_CHECK_EQUAL(keys[1].count(key), 1);
+    BOOST_CHECK_LT(std::chrono::duration<float>(
+                       std::chrono::steady_clock::now() - start)
+                       .count(),
+                   5.f);
+}
+
+BOOST_AUTO_TEST_CASE(broadcast)
+{
+    const test::Echo echo("The quick brown fox");
+    const test::Echo reply("Jumped over the lazy dog");
+    const auto func = [&](const void*, size_t) {
+        return zeroeq::ReplyData{test::Echo::IDENTIFIER(), reply.toBinary()};
+    };
+
+    zeroeq::Server server1(zeroeq::NULL_SESSION);
+    zeroeq::Server server2(zeroeq::NULL_SESSION);
+    zeroeq::Server silent(zeroeq::NULL_SESSION);
+    for (auto server : {&server1, &server2, &silent})
+        server->handle(test::Echo::IDENTIFIER(), func);
+    zeroeq::Client client(
+        zeroeq::URIs{server1.getURI(), server2.getURI(), silent.getURI()});
+
+    std::atomic<bool> running{true};
+    std::thread thread1([&] {
+        while (running)
+            server1.receive(10);
+    });
+    std::thread thread2([&] {
+        while (running)
+            server2.receive(10);
+    });
+
+    bool handled = false;
+    zeroeq::BroadcastReplies replies;
+    BOOST_CHECK(client.broadcast(echo, 200,
+                                 [&](const zeroeq::BroadcastReplies& result) {
+                                     BOOST_CHECK(!handled);
+                                     handled = true;
+                                     replies = result;
+                                 }));
+    const auto start = std::chrono::steady_clock::now();
+    while (!handled && std::chrono::steady_clock::now() - start <
+                           std::chrono::milliseconds(int(TIMEOUT)))
+    {
+        client.receive(10);
+    }
+    BOOST_REQUIRE(handled);
+    BOOST_REQUIRE_EQUAL(replies.size(), 3);
+
+    size_t numReplied = 0;
+    for (const auto& result : replies)
+    {
+        if (!result.replied)
+        {
+            BOOST_CHECK(!result.data.ptr);
+            continue;
+        }
+        ++numReplied;
+        BOOST_CHECK_EQUAL(result.replyID, test::Echo::IDENTIFIER());
+        test::Echo got;
+        BOOST_CHECK(got.fromBinary(result.data));
+        BOOST_CHECK_EQUAL(got, reply);
+    }
+    BOOST_CHECK_EQUAL(numReplied, 2);
+
+    // the request of the silent server is no longer outstanding
+    for (const auto& stats : client.getStats())
+        BOOST_CHECK_EQUAL(stats.outstanding, 0);
+
+    // the late reply of the silent server is dropped
+    BOOST_CHECK(silent.receive(TIMEOUT));
+    BOOST_CHECK_NO_THROW(client.receive(TIMEOUT / 10));
+    for (const auto& stats : client.getStats())
+        BOOST_CHECK_EQUAL(stats.outstanding, 0);
+
+    running = false;
+    thread1.join();
+    thread2.join();
+}
+
+namespace
+{
+zeroeq::ReplyData makeReply(const zeroeq::uint128_t& replyID,
+                            const std::string& text)
+{
+    auto copy = std::make_shared<std::string>(text);
+    zeroeq::ReplyData reply{replyID, {}};
+    reply.second.ptr.reset(copy->data(), [copy](const void*) {});
+    reply.second.size = copy->size();
+    return reply;
+}
+}
+
+BOOST_AUTO_TEST_CASE(batch)
+{
+    const auto lookupID = zeroeq::make_uint128("zeroeq::test::Lookup");
+    const auto textID = zeroeq::make_uint128("zeroeq::test::Text");
+    std::atomic<size_t> numBatches{0};
+    std::atomic<size_t> numRequests{0};
+
+    const auto lookup = [&](const zeroeq::Payloads& batch) {
+        ++numBatches;
+        std::vector<zeroeq::ReplyData> replies;
+        for (const auto& payload : batch)
+        {
+            if (!payload.data)
+            {
+                replies.push_back(zeroeq::ReplyData());
+                continue;
+            }
+            const std::string text(static_cast<const char*>(payload.data),
+                                   payload.size);
+            replies.push_back(makeReply(lookupID, text + "!"));
+        }
+        return replies;
+    };
+
+    zeroeq::Server server(zeroeq::NULL_SESSION);
+    BOOST_CHECK(server.handleBatch(lookupID, lookup));
+    BOOST_CHECK(server.handle(textID, [&](const void* data, size_t size) {
+        ++numRequests;
+        return makeReply(textID,
+                         data ? std::string(static_cast<const char*>(data),
+                                            size)
+                              : std::string());
+    }));
+    BOOST_CHECK(!server.handle(lookupID, [](const void*, size_t) {
+        return zeroeq::ReplyData();
+    }));
+    BOOST_CHECK(
+        !server.handleBatch(textID, [](const zeroeq::Payloads& batch) {
+            return std::vector<zeroeq::ReplyData>(batch.size());
+        }));
+
+    std::atomic<bool> running{true};
+    std::thread thread([&] {
+        while (running)
+            server.receive(10);
+    });
+
+    zeroeq::Client client({server.getURI()});
+    const std::vector<std::string> texts{"a", "bb", "", "ccc"};
+    zeroeq::Payloads payloads;
+    for (const auto& text : texts)
+        payloads.push_back({text.empty() ? nullptr : text.data(), text.size()});
+
+    std::vector<std::string> results(texts.size());
+    std::vector<zeroeq::uint128_t> replyIDs(texts.size());
+    size_t handled = 0;
+    std::vector<zeroeq::ReplyFunc> funcs;
+    for (size_t i = 0; i < texts.size(); ++i)
+        funcs.push_back([&, i](const zeroeq::uint128_t& replyID,
+                               const void* data, const size_t size) {
+            replyIDs[i] = replyID;
+            results[i] = data ? std::string(static_cast<const char*>(data),
+                                            size)
+                              : std::string();
+            ++handled;
+        });
+
+    // a batch handler is called once per batch
+    BOOST_CHECK(client.request(lookupID, payloads, funcs));
+    while (handled < texts.size())
+        BOOST_REQUIRE(client.receive(TIMEOUT));
+    BOOST_CHECK_EQUAL(numBatches, 1);
+    const std::vector<std::string> expected{"a!", "bb!", "", "ccc!"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(results.begin(), results.end(),
+                                  expected.begin(), expected.end());
+    BOOST_CHECK_EQUAL(replyIDs[0], lookupID);
+    BOOST_CHECK_EQUAL(replyIDs[2], zeroeq::uint128_t());
+
+    // a single request handler is called per request of a batch
+    handled = 0;
+    BOOST_CHECK(client.request(textID, payloads, funcs));
+    while (handled < texts.size())
+        BOOST_REQUIRE(client.receive(TIMEOUT));
+    BOOST_CHECK_EQUAL(numRequests, texts.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(results.begin(), results.end(),
+                                  texts.begin(), texts.end());
+
+    // a batch handler serves single requests as a batch of one
+    handled = 0;
+    BOOST_CHECK(client.request(lookupID, "x", 1, funcs[0]));
+    BOOST_REQUIRE(client.receive(TIMEOUT));
+    BOOST_CHECK_EQUAL(handled, 1);
+    BOOST_CHECK_EQUAL(numBatches, 2);
+    BOOST_CHECK_EQUAL(results[0], "x!");
+
+    BOOST_CHECK_THROW(client.request(lookupID, payloads, {funcs[0]}),
+                      std::runtime_error);
+
+    running = false;
+    thread.join();
+}
+
+BOOST_AUTO_TEST_CASE(reply_cache)
+{
+    const auto textID = zeroeq::make_uint128("zeroeq::test::Text");
+    size_t numExecuted = 0;
+
+    zeroeq::Server server(zeroeq::NULL_SESSION);
+    BOOST_CHECK(!server.enableCache(textID));
+    server.handle(textID, [&](const void* data, size_t size) {
+        ++numExecuted;
+        return makeReply(textID,
+                         std::string(static_cast<const char*>(data), size));
+    });
+    BOOST_CHECK(server.enableCache(textID));
+
+    zeroeq::Client client({server.getURI()});
+    const auto request = [&](const std::string& text) {
+        std::string result;
+        bool handled = false;
+        client.request(textID, text.data(), text.size(),
+                       [&](const zeroeq::uint128_t&, const void* data,
+                           size_t size) {
+                           result.assign(static_cast<const char*>(data), size);
+                           handled = true;
+                       });
+        BOOST_REQUIRE(server.receive(TIMEOUT));
+        while (!handled)
+            BOOST_REQUIRE(client.receive(TIMEOUT));
+        return result;
+    };
+
+    // repeated requests are served from the cache
+    for (size_t i = 0; i < 3; ++i)
+        BOOST_CHECK_EQUAL(request("hello"), "hello");
+    BOOST_CHECK_EQUAL(request("world"), "world");
+    BOOST_CHECK_EQUAL(numExecuted, 2);
+
+    auto stats = server.getCacheStats();
+    BOOST_CHECK_EQUAL(stats.hits, 2);
+    BOOST_CHECK_EQUAL(stats.misses, 2);
+    BOOST_CHECK_EQUAL(stats.entries, 2);
+    BOOST_CHECK_GT(stats.size, 10); // including the overhead of each entry
+    const size_t size = stats.size;
+
+    // invalidation of one reply
+    server.invalidate(textID, "hello", 5);
+    BOOST_CHECK_EQUAL(request("hello"), "hello");
+    BOOST_CHECK_EQUAL(request("world"), "world");
+    BOOST_CHECK_EQUAL(numExecuted, 3);
+
+    // eviction of the least recently used reply
+    server.setCacheSize(size - 1);
+    stats = server.getCacheStats();
+    BOOST_CHECK_EQUAL(stats.evictions, 1);
+    BOOST_CHECK_EQUAL(stats.entries, 1);
+    BOOST_CHECK_EQUAL(request("world"), "world");
+    BOOST_CHECK_EQUAL(numExecuted, 3);
+    server.setCacheSize(1024);
+
+    // expiry
+    BOOST_CHECK(server.disableCache(textID));
+    BOOST_CHECK_EQUAL(server.getCacheStats().entries, 0);
+    BOOST_CHECK(server.enableCache(textID, 50));
+    BOOST_CHECK_EQUAL(request("hello"), "hello");
+    BOOST_CHECK_EQUAL(request("hello"), "hello");
+    BOOST_CHECK_EQUAL(numExecuted, 4);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    BOOST_CHECK_EQUAL(request("hello"), "hello");
+    BOOST_CHECK_EQUAL(numExecuted, 5);
+
+    // empty replies are bounded by the overhead of their entries
+    server.remove(textID);
+    server.handle(textID, [&](const void*, size_t) {
+        ++numExecuted;
+        return makeReply(textID, std::string());
+    });
+    BOOST_CHECK(server.enableCache(textID));
+    server.setCacheSize(size);
+    for (size_t i = 0; i < 10; ++i)
+        request(std::to_string(i));
+    stats = server.getCacheStats();
+    BOOST_CHECK_EQUAL(stats.entries, 2);
+    BOOST_CHECK_LE(stats.size, size);
+}
+
+BOOST_AUTO_TEST_CASE(coalescing)
+{
+    const auto textID = zeroeq::make_uint128("zeroeq::test::Text");
+    std::vector<std::pair<std::string, zeroeq::AsyncReplyFunc>> pending;
+
+    zeroeq::Server server(zeroeq::NULL_SESSION);
+    BOOST_CHECK(!server.enableCoalescing(textID));
+    BOOST_CHECK(server.handleAsync(textID, [&](const void* data, size_t size,
+                                               const zeroeq::AsyncReplyFunc&
+                                                   reply) {
+        pending.emplace_back(std::string(static_cast<const char*>(data), size),
+                             reply);
+    }));
+    BOOST_CHECK(!server.handle(textID, [](const void*, size_t) {
+        return zeroeq::ReplyData();
+    }));
+    BOOST_CHECK(server.enableCoalescing(textID));
+
+    std::vector<std::unique_ptr<zeroeq::Client>> clients;
+    std::vector<std::string> results(4);
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        clients.emplace_back(new zeroeq::Client({server.getURI()}));
+        const std::string text = i == 0 ? "world" : "hello";
+        clients.back()->request(textID, text.data(), text.size(),
+                                [&results, i](const zeroeq::uint128_t&,
+                                              const void* data, size_t size) {
+                                    results[i].assign(
+                                        static_cast<const char*>(data), size);
+                                });
+    }
+
+    // the identical requests wait for the first execution
+    while (server.getNumCoalesced() < 2 || pending.size() < 2)
+        BOOST_REQUIRE(server.receive(TIMEOUT));
+    BOOST_CHECK_EQUAL(pending.size(), 2);
+
+    std::thread replier([&] {
+        for (const auto& request : pending)
+            request.second(makeReply(textID, request.first));
+    });
+    replier.join();
+
+    for (size_t i = 0; i < clients.size(); ++i)
+    {
+        while (results[i].empty())
+        {
+            server.receive(10);
+            clients[i]->receive(10);
+        }
+    }
+    BOOST_CHECK_EQUAL(results[0], "world");
+    for (size_t i = 1; i < results.size(); ++i)
+        BOOST_CHECK_EQUAL(results[i], "hello");
+    BOOST_CHECK_EQUAL(pending.size(), 2);
+    BOOST_CHECK_EQUAL(server.getNumCoalesced(), 2);
+
+    // a dropped reply function fails the flight and its coalesced requests
+    pending.clear();
+    size_t numFailed = 0;
+    const std::string text("again");
+    for (auto& client : clients)
+        client->request(textID, text.data(), text.size(),
+                        [&](const zeroeq::uint128_t& replyID, const void*,
+                            size_t) {
+                            if (replyID == zeroeq::uint128_t())
+                                ++numFailed;
+                        });
+    while (server.getNumCoalesced() < 5 || pending.empty())
+        BOOST_REQUIRE(server.receive(TIMEOUT));
+    BOOST_CHECK_EQUAL(pending.size(), 1);
+
+    pending.clear();
+    while (numFailed < clients.size())
+    {
+        server.receive(10);
+        for (auto& client : clients)
+            client->receive(10);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(client_cache)
+{
+    const auto textID = zeroeq::make_uint128("zeroeq::test::Text");
+    size_t numExecuted = 0;
+
+    zeroeq::Server server(zeroeq::NULL_SESSION);
+    server.handle(textID, [&](const void* data, size_t size) {
+        ++numExecuted;
+        return makeReply(textID,
+                         std::string(static_cast<const char*>(data), size));
+    });
+
+    zeroeq::Client client({server.getURI()});
+    client.enableCache(textID, 50);
+
+    const std::string text("hello");
+    std::vector<std::string> results;
+    const auto func = [&](const zeroeq::uint128_t&, const void* data,
+                          size_t size) {
+        results.emplace_back(static_cast<const char*>(data), size);
+    };
+
+    // an identical request waits for the outstanding one
+    BOOST_CHECK(client.request(textID, text.data(), text.size(), func));
+    BOOST_CHECK(client.request(textID, text.data(), text.size(), func));
+    BOOST_REQUIRE(server.receive(TIMEOUT));
+    while (results.size() < 2)
+        BOOST_REQUIRE(client.receive(TIMEOUT));
+    BOOST_CHECK_EQUAL(numExecuted, 1);
+    BOOST_CHECK_EQUAL(results[1], "hello");
+
+    // a cached reply is served synchronously
+    BOOST_CHECK(client.request(textID, text.data(), text.size(), func));
+    BOOST_CHECK_EQUAL(results.size(), 3);
+    BOOST_CHECK_EQUAL(results[2], "hello");
+
+    auto stats = client.getCacheStats();
+    BOOST_CHECK_EQUAL(stats.hits, 1);
+    BOOST_CHECK_EQUAL(stats.coalesced, 1);
+    BOOST_CHECK_EQUAL(stats.entries, 1);
+    BOOST_CHECK_GT(stats.size, 5); // including the overhead of the entry
+
+    // expiry
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    BOOST_CHECK(client.request(textID, text.data(), text.size(), func));
+    BOOST_CHECK_EQUAL(results.size(), 3);
+    BOOST_REQUIRE(server.receive(TIMEOUT));
+    while (results.size() < 4)
+        BOOST_REQUIRE(client.receive(TIMEOUT));
+    BOOST_CHECK_EQUAL(numExecuted, 2);
+
+    BOOST_CHECK(client.disableCache(textID));
+    BOOST_CHECK_EQUAL(client.getCacheStats().entries, 0);
+}
+
 BOOST_AUTO_TEST_CASE(exceptions)
 {
     BOOST_CHECK_THROW(zeroeq::Server(""), std::runtime_error);
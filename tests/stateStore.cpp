@@ -0,0 +1,140 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#define BOOST_TEST_MODULE zeroeq_state_store
+
+#include "common.h"
+
+#include <zeroeq/stateStore.h>
+
+namespace
+{
+const uint32_t TIMEOUT = 100; // milliseconds
+const size_t RETRIES = 50;
+
+bool synchronize(zeroeq::Server& server, zeroeq::Subscriber& subscriber,
+                 const zeroeq::StateStore& owner,
+                 const zeroeq::StateStore& replica)
+{
+    for (size_t i = 0; i < RETRIES; ++i)
+    {
+        if (replica.isSynchronized() &&
+            replica.getSequence() == owner.getSequence())
+        {
+            return true;
+        }
+        server.receive(0);
+        subscriber.receive(TIMEOUT);
+    }
+    return false;
+}
+
+/** @return true if both snapshots have the same keys and values. */
+bool equal(const zeroeq::StateStore::MapPtr& a,
+           const zeroeq::StateStore::MapPtr& b)
+{
+    if (a->size() != b->size())
+        return false;
+    for (const auto& entry : *a)
+    {
+        const auto i = b->find(entry.first);
+        if (i == b->end() || *i->second != *entry.second)
+            return false;
+    }
+    return true;
+}
+}
+
+BOOST_AUTO_TEST_CASE(owner)
+{
+    zeroeq::Publisher publisher(zeroeq::NULL_SESSION);
+    zeroeq::Server server(zeroeq::NULL_SESSION);
+    zeroeq::StateStore store("test", publisher, server);
+
+    BOOST_CHECK_EQUAL(store.getName(), "test");
+    BOOST_CHECK(store.isSynchronized());
+    BOOST_CHECK_EQUAL(store.getSequence(), 0u);
+    BOOST_CHECK(!store.get("answer"));
+
+    BOOST_CHECK(store.set("answer", "42"));
+    BOOST_CHECK_EQUAL(store.getSequence(), 1u);
+    BOOST_REQUIRE(store.get("answer"));
+    BOOST_CHECK_EQUAL(*store.get("answer"), "42");
+
+    const auto snapshot = store.getSnapshot();
+    BOOST_CHECK(store.erase("answer"));
+    BOOST_CHECK_EQUAL(store.getSequence(), 2u);
+    BOOST_CHECK(!store.get("answer"));
+    BOOST_CHECK_EQUAL(snapshot->size(), 1u); // snapshots are immutable
+
+    BOOST_CHECK_THROW(zeroeq::StateStore("test", publisher, server),
+                      std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(replica)
+{
+    zeroeq::Publisher publisher(
+        zeroeq::URI("inproc://zeroeq.test.state_store.publisher"),
+        zeroeq::NULL_SESSION);
+    zeroeq::Server server(zeroeq::URI("inproc://zeroeq.test.state_store.server"),
+                          zeroeq::NULL_SESSION);
+    zeroeq::StateStore owner("test", publisher, server);
+    BOOST_CHECK(owner.set("early", "snapshot"));
+    BOOST_CHECK(owner.set("erased", "snapshot"));
+
+    zeroeq::Subscriber subscriber(publisher.getURI());
+    zeroeq::Client client({server.getURI()}, subscriber);
+    zeroeq::StateStore replica("test", subscriber, client);
+    BOOST_CHECK(!replica.isSynchronized());
+    BOOST_CHECK_THROW(replica.set("key", "value"), std::runtime_error);
+    BOOST_CHECK_THROW(zeroeq::StateStore("test", subscriber, client),
+                      std::runtime_error);
+
+    BOOST_CHECK(owner.erase("erased"));
+    for (size_t i = 0; i < 10; ++i)
+        BOOST_CHECK(owner.set("key" + std::to_string(i), std::to_string(i)));
+
+    BOOST_CHECK(synchronize(server, subscriber, owner, replica));
+    BOOST_CHECK(equal(replica.getSnapshot(), owner.getSnapshot()));
+
+    const auto value = replica.get("early");
+    BOOST_REQUIRE(value);
+    BOOST_CHECK_EQUAL(*value, "snapshot");
+    BOOST_CHECK(!replica.get("erased"));
+
+    BOOST_CHECK(owner.set("early", "update"));
+    BOOST_CHECK(synchronize(server, subscriber, owner, replica));
+    BOOST_CHECK_EQUAL(*replica.get("early"), "update");
+    BOOST_CHECK_EQUAL(*value, "snapshot"); // readers keep their value
+}
+
+BOOST_AUTO_TEST_CASE(owner_restart)
+{
+    zeroeq::Publisher publisher(
+        zeroeq::URI("inproc://zeroeq.test.state_store.restart.publisher"),
+        zeroeq::NULL_SESSION);
+    zeroeq::Server server(
+        zeroeq::URI("inproc://zeroeq.test.state_store.restart.server"),
+        zeroeq::NULL_SESSION);
+    zeroeq::Subscriber subscriber(publisher.getURI());
+    zeroeq::Client client({server.getURI()}, subscriber);
+
+    std::unique_ptr<zeroeq::StateStore> owner(
+        new zeroeq::StateStore("test", publisher, server));
+    zeroeq::StateStore replica("test", subscriber, client);
+    for (size_t i = 0; i < 3; ++i)
+        BOOST_CHECK(owner->set("old" + std::to_string(i), "value"));
+    BOOST_CHECK(synchronize(server, subscriber, *owner, replica));
+    BOOST_CHECK_EQUAL(replica.getSequence(), 3u);
+
+    // the new owner restarts the sequence, its updates are not outdated
+    owner.reset(new zeroeq::StateStore("test", publisher, server));
+    BOOST_CHECK(owner->set("new", "value"));
+    BOOST_CHECK(synchronize(server, subscriber, *owner, replica));
+    BOOST_CHECK_EQUAL(replica.getSequence(), 1u);
+    BOOST_CHECK(equal(replica.getSnapshot(), owner->getSnapshot()));
+    BOOST_CHECK(!replica.get("old0"));
+    BOOST_REQUIRE(replica.get("new"));
+    BOOST_CHECK_EQUAL(*replica.get("new"), "value");
+}
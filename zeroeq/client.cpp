@@ -5,15 +5,41 @@
 
 #include "client.h"
 
+#include "detail/byteswap.h"
 #include "detail/common.h"
+#include "detail/hash.h"
+#include "detail/hashRing.h"
 #include "detail/receiver.h"
+#include "detail/replyCache.h"
 
 #include <servus/servus.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <deque>
+#include <limits>
+#include <map>
 #include <thread>
 #include <unordered_map>
 
 namespace zeroeq
 {
+namespace
+{
+const double latencyWeight = 0.25;     // of a new sample in the latency EWMA
+const size_t numSamples = 256;         // latencies kept for the hedging delay
+const size_t minSamples = 10;          // before hedging starts
+const uint64_t ownerTimeout = 1000000; // us to wait for an unreachable owner
+
+uint64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+}
+
 class Client::Impl : public detail::Receiver
 {
 public:
@@ -21,36 +47,19 @@ public:
         : detail::Receiver(SERVER_SERVICE, session == DEFAULT_SESSION
                                                ? getDefaultRepSession()
                                                : session)
-        , _servers(zmq_socket(getContext(), ZMQ_DEALER),
-                   [](void* s) { ::zmq_close(s); })
+        , _socket(zmq_socket(getContext(), ZMQ_ROUTER),
+                  [](void* s) { ::zmq_close(s); })
     {
-        const char* serversEnv = getenv("ZEROEQ_SERVERS");
-        if (!serversEnv)
-            return;
-
-        std::string servers(serversEnv);
-        while (!servers.empty())
-        {
-            const size_t pos = servers.find(',');
-            const std::string server = servers.substr(0, pos);
-            servers = pos == std::string::npos ? std::string()
-                                               : servers.substr(pos + 1);
-
-            const auto& zmqURI = buildZmqURI(URI(server));
-            if (!addConnection(zmqURI))
-                ZEROEQTHROW(std::runtime_error("Cannot connect client to " +
-                                               zmqURI + ": " +
-                                               zmq_strerror(zmq_errno())));
-        }
-
+        _init();
         update();
     }
 
     explicit Impl(const URIs& uris)
         : detail::Receiver(SERVER_SERVICE)
-        , _servers(zmq_socket(getContext(), ZMQ_DEALER),
-                   [](void* s) { ::zmq_close(s); })
+        , _socket(zmq_socket(getContext(), ZMQ_ROUTER),
+                  [](void* s) { ::zmq_close(s); })
     {
+        _init();
         for (const auto& uri : uris)
         {
             if (!uri.isFullyQualified())
@@ -67,39 +76,200 @@ public:
 
     ~Impl() {}
 
-    zmq::SocketPtr createSocket(const uint128_t&) final { return _servers; }
+    // All servers are connected on one socket, addressed by their URI
+    zmq::SocketPtr createSocket(const uint128_t&) final { return _socket; }
+
+    void prepareConnect(void* socket, const std::string& zmqURI) final
+    {
+        if (zmq_setsockopt(socket, detail::CONNECT_ROUTING_ID_OPTION,
+                           zmqURI.data(), zmqURI.size()) == -1)
+        {
+            ZEROEQTHROW(std::runtime_error(
+                "Cannot set routing id of server " + zmqURI + ": " +
+                zmq_strerror(zmq_errno())));
+        }
+    }
+
+    void connectionsChanged() final
+    {
+        const std::vector<std::string>& uris = getConnectionURIs();
+        for (const auto& uri : uris)
+        {
+            _servers[uri].stats.uri = uri;
+            _ring.add(uri);
+        }
+
+        for (auto i = _servers.begin(); i != _servers.end();)
+        {
+            if (std::binary_search(uris.begin(), uris.end(), i->first))
+                ++i;
+            else
+            {
+                _abandon(i->first);
+                _ring.remove(i->first);
+                i = _servers.erase(i);
+            }
+        }
+    }
+
+    void update()
+    {
+        detail::Receiver::update();
+        for (auto& i : _servers) // retry servers which were not connected yet
+            i.second.reachable = true;
+        _hedge();
+        _updateBroadcasts();
+    }
+
+    /** @return the time until the next hedge or broadcast deadline. */
+    uint32_t getUpdateTimeout()
+    {
+        uint64_t deadline = std::numeric_limits<uint64_t>::max();
+        if (_hedging != 0.f && _samples.size() >= minSamples)
+        {
+            const uint64_t delay = _getHedgeDelay();
+            for (const auto& i : _requests)
+            {
+                const Request& request = i.second;
+                if (!request.hedged && !request.replied &&
+                    request.attempts.size() == 1)
+                {
+                    deadline = std::min(deadline,
+                                        request.attempts.front().sent + delay);
+                }
+            }
+        }
+        for (const auto& i : _broadcasts)
+            deadline = std::min(deadline, i.second.deadline);
+
+        if (deadline == std::numeric_limits<uint64_t>::max())
+            return TIMEOUT_INDEFINITE;
+        const uint64_t time = now();
+        if (deadline <= time)
+            return 0;
+        return uint32_t(std::min((deadline - time + 999) / 1000,
+                                 uint64_t(TIMEOUT_INDEFINITE - 1)));
+    }
 
     bool request(uint128_t requestID, const void* data, const size_t size,
-                 const ReplyFunc& func)
+                 const ReplyFunc& func, const std::string* key = nullptr)
     {
-        const bool hasPayload = data && size > 0;
+        const bool cached = _cached.count(requestID) > 0;
+        const Key cacheKey(requestID,
+                           cached ? detail::hash128(data, size) : uint128_t());
+        if (cached)
+        {
+            if (const ReplyData* reply =
+                    _cache.get(requestID, cacheKey.second, now()))
+            {
+                func(reply->first, reply->second.ptr.get(), reply->second.size);
+                return true;
+            }
+
+            const auto pending = _pending.find(cacheKey);
+            if (pending != _pending.end()) // wait for the outstanding reply
+            {
+                _requests[pending->second].attached.push_back(func);
+                ++_numCoalesced;
+                return true;
+            }
+        }
+
         ++_id;
 #ifdef ZEROEQ_BIGENDIAN
         detail::byteswap(requestID); // convert to little endian wire protocol
 #endif
-
-        if (!_send(&_id, sizeof(_id), ZMQ_SNDMORE) ||
-            !_send(nullptr, 0, ZMQ_SNDMORE) || // frame delimiter
-            !_send(&requestID, sizeof(requestID), hasPayload ? ZMQ_SNDMORE : 0))
+        Request request;
+        request.func = func;
+        request.requestID = requestID;
+        request.cached = cached;
+        request.cacheKey = cacheKey;
+        if (key)
+        {
+            request.routed = true;
+            request.key = detail::HashRing::hash(key->data(), key->size());
+        }
+        const Payload payload{data, size};
+        if (!_send(_id, request, &payload, data && size > 0 ? 1 : 0,
+                   std::string(), true))
         {
             return false;
         }
 
-        if (hasPayload && !_send(data, size, 0))
-            return false;
+        if (_hedging > 0.f && data && size > 0) // keep payload for a resend
+            request.payload.assign(static_cast<const char*>(data), size);
+        _requests.emplace(_id, std::move(request));
+        if (cached)
+            _pending[cacheKey] = _id;
+        return true;
+    }
 
-        _handlers[_id] = func;
+    bool broadcast(uint128_t requestID, const void* data, const size_t size,
+                   const uint32_t timeout, const BroadcastFunc& func)
+    {
+#ifdef ZEROEQ_BIGENDIAN
+        detail::byteswap(requestID); // convert to little endian wire protocol
+#endif
+        const uint64_t id = ++_id;
+        Broadcast& broadcast = _broadcasts[id];
+        broadcast.func = func;
+        broadcast.requestID = requestID;
+        if (data && size > 0)
+            broadcast.payload.assign(static_cast<const char*>(data), size);
+        broadcast.deadline = timeout == TIMEOUT_INDEFINITE
+                                 ? std::numeric_limits<uint64_t>::max()
+                                 : now() + uint64_t(timeout) * 1000;
+
+        for (const auto& i : _servers)
+        {
+            BroadcastReply reply;
+            reply.server = i.first;
+            broadcast.replies.push_back(reply);
+            broadcast.unsent.push_back(broadcast.replies.size() - 1);
+        }
+        _sendBroadcast(id, broadcast);
+        return true;
+    }
+
+    bool request(uint128_t requestID, const Payloads& payloads,
+                 const std::vector<ReplyFunc>& funcs)
+    {
+        if (payloads.size() != funcs.size())
+            ZEROEQTHROW(std::runtime_error(
+                "Batch request needs one reply function per payload, got " +
+                std::to_string(funcs.size()) + " for " +
+                std::to_string(payloads.size())));
+        if (payloads.empty())
+            return true;
+
+        ++_id;
+#ifdef ZEROEQ_BIGENDIAN
+        detail::byteswap(requestID); // convert to little endian wire protocol
+#endif
+        Request request;
+        request.funcs = funcs;
+        request.requestID = requestID;
+        request.hedged = true; // payloads are not kept for a resend
+        if (!_send(_id, request, payloads.data(), payloads.size(),
+                   std::string(), true))
+        {
+            return false;
+        }
+        _requests.emplace(_id, std::move(request));
         return true;
     }
 
-    bool process(detail::Socket& socket)
+    bool process(detail::Socket&)
     {
+        std::string server;
         uint64_t id;
         uint128_t replyID;
 
-        if (!_recv(&id, sizeof(id), ZMQ_DONTWAIT) || !_recv(nullptr, 0, 0))
+        if (!_recv(server, ZMQ_DONTWAIT))
             return false;
-        const bool payload = _recv(&replyID, sizeof(replyID), 0);
+        if (!_recv(&id, sizeof(id)) || !_recv(nullptr, 0))
+            return false;
+        const bool payload = _recv(&replyID, sizeof(replyID));
 
 #ifdef ZEROEQ_BIGENDIAN
         detail::byteswap(replyID); // convert to little endian wire protocol
@@ -109,67 +279,397 @@ public:
         if (payload)
         {
             zmq_msg_init(&msg);
-            zmq_msg_recv(&msg, socket.socket, 0);
+            zmq_msg_recv(&msg, _socket.get(), 0);
         }
 
-        auto i = _handlers.find(id);
-        if (i == _handlers.cend())
+        auto i = _requests.find(id);
+        if (i == _requests.cend())
         {
             if (payload)
                 zmq_msg_close(&msg);
+            if (_expired.erase(id) > 0) // reply after a broadcast timeout
+                return false;
 
             ZEROEQTHROW(std::runtime_error("Got unrequested reply " +
                                            std::to_string(id)));
         }
 
-        if (payload)
+        Request& request = i->second;
+        _complete(request, server);
+        if (!request.funcs.empty())
         {
-            i->second(replyID, zmq_msg_data(&msg), zmq_msg_size(&msg));
-            zmq_msg_close(&msg);
+            _processBatch(i, replyID, payload ? &msg : nullptr);
+            return true;
         }
+
+        if (request.broadcast)
+        {
+            auto j = _broadcasts.find(request.broadcast);
+            if (j != _broadcasts.end()) // else a reply after the timeout
+            {
+                BroadcastReply& reply = j->second.replies[request.index];
+                reply.replied = true;
+                reply.replyID = replyID;
+                if (payload)
+                {
+                    // keep the message instead of copying its data
+                    zmq_msg_t* data = new zmq_msg_t;
+                    zmq_msg_init(data);
+                    zmq_msg_move(data, &msg);
+                    reply.data.size = zmq_msg_size(data);
+                    reply.data.ptr.reset(zmq_msg_data(data),
+                                         [data](const void*) {
+                                             zmq_msg_close(data);
+                                             delete data;
+                                         });
+                }
+                --j->second.outstanding;
+            }
+            _requests.erase(i);
+            if (payload)
+                zmq_msg_close(&msg);
+            _updateBroadcasts();
+            return true;
+        }
+
+        if (request.replied) // late reply of a hedged request
+        {
+            if (request.attempts.empty())
+                _requests.erase(i);
+            if (payload)
+                zmq_msg_close(&msg);
+            return true;
+        }
+
+        // reply handlers may send new requests
+        const ReplyFunc func = std::move(request.func);
+        const std::vector<ReplyFunc> attached = std::move(request.attached);
+        const bool cached = request.cached;
+        const Key cacheKey = request.cacheKey;
+        if (cached)
+            _pending.erase(cacheKey);
+        if (request.attempts.empty())
+            _requests.erase(i);
         else
-            i->second(replyID, nullptr, 0);
-        _handlers.erase(i);
+        {
+            request.replied = true;
+            request.payload.clear();
+        }
+
+        const void* data = payload ? zmq_msg_data(&msg) : nullptr;
+        const size_t size = payload ? zmq_msg_size(&msg) : 0;
+        if (cached)
+            _put(cacheKey, replyID, data, size);
+
+        func(replyID, data, size);
+        for (const ReplyFunc& waiter : attached)
+            waiter(replyID, data, size);
+        if (payload)
+            zmq_msg_close(&msg);
+        _hedge();
         return true;
     }
 
+    void enableCache(const uint128_t& request, const uint32_t ttl)
+    {
+        _cached[request] = ttl;
+    }
+
+    bool disableCache(const uint128_t& request)
+    {
+        _cache.invalidate(request);
+        return _cached.erase(request) > 0;
+    }
+
+    void invalidate(const uint128_t& request) { _cache.invalidate(request); }
+    void invalidate(const uint128_t& request, const void* data,
+                    const size_t size)
+    {
+        _cache.invalidate(request, detail::hash128(data, size));
+    }
+
+    void setCacheSize(const size_t bytes) { _cache.setMaxSize(bytes); }
+    size_t getCacheSize() const { return _cache.getMaxSize(); }
+
+    CacheStats getCacheStats() const
+    {
+        CacheStats stats;
+        stats.hits = _cache.getNumHits();
+        stats.misses = _cache.getNumMisses();
+        stats.coalesced = _numCoalesced;
+        stats.evictions = _cache.getNumEvictions();
+        stats.entries = _cache.getNumEntries();
+        stats.size = _cache.getSize();
+        return stats;
+    }
+
+    void enableHedging(const float percentile)
+    {
+        if (percentile <= 0.f || percentile > 1.f)
+            ZEROEQTHROW(std::runtime_error(
+                "Hedging percentile must be in (0, 1], got " +
+                std::to_string(percentile)));
+        _hedging = percentile;
+        _hedgeDelay = 0;
+    }
+
+    void disableHedging() { _hedging = 0.f; }
+    uint64_t getNumHedged() const { return _numHedged; }
+
+    std::vector<Stats> getStats() const
+    {
+        std::vector<Stats> stats;
+        for (const auto& i : _servers)
+            stats.push_back(i.second.stats);
+        return stats;
+    }
+
 private:
-    bool _send(const void* data, const size_t size, int flags)
+    using Key = detail::ReplyCache::Key;
+    using KeyHash = detail::ReplyCache::KeyHash;
+
+    struct Server
     {
-        zmq_msg_t msg;
-        zmq_msg_init_size(&msg, size);
-        if (data)
-            ::memcpy(zmq_msg_data(&msg), data, size);
+        Stats stats;
+        double latency{0};    // EWMA in microseconds, 0 until first reply
+        bool reachable{true}; // false until connected
+    };
+
+    struct Attempt
+    {
+        std::string server;
+        uint64_t sent;
+    };
+
+    struct Request
+    {
+        ReplyFunc func;
+        std::vector<ReplyFunc> funcs; // one per request of a batch
+        uint128_t requestID; // in wire byte order
+        std::string payload; // only kept while hedging
+        std::vector<Attempt> attempts;
+        bool routed{false}; // to the owner of the key on the hash ring
+        uint64_t key{0};
+        bool hedged{false};
+        bool replied{false};   // waiting for the late reply of a hedge
+        uint64_t broadcast{0}; // part of this broadcast, if not 0
+        size_t index{0};       // of the server in the broadcast replies
+        bool cached{false};    // reply is cached under the cache key
+        Key cacheKey;          // request ID in host byte order, payload hash
+        std::vector<ReplyFunc> attached; // identical requests sent meanwhile
+    };
+
+    struct Broadcast
+    {
+        BroadcastFunc func;
+        uint128_t requestID;        // in wire byte order
+        std::string payload;        // until sent to all servers
+        BroadcastReplies replies;   // one per server
+        std::vector<size_t> unsent; // replies of servers not connected yet
+        size_t outstanding{0};      // sent requests without reply
+        std::vector<uint64_t> sent; // request of each server, by ID
+        uint64_t deadline{0};
+    };
+
+    zmq::SocketPtr _socket;
+    std::map<std::string, Server> _servers; // by URI, the routing id
+    detail::HashRing _ring;                 // of the server URIs
+    std::unordered_map<uint64_t, Request> _requests;
+    std::map<uint64_t, Broadcast> _broadcasts;
+    std::unordered_map<uint64_t, std::string> _expired; // server by request
+    uint64_t _id{0};
+
+    float _hedging{0.f}; // percentile of the hedging delay, 0 if disabled
+    uint64_t _numHedged{0};
+    std::vector<uint64_t> _samples; // recent reply latencies, ring buffer
+    size_t _nextSample{0};
+    uint64_t _hedgeDelay{0}; // 0 if outdated
+
+    std::unordered_map<uint128_t, uint32_t> _cached; // TTL by request
+    detail::ReplyCache _cache;
+    std::unordered_map<Key, uint64_t, KeyHash> _pending; // cached requests
+    uint64_t _numCoalesced{0};
+
+    void _init()
+    {
+        const int on = 1; // report unconnected servers instead of dropping
+        zmq_setsockopt(_socket.get(), ZMQ_ROUTER_MANDATORY, &on, sizeof(on));
+    }
+
+    /**
+     * @return the owner of the key for routed requests, the connected server
+     *         with the lowest expected latency otherwise, or nullptr if the
+     *         server is not connected
+     */
+    Server* _select(const Request& request, const std::string& exclude,
+                    const bool failover = false)
+    {
+        if (request.routed)
+        {
+            // wait for an unconnected owner instead of moving its keys, unless
+            // failing over to the next reachable server on the ring
+            const std::string* uri =
+                _ring.find(request.key, [&](const std::string& candidate) {
+                    return candidate != exclude &&
+                           (!failover || _servers[candidate].reachable);
+                });
+            if (!uri)
+                return nullptr;
+            Server& server = _servers[*uri];
+            return server.reachable ? &server : nullptr;
+        }
+
+        // Servers without a measured latency are assumed to be as fast as the
+        // fastest one, so that they are probed.
+        double fastest = 0;
+        for (const auto& i : _servers)
+        {
+            const double latency = i.second.latency;
+            if (latency > 0 && (fastest == 0 || latency < fastest))
+                fastest = latency;
+        }
+        if (fastest == 0)
+            fastest = 1;
+
+        Server* best = nullptr;
+        double bestCost = 0;
+        for (auto& i : _servers)
+        {
+            Server& server = i.second;
+            if (!server.reachable || i.first == exclude)
+                continue;
 
-        flags |= ZMQ_DONTWAIT;
+            // queued requests are served before a new one
+            const double cost =
+                (server.latency > 0 ? server.latency : fastest) *
+                (server.stats.outstanding + 1);
+            if (!best || cost < bestCost ||
+                (cost == bestCost &&
+                 server.stats.requests < best->stats.requests))
+            {
+                best = &server;
+                bestCost = cost;
+            }
+        }
+        return best;
+    }
+
+    /**
+     * Send the request to the selected server other than the excluded one,
+     * optionally waiting for a server to become available.
+     */
+    bool _send(const uint64_t id, Request& request, const Payload* payloads,
+               const size_t numPayloads, const std::string& exclude,
+               const bool wait)
+    {
+        const uint64_t start = now();
+        bool failover = false;
         while (true)
         {
-            const int ret = zmq_msg_send(&msg, _servers.get(), flags);
-            if (ret == -1 && zmq_errno() == EAGAIN)
+            Server* server = _select(request, exclude, failover);
+            if (!server)
             {
-                if (!update())
+                if (!wait)
+                    return false;
+                if (request.routed && !failover &&
+                    now() - start >= ownerTimeout)
+                {
+                    ZEROEQINFO << "Owner of routed request is unreachable, "
+                                  "sending it to the next server"
+                               << std::endl;
+                    failover = true;
+                    continue;
+                }
+                if (!detail::Receiver::update())
                     std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                for (auto& i : _servers) // retry servers not connected before
+                    i.second.reachable = true;
+                continue;
             }
-            else
-            {
-                zmq_msg_close(&msg);
-
-                if (ret != -1)
-                    return true;
 
-                ZEROEQWARN << "Cannot send request: "
-                           << zmq_strerror(zmq_errno()) << std::endl;
+            switch (_sendTo(*server, id, request, payloads, numPayloads))
+            {
+            case SENT:
+                return true;
+            case NOT_READY:
+                server->reachable = false; // unconnected or overloaded
+                continue;
+            default:
                 return false;
             }
         }
     }
 
+    enum SendResult
+    {
+        SENT,
+        NOT_READY,
+        SEND_ERROR
+    };
+
+    /**
+     * Send [id][empty][request ID][payload], or for a batch
+     * [id][empty][request ID, size][payload]* with one frame per request.
+     */
+    SendResult _sendTo(Server& server, const uint64_t id, Request& request,
+                       const Payload* payloads, const size_t numPayloads)
+    {
+        const std::string& uri = server.stats.uri;
+        if (zmq_send(_socket.get(), uri.data(), uri.size(),
+                     ZMQ_SNDMORE | ZMQ_DONTWAIT) == -1)
+        {
+            if (zmq_errno() == EHOSTUNREACH || zmq_errno() == EAGAIN)
+                return NOT_READY;
+            ZEROEQWARN << "Cannot send request: " << zmq_strerror(zmq_errno())
+                       << std::endl;
+            return SEND_ERROR;
+        }
+
+        uint8_t header[sizeof(uint128_t) + sizeof(uint32_t)];
+        size_t headerSize = sizeof(uint128_t);
+        ::memcpy(header, &request.requestID, sizeof(uint128_t));
+        if (!request.funcs.empty())
+        {
+            uint32_t batchSize = uint32_t(numPayloads);
+#ifdef ZEROEQ_BIGENDIAN
+            detail::byteswap(batchSize); // convert to little endian
+#endif
+            ::memcpy(header + headerSize, &batchSize, sizeof(batchSize));
+            headerSize += sizeof(batchSize);
+        }
+
+        bool sent = _sendFrame(&id, sizeof(id), ZMQ_SNDMORE) &&
+                    _sendFrame(nullptr, 0, ZMQ_SNDMORE) && // frame delimiter
+                    _sendFrame(header, headerSize,
+                               numPayloads > 0 ? ZMQ_SNDMORE : 0);
+        for (size_t i = 0; sent && i < numPayloads; ++i)
+            sent = _sendFrame(payloads[i].data, payloads[i].size,
+                              i + 1 < numPayloads ? ZMQ_SNDMORE : 0);
+        if (!sent)
+        {
+            ZEROEQWARN << "Cannot send request: " << zmq_strerror(zmq_errno())
+                       << std::endl;
+            return SEND_ERROR;
+        }
+
+        request.attempts.push_back({uri, now()});
+        ++server.stats.outstanding;
+        ++server.stats.requests;
+        return SENT;
+    }
+
+    bool _sendFrame(const void* data, const size_t size, const int flags)
+    {
+        // the first frame was accepted, the remaining ones do not block
+        return zmq_send(_socket.get(), data, size, flags) != -1;
+    }
+
     /** @return true if more data available */
-    bool _recv(void* data, const size_t size, const int flags)
+    bool _recv(void* data, const size_t size, const int flags = 0)
     {
         zmq_msg_t msg;
         zmq_msg_init(&msg);
-        if (zmq_msg_recv(&msg, _servers.get(), flags) == -1)
+        if (zmq_msg_recv(&msg, _socket.get(), flags) == -1)
             return false;
 
         if (zmq_msg_size(&msg) != size)
@@ -182,9 +682,307 @@ private:
         return more;
     }
 
-    zmq::SocketPtr _servers;
-    std::unordered_map<uint64_t, ReplyFunc> _handlers;
-    uint64_t _id{0};
+    bool _recv(std::string& data, const int flags)
+    {
+        zmq_msg_t msg;
+        zmq_msg_init(&msg);
+        if (zmq_msg_recv(&msg, _socket.get(), flags) == -1)
+            return false;
+
+        data.assign(static_cast<const char*>(zmq_msg_data(&msg)),
+                    zmq_msg_size(&msg));
+        const bool more = zmq_msg_more(&msg);
+        zmq_msg_close(&msg);
+        return more;
+    }
+
+    /**
+     * Receive the remaining [reply ID][payload] frames of a batch reply and
+     * execute the reply functions.
+     */
+    void _processBatch(std::unordered_map<uint64_t, Request>::iterator i,
+                       const uint128_t& replyID, zmq_msg_t* msg)
+    {
+        // reply handlers may send new requests
+        const std::vector<ReplyFunc> funcs = std::move(i->second.funcs);
+        _requests.erase(i);
+
+        std::vector<uint128_t> replyIDs{replyID};
+        std::deque<zmq_msg_t> messages; // does not move received messages
+        messages.emplace_back();
+        zmq_msg_init(&messages.back());
+        bool more = false;
+        if (msg)
+        {
+            zmq_msg_move(&messages.back(), msg);
+            zmq_msg_close(msg);
+            more = zmq_msg_more(&messages.back());
+        }
+
+        while (more)
+        {
+            uint128_t id;
+            const bool payload = _recv(&id, sizeof(id));
+#ifdef ZEROEQ_BIGENDIAN
+            detail::byteswap(id); // convert to little endian wire protocol
+#endif
+            messages.emplace_back();
+            zmq_msg_t& data = messages.back();
+            zmq_msg_init(&data);
+            more = payload && zmq_msg_recv(&data, _socket.get(), 0) != -1 &&
+                   zmq_msg_more(&data);
+            if (replyIDs.size() < funcs.size())
+                replyIDs.push_back(id);
+        }
+
+        // missing replies, e.g., a batch refused by a server, are failures
+        for (size_t j = 0; j < funcs.size(); ++j)
+        {
+            zmq_msg_t* data = j < replyIDs.size() ? &messages[j] : nullptr;
+            if (data && zmq_msg_size(data) > 0)
+                funcs[j](replyIDs[j], zmq_msg_data(data), zmq_msg_size(data));
+            else
+                funcs[j](j < replyIDs.size() ? replyIDs[j] : uint128_t(),
+                         nullptr, 0);
+        }
+
+        for (zmq_msg_t& message : messages)
+            zmq_msg_close(&message);
+    }
+
+    /** Account the reply of the given server to the request. */
+    void _complete(Request& request, const std::string& uri)
+    {
+        const auto attempt =
+            std::find_if(request.attempts.begin(), request.attempts.end(),
+                         [&uri](const Attempt& candidate) {
+                             return candidate.server == uri;
+                         });
+        if (attempt == request.attempts.end())
+            return;
+
+        const uint64_t latency = now() - attempt->sent;
+        request.attempts.erase(attempt);
+
+        auto i = _servers.find(uri);
+        if (i == _servers.end())
+            return;
+
+        Server& server = i->second;
+        --server.stats.outstanding;
+        ++server.stats.replies;
+        server.latency = server.latency == 0
+                             ? double(latency)
+                             : server.latency +
+                                   latencyWeight * (latency - server.latency);
+        server.stats.latency = uint64_t(server.latency);
+
+        if (_samples.size() < numSamples)
+            _samples.push_back(latency);
+        else
+            _samples[_nextSample] = latency;
+        _nextSample = (_nextSample + 1) % numSamples;
+        _hedgeDelay = 0;
+    }
+
+    /** Cache a successful reply of a request which is still cached. */
+    void _put(const Key& key, const uint128_t& replyID, const void* data,
+              const size_t size)
+    {
+        const auto ttl = _cached.find(key.first);
+        if (ttl == _cached.end() || replyID == uint128_t()) // failed request
+            return;
+
+        ReplyData reply{replyID, {}};
+        if (data && size > 0) // copied by the cache
+        {
+            reply.second.ptr.reset(data, [](const void*) {});
+            reply.second.size = size;
+        }
+        const uint64_t time = now();
+        const uint64_t expires =
+            ttl->second == TIMEOUT_INDEFINITE
+                ? std::numeric_limits<uint64_t>::max()
+                : time + uint64_t(ttl->second) * 1000;
+        _cache.put(key.first, key.second, reply, expires);
+    }
+
+    /** Drop the outstanding requests on a removed server. */
+    void _abandon(const std::string& uri)
+    {
+        for (auto i = _expired.begin(); i != _expired.end();)
+        {
+            if (i->second == uri)
+                i = _expired.erase(i);
+            else
+                ++i;
+        }
+
+        for (auto i = _requests.begin(); i != _requests.end();)
+        {
+            Request& request = i->second;
+            request.attempts.erase(
+                std::remove_if(request.attempts.begin(), request.attempts.end(),
+                               [&uri](const Attempt& attempt) {
+                                   return attempt.server == uri;
+                               }),
+                request.attempts.end());
+
+            if (!request.attempts.empty())
+                ++i;
+            else
+            {
+                if (request.broadcast)
+                {
+                    auto j = _broadcasts.find(request.broadcast);
+                    if (j != _broadcasts.end())
+                        --j->second.outstanding;
+                }
+                else if (!request.replied)
+                    ZEROEQWARN << "Lost request on server " << uri
+                               << std::endl;
+                if (request.cached && !request.replied)
+                    _pending.erase(request.cacheKey);
+                i = _requests.erase(i);
+            }
+        }
+    }
+
+    /** Send the broadcast to the servers which are connected now. */
+    void _sendBroadcast(const uint64_t id, Broadcast& broadcast)
+    {
+        auto unsent = broadcast.unsent.begin();
+        while (unsent != broadcast.unsent.end())
+        {
+            const size_t index = *unsent;
+            auto i = _servers.find(broadcast.replies[index].server);
+            if (i == _servers.end()) // removed, reported without reply
+            {
+                unsent = broadcast.unsent.erase(unsent);
+                continue;
+            }
+
+            Request request;
+            request.requestID = broadcast.requestID;
+            request.hedged = true; // only sent to this server
+            request.broadcast = id;
+            request.index = index;
+            const Payload payload{broadcast.payload.data(),
+                                  broadcast.payload.size()};
+            switch (_sendTo(i->second, _id + 1, request, &payload,
+                            broadcast.payload.empty() ? 0 : 1))
+            {
+            case SENT:
+                _requests.emplace(++_id, std::move(request));
+                broadcast.sent.push_back(_id);
+                ++broadcast.outstanding;
+                unsent = broadcast.unsent.erase(unsent);
+                break;
+            case NOT_READY:
+                i->second.reachable = false;
+                ++unsent;
+                break;
+            default:
+                unsent = broadcast.unsent.erase(unsent);
+                break;
+            }
+        }
+        if (broadcast.unsent.empty())
+            broadcast.payload.clear();
+    }
+
+    /** Drop the requests of servers which did not reply to the broadcast. */
+    void _expire(const Broadcast& broadcast)
+    {
+        for (const uint64_t id : broadcast.sent)
+        {
+            auto i = _requests.find(id);
+            if (i == _requests.end()) // replied
+                continue;
+
+            for (const Attempt& attempt : i->second.attempts)
+            {
+                auto j = _servers.find(attempt.server);
+                if (j != _servers.end())
+                    --j->second.stats.outstanding;
+                _expired[id] = attempt.server; // drop its late reply
+            }
+            _requests.erase(i);
+        }
+    }
+
+    /** Send to new connected servers and complete finished broadcasts. */
+    void _updateBroadcasts()
+    {
+        const uint64_t time = now();
+        std::vector<uint64_t> finished;
+        for (auto& i : _broadcasts)
+        {
+            Broadcast& broadcast = i.second;
+            if (!broadcast.unsent.empty())
+                _sendBroadcast(i.first, broadcast);
+            if ((broadcast.unsent.empty() && broadcast.outstanding == 0) ||
+                time >= broadcast.deadline)
+            {
+                finished.push_back(i.first);
+            }
+        }
+
+        // callbacks may send new broadcasts
+        for (const uint64_t id : finished)
+        {
+            auto i = _broadcasts.find(id);
+            _expire(i->second);
+            const BroadcastFunc func = std::move(i->second.func);
+            const BroadcastReplies replies = std::move(i->second.replies);
+            _broadcasts.erase(i);
+            func(replies);
+        }
+    }
+
+    uint64_t _getHedgeDelay()
+    {
+        if (_hedgeDelay == 0)
+        {
+            std::vector<uint64_t> samples = _samples;
+            const size_t index =
+                std::min(size_t(_hedging * samples.size()), samples.size() - 1);
+            std::nth_element(samples.begin(), samples.begin() + index,
+                             samples.end());
+            _hedgeDelay = std::max(samples[index], uint64_t(1));
+        }
+        return _hedgeDelay;
+    }
+
+    /** Re-send requests outstanding longer than the hedging delay. */
+    void _hedge()
+    {
+        if (_hedging == 0.f || _samples.size() < minSamples)
+            return;
+
+        const uint64_t delay = _getHedgeDelay();
+        const uint64_t time = now();
+        for (auto& i : _requests)
+        {
+            Request& request = i.second;
+            if (request.hedged || request.replied ||
+                request.attempts.size() != 1 ||
+                time - request.attempts.front().sent < delay)
+            {
+                continue;
+            }
+
+            request.hedged = true;
+            const std::string first = request.attempts.front().server;
+            const Payload payload{request.payload.data(),
+                                  request.payload.size()};
+            if (_send(i.first, request, &payload,
+                      request.payload.empty() ? 0 : 1, first, false))
+            {
+                ++_numHedged;
+            }
+        }
+    }
 };
 
 Client::Client()
@@ -239,6 +1037,98 @@ bool Client::request(const uint128_t& requestID, const void* data,
     return _impl->request(requestID, data, size, func);
 }
 
+bool Client::request(const std::string& key,
+                     const servus::Serializable& req, const ReplyFunc& func)
+{
+    const auto& data = req.toBinary();
+    return request(key, req.getTypeIdentifier(), data.ptr.get(), data.size,
+                   func);
+}
+
+bool Client::request(const std::string& key, const uint128_t& requestID,
+                     const void* data, const size_t size,
+                     const ReplyFunc& func)
+{
+    return _impl->request(requestID, data, size, func, &key);
+}
+
+void Client::enableHedging(const float percentile)
+{
+    _impl->enableHedging(percentile);
+}
+
+void Client::disableHedging()
+{
+    _impl->disableHedging();
+}
+
+uint64_t Client::getNumHedged() const
+{
+    return _impl->getNumHedged();
+}
+
+bool Client::broadcast(const servus::Serializable& req, const uint32_t timeout,
+                       const BroadcastFunc& func)
+{
+    const auto& data = req.toBinary();
+    return broadcast(req.getTypeIdentifier(), data.ptr.get(), data.size,
+                     timeout, func);
+}
+
+bool Client::broadcast(const uint128_t& requestID, const void* data,
+                       const size_t size, const uint32_t timeout,
+                       const BroadcastFunc& func)
+{
+    return _impl->broadcast(requestID, data, size, timeout, func);
+}
+
+bool Client::request(const uint128_t& requestID, const Payloads& payloads,
+                     const std::vector<ReplyFunc>& funcs)
+{
+    return _impl->request(requestID, payloads, funcs);
+}
+
+void Client::enableCache(const uint128_t& request, const uint32_t ttl)
+{
+    _impl->enableCache(request, ttl);
+}
+
+bool Client::disableCache(const uint128_t& request)
+{
+    return _impl->disableCache(request);
+}
+
+void Client::invalidate(const uint128_t& request)
+{
+    _impl->invalidate(request);
+}
+
+void Client::invalidate(const uint128_t& request, const void* data,
+                        const size_t size)
+{
+    _impl->invalidate(request, data, size);
+}
+
+void Client::setCacheSize(const size_t bytes)
+{
+    _impl->setCacheSize(bytes);
+}
+
+size_t Client::getCacheSize() const
+{
+    return _impl->getCacheSize();
+}
+
+Client::CacheStats Client::getCacheStats() const
+{
+    return _impl->getCacheStats();
+}
+
+std::vector<Client::Stats> Client::getStats() const
+{
+    return _impl->getStats();
+}
+
 const std::string& Client::getSession() const
 {
     return _impl->getSession();
@@ -259,8 +1149,13 @@ void Client::update()
     _impl->update();
 }
 
-void Client::addConnection(const std::string& uri)
+uint32_t Client::getUpdateTimeout() const
+{
+    return _impl->getUpdateTimeout();
+}
+
+bool Client::addConnection(const std::string& uri)
 {
-    _impl->addConnection(uri);
+    return _impl->addConnection(uri);
 }
 }
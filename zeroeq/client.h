@@ -7,14 +7,25 @@
 
 #include <zeroeq/receiver.h> // base class
 
+#include <vector>
+
 namespace zeroeq
 {
 /**
  * Requests a remote procedure call on a Server.
  *
  * If the client is in the same session as discovered servers, it
- * automatically connects to those servers. Requests are executed round-robin on
- * all connected servers.
+ * automatically connects to those servers. Each request is executed on the
+ * connected server with the lowest expected latency, estimated from the moving
+ * average of its reply latency and its number of outstanding requests. Servers
+ * without replies yet are probed first.
+ *
+ * For latency-sensitive, idempotent requests, hedging re-sends a request to a
+ * second server when no reply arrived within a percentile of the recent reply
+ * latencies, and passes the first reply to the reply function.
+ *
+ * Replies to requests for immutable resources may be cached in the client,
+ * see enableCache().
  *
  * A connection to a non-existing server is valid. Requests will be executed
  * once the servers are available.
@@ -34,13 +45,37 @@ namespace zeroeq
 class Client : public Receiver
 {
 public:
+    /** Statistics of a server. */
+    struct Stats
+    {
+        std::string uri;       //!< the server URI
+        size_t outstanding{0}; //!< requests without reply
+        uint64_t requests{0};  //!< sent requests, including hedged ones
+        uint64_t replies{0};   //!< received replies
+        uint64_t latency{0};   //!< moving average of reply latency in us
+    };
+
+    /** Statistics of the reply cache. */
+    struct CacheStats
+    {
+        uint64_t hits{0};      //!< requests served from the cache
+        uint64_t misses{0};    //!< cached requests not served from the cache
+        uint64_t coalesced{0}; //!< requests attached to an outstanding one
+        uint64_t evictions{0}; //!< replies evicted for space
+        size_t entries{0};     //!< cached replies
+        size_t size{0};        //!< size of the cached replies in bytes
+    };
+
     /**
      * Create a default client.
      *
      * Postconditions:
      * - connects to all servers set in the comma-separated environment variable
-     *   ZEROEQ_SERVERS
+     *   ZEROEQ_SERVERS, and in the file named by ZEROEQ_SERVERS_FILE, watching
+     *   it for changes. Invalid entries are logged and ignored.
      * - discovers servers on _zeroeq_rep._tcp ZeroConf service
+     * - connects to the instances in the discovery cache, if enabled by
+     *   ZEROEQ_DISCOVERY_CACHE
      * - filters session \<username\> or ZEROEQ_SERVER_SESSION from environment
      *
      * @throw std::runtime_error if ZeroConf is not available
@@ -52,8 +87,11 @@ public:
      *
      * Postconditions:
      * - connects to all servers set in the comma-separated environment variable
-     *   ZEROEQ_SERVERS
+     *   ZEROEQ_SERVERS, and in the file named by ZEROEQ_SERVERS_FILE, watching
+     *   it for changes. Invalid entries are logged and ignored.
      * - discovers publishers on _zeroeq_rep._tcp ZeroConf service
+     * - connects to the instances in the discovery cache, if enabled by
+     *   ZEROEQ_DISCOVERY_CACHE
      * - filters for given session
      *
      * @param session session name used for filtering of discovered publishers
@@ -134,6 +172,166 @@ public:
     ZEROEQ_API bool request(const uint128_t& request, const void* data,
                             size_t size, const ReplyFunc& func);
 
+    /**
+     * Request the execution of a batch of payloads on a connected Server.
+     *
+     * All payloads are sent in one message and executed by one server, which
+     * may handle them at once with a Server::handleBatch() handler. The reply
+     * function of each payload is executed during receive() with its reply.
+     * Batches are not hedged. Requires a server of this version.
+     *
+     * See request() overload above for details.
+     *
+     * @param request the request identifier of all payloads
+     * @param payloads the payloads of the requests, each may be empty
+     * @param funcs the function to execute for the reply of each payload
+     * @return true if the request was sent, false on error
+     * @throw std::runtime_error if the number of functions and payloads
+     *        differ
+     */
+    ZEROEQ_API bool request(const uint128_t& request, const Payloads& payloads,
+                            const std::vector<ReplyFunc>& funcs);
+
+    /**
+     * Request the execution of the given data on the server owning the key.
+     *
+     * The keys are mapped to the connected servers by consistent hashing with
+     * virtual nodes, so that requests with the same key are executed by the
+     * same server, e.g., to use its cache for a dataset. When servers join or
+     * leave, only the keys owned by them move to another server. Blocks up to
+     * one second while the server owning the key is not connected, and then
+     * sends the request to the next reachable server on the ring.
+     *
+     * See request() overload above for details.
+     *
+     * @param key the routing key
+     * @param request the request identifier and payload
+     * @param func the function to execute for the reply
+     * @return true if the request was sent, false on error
+     */
+    ZEROEQ_API bool request(const std::string& key,
+                            const servus::Serializable& request,
+                            const ReplyFunc& func);
+
+    /**
+     * Request the execution of the given data on the server owning the key.
+     *
+     * See request() overload above for details.
+     *
+     * @param key the routing key
+     * @param request the request identifier
+     * @param data the payload data of the request, may be nullptr
+     * @param size the size of the payload data, may be 0
+     * @param func the function to execute for the reply
+     */
+    ZEROEQ_API bool request(const std::string& key, const uint128_t& request,
+                            const void* data, size_t size,
+                            const ReplyFunc& func);
+
+    /**
+     * Request the execution of the given data on all connected servers.
+     *
+     * The request is sent to all servers connected at the time of the call,
+     * and to those which were discovered but are not connected yet as soon
+     * as they are. The broadcast function is executed during receive() once
+     * all servers replied or the timeout passed, with one reply per server.
+     * Servers which did not reply in time are reported without reply, and
+     * their late replies are dropped.
+     *
+     * @param request the request identifier and payload
+     * @param timeout the time in ms to wait for replies, or TIMEOUT_INDEFINITE
+     * @param func the function to execute for the replies
+     * @return true if the request was sent, false on error
+     */
+    ZEROEQ_API bool broadcast(const servus::Serializable& request,
+                              uint32_t timeout, const BroadcastFunc& func);
+
+    /**
+     * Request the execution of the given data on all connected servers.
+     *
+     * See broadcast() overload above for details.
+     *
+     * @param request the request identifier
+     * @param data the payload data of the request, may be nullptr
+     * @param size the size of the payload data, may be 0
+     * @param timeout the time in ms to wait for replies, or TIMEOUT_INDEFINITE
+     * @param func the function to execute for the replies
+     */
+    ZEROEQ_API bool broadcast(const uint128_t& request, const void* data,
+                              size_t size, uint32_t timeout,
+                              const BroadcastFunc& func);
+
+    /**
+     * Re-send requests to a second server if no reply arrived in time.
+     *
+     * A request is hedged once it is outstanding longer than the given
+     * percentile of the latencies of the recent replies from all servers.
+     * The first reply is passed to the reply function, the second one is
+     * dropped. Only enable hedging if all requests are idempotent. Hedged
+     * requests are sent while receiving, their payload is kept until the
+     * first reply. Requests with a routing key are hedged to the next server
+     * on the hash ring.
+     *
+     * @param percentile of reply latencies after which a request is hedged
+     * @throw std::runtime_error if the percentile is not in (0, 1]
+     */
+    ZEROEQ_API void enableHedging(float percentile = 0.95f);
+
+    /** Disable hedging of requests, the default. */
+    ZEROEQ_API void disableHedging();
+
+    /** @return the number of requests re-sent to a second server. */
+    ZEROEQ_API uint64_t getNumHedged() const;
+
+    /**
+     * Cache the replies to the given request in this client.
+     *
+     * The replies have to be a pure function of the request payload, e.g.,
+     * for immutable resources. Successful replies, with a non-zero reply ID,
+     * are cached by request and payload hash until they expire, are
+     * invalidated or are evicted. A request with a cached reply calls the
+     * reply function before request() returns, without contacting a server.
+     * A request identical to an outstanding one is not sent, its reply
+     * function is called with the reply of the outstanding request. Batches
+     * of requests are not cached.
+     *
+     * @param request the request identifier
+     * @param ttl the time to live of the cached replies in milliseconds, or
+     *        TIMEOUT_INDEFINITE
+     */
+    ZEROEQ_API void enableCache(const uint128_t& request,
+                                uint32_t ttl = TIMEOUT_INDEFINITE);
+
+    /**
+     * Stop caching the replies to the given request, removing its replies.
+     *
+     * @return true if the replies to the request were cached
+     */
+    ZEROEQ_API bool disableCache(const uint128_t& request);
+
+    /** Remove all cached replies to the given request. */
+    ZEROEQ_API void invalidate(const uint128_t& request);
+
+    /** Remove the cached reply to the given request and payload. */
+    ZEROEQ_API void invalidate(const uint128_t& request, const void* data,
+                               size_t size);
+
+    /**
+     * Set the maximum size of the cached replies, evicting the least
+     * recently used ones. Each reply accounts for its data and a fixed
+     * bookkeeping overhead. The default is 64 MB.
+     */
+    ZEROEQ_API void setCacheSize(size_t bytes);
+
+    /** @return the maximum size of the cached replies. */
+    ZEROEQ_API size_t getCacheSize() const;
+
+    /** @return the statistics of the reply cache. */
+    ZEROEQ_API CacheStats getCacheStats() const;
+
+    /** @return the statistics of all connected servers. */
+    ZEROEQ_API std::vector<Stats> getStats() const;
+
     /** @return the session name that is used for filtering. */
     ZEROEQ_API const std::string& getSession() const;
 
@@ -145,6 +343,7 @@ private:
     void addSockets(std::vector<detail::Socket>& entries) final;
     bool process(detail::Socket& socket) final;
     void update() final;
-    void addConnection(const std::string& uri) final;
+    uint32_t getUpdateTimeout() const final;
+    bool addConnection(const std::string& uri) final;
 };
 }
@@ -11,8 +11,10 @@
 #include <zeroeq/log.h>
 #include <zeroeq/receiver.h>
 
+#include <algorithm>
 #include <cassert>
-#include <map>
+#include <string>
+#include <vector>
 
 namespace zeroeq
 {
@@ -27,7 +29,7 @@ public:
            const connection::Broker::PortSelection mode)
         : Sender(URI(std::string("tcp://*:") +
                      std::to_string(uint32_t(zeroeq::detail::getPort(name)))),
-                 ZMQ_REP)
+                 ZMQ_ROUTER)
         , _receiver(receiver)
     {
         if (!_listen(mode))
@@ -39,7 +41,7 @@ public:
     }
 
     Broker(Receiver& receiver, const std::string& address)
-        : Sender(URI(std::string("tcp://") + address), ZMQ_REP)
+        : Sender(URI(std::string("tcp://") + address), ZMQ_ROUTER)
         , _receiver(receiver)
     {
         _listen(connection::Broker::PORT_FIXED);
@@ -61,21 +63,93 @@ public:
 
     bool process(zeroeq::detail::Socket& socket_)
     {
-        zmq_msg_t msg;
-        zmq_msg_init(&msg);
-        zmq_msg_recv(&msg, socket_.socket, 0);
-        const std::string address((const char*)zmq_msg_data(&msg),
-                                  zmq_msg_size(&msg));
-
-        _receiver.addConnection(std::string("tcp://") + address);
-        zmq_msg_send(&msg, socket_.socket, 0);
-        zmq_msg_close(&msg);
+        // Handle all queued requests, the router socket interleaves the
+        // requests of concurrent services
+        while (_processRequest(socket_.socket))
+            ;
         return true;
     }
 
 private:
     zeroeq::Receiver& _receiver;
 
+    /** @return false if no request was pending. */
+    bool _processRequest(void* socket_)
+    {
+        zmq_msg_t identity;
+        zmq_msg_init(&identity);
+        if (zmq_msg_recv(&identity, socket_, ZMQ_DONTWAIT) == -1)
+        {
+            zmq_msg_close(&identity);
+            return false;
+        }
+
+        // [identity][envelope...][delimiter][address\n...], the envelope is
+        // returned with the reply
+        std::vector<std::string> frames;
+        int more = zmq_msg_more(&identity);
+        while (more)
+        {
+            zmq_msg_t msg;
+            zmq_msg_init(&msg);
+            if (zmq_msg_recv(&msg, socket_, 0) == -1)
+            {
+                zmq_msg_close(&msg);
+                break;
+            }
+            frames.emplace_back((const char*)zmq_msg_data(&msg),
+                                zmq_msg_size(&msg));
+            more = zmq_msg_more(&msg);
+            zmq_msg_close(&msg);
+        }
+
+        const auto delimiter =
+            std::find(frames.begin(), frames.end(), std::string());
+        if (delimiter == frames.end())
+        {
+            ZEROEQWARN << "Ignoring malformed connection request" << std::endl;
+            zmq_msg_close(&identity);
+            return true;
+        }
+
+        const auto addresses = delimiter + 1;
+        const std::string reply = std::to_string(
+            addresses == frames.end() ? 0 : _addConnections(*addresses));
+
+        bool sent = zmq_msg_send(&identity, socket_, ZMQ_SNDMORE) != -1;
+        for (auto i = frames.begin(); sent && i != addresses; ++i)
+            sent = zmq_send(socket_, i->data(), i->size(), ZMQ_SNDMORE) != -1;
+        if (!sent || zmq_send(socket_, reply.data(), reply.size(), 0) == -1)
+        {
+            ZEROEQWARN << "Cannot send connection reply: "
+                       << zmq_strerror(zmq_errno()) << std::endl;
+        }
+        zmq_msg_close(&identity);
+        return true;
+    }
+
+    /** @return the number of accepted addresses of a batched request. */
+    size_t _addConnections(const std::string& addresses)
+    {
+        size_t accepted = 0;
+        size_t start = 0;
+        while (start < addresses.size())
+        {
+            size_t end = addresses.find('\n', start);
+            if (end == std::string::npos)
+                end = addresses.size();
+
+            const std::string address = addresses.substr(start, end - start);
+            if (!address.empty() &&
+                _receiver.addConnection(std::string("tcp://") + address))
+            {
+                ++accepted;
+            }
+            start = end + 1;
+        }
+        return accepted;
+    }
+
     bool _listen(const connection::Broker::PortSelection mode)
     {
         const std::string address =
@@ -33,6 +33,10 @@ class Broker;
 /**
  * Brokers subscription requests for a zeroeq::Receiver.
  *
+ * Requests of concurrent services are accepted in parallel, and one request
+ * may register multiple publisher addresses. All pending requests are handled
+ * on each receive.
+ *
  * Example: @include tests/connection/broker.cpp
  */
 class Broker : public Receiver
@@ -1,4 +1,3 @@
-
 /* Copyright (c) 2014-2017, Human Brain Project
  *                          Stefan.Eilemann@epfl.ch
  */
@@ -11,63 +10,363 @@
 
 #include <zmq.h>
 
-#include <string.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
 
 namespace zeroeq
 {
 namespace connection
 {
-bool Service::subscribe(const std::string& address, const Publisher& publisher)
+namespace
+{
+using Clock = std::chrono::steady_clock;
+}
+
+/**
+ * Sends the registrations from a background thread.
+ *
+ * Each broker has a cached dealer socket. A request is sent as
+ * [id][delimiter][address\n...], the broker returns the id with the number of
+ * accepted addresses. Callers queue requests and wake up the thread through
+ * an inproc socket.
+ *
+ * Requests expire individually after the timeout. The socket of a broker is
+ * only dropped, and reconnected on the next request, once all its requests
+ * expired without any reply from the broker meanwhile.
+ */
+class Service::Impl
 {
-    zmq::ContextPtr context = detail::getContext();
-    void* socket = zmq_socket(context.get(), ZMQ_REQ);
-    if (!socket)
+public:
+    explicit Impl(const uint32_t timeout)
+        : _context(detail::getContext())
+        , _timeout(timeout)
+    {
+        std::ostringstream wakeupURI;
+        wakeupURI << "inproc://zeroeq.connection.service."
+                  << static_cast<const void*>(this);
+
+        _wakeup = _createSocket(ZMQ_PULL);
+        _notify = _createSocket(ZMQ_PUSH);
+        if (zmq_bind(_wakeup.get(), wakeupURI.str().c_str()) == -1 ||
+            zmq_connect(_notify.get(), wakeupURI.str().c_str()) == -1)
+        {
+            ZEROEQTHROW(std::runtime_error(
+                std::string("Cannot set up connection service: ") +
+                zmq_strerror(zmq_errno())));
+        }
+        _thread = std::thread([this] { _run(); });
+    }
+
+    ~Impl()
     {
-        ZEROEQINFO << "Can't create socket: " << zmq_strerror(zmq_errno())
-                   << std::endl;
-        return false;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _running = false;
+            _signal();
+        }
+        _thread.join();
     }
 
-    const std::string zmqAddress = std::string("tcp://") + address;
-    if (zmq_connect(socket, zmqAddress.c_str()) == -1)
+    std::future<size_t> subscribe(const std::string& address,
+                                  const std::vector<std::string>& addresses)
     {
-        ZEROEQINFO << "Can't reach connection broker at " << address
-                   << std::endl;
-        zmq_close(socket);
-        return false;
+        Request request;
+        request.broker = address;
+        for (const auto& pubAddress : addresses)
+            request.addresses += pubAddress + "\n";
+
+        std::future<size_t> result = request.promise.get_future();
+        if (addresses.empty())
+        {
+            request.promise.set_value(0);
+            return result;
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_running)
+        {
+            request.promise.set_value(0);
+            return result;
+        }
+        _requests.push_back(std::move(request));
+        _signal();
+        return result;
     }
 
-    const std::string& pubAddress = publisher.getAddress();
-    zmq_msg_t request;
-    zmq_msg_init_size(&request, pubAddress.size());
-    memcpy(zmq_msg_data(&request), pubAddress.c_str(), pubAddress.size());
+private:
+    struct Request
+    {
+        std::string broker;
+        std::string addresses;
+        std::promise<size_t> promise;
+    };
+
+    struct Pending
+    {
+        std::promise<size_t> promise;
+        Clock::time_point deadline;
+    };
+
+    struct Broker
+    {
+        zmq::SocketPtr socket;
+        std::map<uint64_t, Pending> pending; // by id, oldest first
+        Clock::time_point lastReply;
+    };
+
+    zmq::ContextPtr _context;
+    const uint32_t _timeout;
+    zmq::SocketPtr _wakeup; // used by _thread
+    zmq::SocketPtr _notify; // protected by _mutex
+
+    std::mutex _mutex;
+    std::deque<Request> _requests;
+    bool _running{true};
+
+    std::map<std::string, Broker> _brokers; // used by _thread
+    uint64_t _id{0};
+    std::thread _thread;
 
-    if (zmq_msg_send(&request, socket, 0) == -1)
+    zmq::SocketPtr _createSocket(const int type)
     {
-        zmq_msg_close(&request);
-        ZEROEQINFO << "Can't send connection request " << pubAddress << " to "
-                   << address << ": " << zmq_strerror(zmq_errno()) << std::endl;
-        return false;
+        zmq::SocketPtr socket(zmq_socket(_context.get(), type),
+                              [](void* s) { ::zmq_close(s); });
+        const int linger = 0;
+        zmq_setsockopt(socket.get(), ZMQ_LINGER, &linger, sizeof(linger));
+        return socket;
     }
-    zmq_msg_close(&request);
 
-    zmq_msg_t reply;
-    zmq_msg_init(&reply);
-    if (zmq_msg_recv(&reply, socket, 0) == -1)
+    void _signal() { zmq_send(_notify.get(), "", 0, ZMQ_DONTWAIT); }
+
+    void _run()
     {
-        zmq_msg_close(&reply);
-        ZEROEQINFO << "Can't receive connection reply from " << address
-                   << std::endl;
-        return false;
+        std::vector<zmq_pollitem_t> items;
+        std::vector<Broker*> brokers; // of items[1..]
+        while (true)
+        {
+            if (!_sendRequests())
+                break;
+
+            items.assign(1, {_wakeup.get(), 0, ZMQ_POLLIN, 0});
+            brokers.clear();
+            long timeout = -1;
+            const auto now = Clock::now();
+            for (auto& i : _brokers)
+            {
+                Broker& broker = i.second;
+                if (broker.pending.empty())
+                    continue;
+
+                items.push_back({broker.socket.get(), 0, ZMQ_POLLIN, 0});
+                brokers.push_back(&broker);
+
+                const auto& deadline = broker.pending.begin()->second.deadline;
+                const long remaining =
+                    deadline <= now
+                        ? 0
+                        : long(std::chrono::duration_cast<
+                                   std::chrono::milliseconds>(deadline - now)
+                                   .count()) +
+                              1;
+                if (timeout < 0 || remaining < timeout)
+                    timeout = remaining;
+            }
+
+            if (zmq_poll(items.data(), int(items.size()), timeout) == -1)
+            {
+                ZEROEQWARN << "Connection service poll failed: "
+                           << zmq_strerror(zmq_errno()) << std::endl;
+                break;
+            }
+
+            if (items[0].revents & ZMQ_POLLIN)
+                while (zmq_recv(_wakeup.get(), nullptr, 0, ZMQ_DONTWAIT) != -1)
+                    /* nop */;
+
+            for (size_t i = 1; i < items.size(); ++i)
+                if (items[i].revents & ZMQ_POLLIN)
+                    _receiveReplies(*brokers[i - 1]);
+            _expire();
+        }
+
+        for (auto& i : _brokers)
+            for (auto& pending : i.second.pending)
+                pending.second.promise.set_value(0);
+        _brokers.clear();
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& request : _requests)
+            request.promise.set_value(0);
+        _requests.clear();
     }
 
-    const std::string result((const char*)zmq_msg_data(&reply),
-                             zmq_msg_size(&reply));
-    zmq_msg_close(&reply);
+    /** @return false if the service is shutting down. */
+    bool _sendRequests()
+    {
+        std::deque<Request> requests;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_running)
+                return false;
+            requests.swap(_requests);
+        }
+
+        for (auto& request : requests)
+        {
+            Broker* broker = _getBroker(request.broker);
+            if (!broker)
+            {
+                request.promise.set_value(0);
+                continue;
+            }
 
-    zmq_close(socket);
+            const uint64_t id = ++_id;
+            if (zmq_send(broker->socket.get(), &id, sizeof(id), ZMQ_SNDMORE) ==
+                    -1 ||
+                zmq_send(broker->socket.get(), "", 0, ZMQ_SNDMORE) == -1 ||
+                zmq_send(broker->socket.get(), request.addresses.data(),
+                         request.addresses.size(), 0) == -1)
+            {
+                ZEROEQINFO << "Can't send connection request to "
+                           << request.broker << ": "
+                           << zmq_strerror(zmq_errno()) << std::endl;
+                request.promise.set_value(0);
+                continue;
+            }
 
-    return pubAddress == std::string(result);
+            Pending& pending = broker->pending[id];
+            pending.promise = std::move(request.promise);
+            pending.deadline =
+                Clock::now() + std::chrono::milliseconds(_timeout);
+        }
+        return true;
+    }
+
+    Broker* _getBroker(const std::string& address)
+    {
+        auto i = _brokers.find(address);
+        if (i != _brokers.end())
+            return &i->second;
+
+        zmq::SocketPtr socket = _createSocket(ZMQ_DEALER);
+        const std::string zmqAddress = std::string("tcp://") + address;
+        if (zmq_connect(socket.get(), zmqAddress.c_str()) == -1)
+        {
+            ZEROEQINFO << "Can't reach connection broker at " << address
+                       << std::endl;
+            return nullptr;
+        }
+
+        Broker& broker = _brokers[address];
+        broker.socket = socket;
+        return &broker;
+    }
+
+    void _receiveReplies(Broker& broker)
+    {
+        // [id][delimiter][accepted]
+        std::vector<std::string> frames;
+        while (true)
+        {
+            zmq_msg_t msg;
+            zmq_msg_init(&msg);
+            if (zmq_msg_recv(&msg, broker.socket.get(), ZMQ_DONTWAIT) == -1)
+            {
+                zmq_msg_close(&msg);
+                return;
+            }
+            frames.emplace_back((const char*)zmq_msg_data(&msg),
+                                zmq_msg_size(&msg));
+            const bool more = zmq_msg_more(&msg);
+            zmq_msg_close(&msg);
+            if (more)
+                continue;
+
+            uint64_t id = 0;
+            if (frames.size() == 3 && frames[0].size() == sizeof(id))
+            {
+                broker.lastReply = Clock::now();
+                ::memcpy(&id, frames[0].data(), sizeof(id));
+                auto i = broker.pending.find(id);
+                if (i != broker.pending.end()) // else timed out before
+                {
+                    i->second.promise.set_value(
+                        std::strtoul(frames[2].c_str(), nullptr, 10));
+                    broker.pending.erase(i);
+                }
+            }
+            frames.clear();
+        }
+    }
+
+    void _expire()
+    {
+        const auto now = Clock::now();
+        const auto timeout = std::chrono::milliseconds(_timeout);
+        for (auto i = _brokers.begin(); i != _brokers.end();)
+        {
+            Broker& broker = i->second;
+            auto& pending = broker.pending;
+            bool silent = false; // no reply since an expired request was sent
+            while (!pending.empty() && pending.begin()->second.deadline <= now)
+            {
+                const Pending& request = pending.begin()->second;
+                ZEROEQINFO << "Connection request to " << i->first
+                           << " timed out" << std::endl;
+                if (broker.lastReply < request.deadline - timeout)
+                    silent = true;
+                pending.begin()->second.promise.set_value(0);
+                pending.erase(pending.begin());
+            }
+
+            // Broker is not answering, reconnect on the next request
+            if (silent && pending.empty())
+                i = _brokers.erase(i);
+            else
+                ++i;
+        }
+    }
+};
+
+Service::Service(const uint32_t timeout)
+    : _impl(new Impl(timeout))
+{
+}
+
+Service::~Service()
+{
+}
+
+std::future<size_t> Service::subscribeAsync(
+    const std::string& address, const std::vector<std::string>& addresses)
+{
+    return _impl->subscribe(address, addresses);
+}
+
+std::future<size_t> Service::subscribeAsync(const std::string& address,
+                                            const Publisher& publisher)
+{
+    const std::vector<std::string> addresses{publisher.getAddress()};
+    return subscribeAsync(address, addresses);
+}
+
+bool Service::subscribe(const std::string& address, const Publisher& publisher)
+{
+    const std::vector<std::string> addresses{publisher.getAddress()};
+    return subscribe(address, addresses) == 1;
+}
+
+size_t Service::subscribe(const std::string& address,
+                          const std::vector<std::string>& addresses)
+{
+    Service service;
+    return service.subscribeAsync(address, addresses).get();
 }
 
 bool Service::subscribe(const std::string& hostname, const std::string& name,
@@ -6,7 +6,10 @@
 #ifndef ZEROEQ_CONNECTION_SERVICE_H
 #define ZEROEQ_CONNECTION_SERVICE_H
 
+#include <future>
+#include <memory>
 #include <string>
+#include <vector>
 #include <zeroeq/api.h>
 #include <zeroeq/types.h>
 
@@ -17,11 +20,55 @@ namespace connection
 /**
  * Subscribes a Publisher to a remote receiver using a connection::Broker.
  *
+ * The static methods block until the broker replied, or until they time out
+ * after DEFAULT_TIMEOUT. A Service instance registers asynchronously: the
+ * requests to all brokers are in flight in parallel, and the connection to
+ * each broker is reused for later requests.
+ *
  * Example: @include tests/connection/broker.cpp
  */
 class Service
 {
 public:
+    /** The default timeout of a registration in milliseconds. */
+    static const uint32_t DEFAULT_TIMEOUT = 5000;
+
+    /**
+     * Create a new service for asynchronous registrations.
+     *
+     * @param timeout the time in milliseconds after which an unanswered
+     *                registration fails.
+     */
+    ZEROEQ_API explicit Service(uint32_t timeout = DEFAULT_TIMEOUT);
+
+    /** Destroy this service, pending registrations fail. */
+    ZEROEQ_API ~Service();
+
+    /**
+     * Request subscription of the given publishers to a remote broker without
+     * blocking.
+     *
+     * @param address the broker address (hostname:port), without the protocol.
+     * @param addresses the publisher addresses (hostname:port), without the
+     *                  protocol.
+     * @return the future number of addresses accepted by the broker, 0 on
+     *         error or timeout.
+     */
+    ZEROEQ_API std::future<size_t> subscribeAsync(
+        const std::string& address, const std::vector<std::string>& addresses);
+
+    /**
+     * Request subscription of the given publisher to a remote broker without
+     * blocking.
+     *
+     * @param address the broker address (hostname:port), without the protocol.
+     * @param publisher the publisher to subscribe to.
+     * @return the future number of addresses accepted by the broker, 1 on
+     *         success.
+     */
+    ZEROEQ_API std::future<size_t> subscribeAsync(const std::string& address,
+                                                  const Publisher& publisher);
+
     /**
      * Request subscription of the given publisher to a remote broker.
      *
@@ -30,11 +77,27 @@ public:
      *
      * @param address the broker address (hostname:port), without the protocol.
      * @param publisher the publisher to subscribe to.
-     * @return true if the subscription was successful, false on error.
+     * @return true if the subscription was successful, false on error or
+     *         timeout.
      */
     ZEROEQ_API static bool subscribe(const std::string& address,
                                      const Publisher& publisher);
 
+    /**
+     * Request subscription of the given publishers to a remote broker.
+     *
+     * All addresses are sent in one request, e.g., to register all publishers
+     * of a process at once.
+     *
+     * @param address the broker address (hostname:port), without the protocol.
+     * @param addresses the publisher addresses (hostname:port), without the
+     *                  protocol.
+     * @return the number of addresses accepted by the broker, 0 on error or
+     *         timeout.
+     */
+    ZEROEQ_API static size_t subscribe(
+        const std::string& address, const std::vector<std::string>& addresses);
+
     /**
      * Request subscription of the given publisher to a named remote broker.
      *
@@ -45,13 +108,17 @@ public:
      * @param hostname the broker address, without the protocol and port.
      * @param name the application namespace.
      * @param publisher the publisher to subscribe to.
-     * @return true if the subscription was successful, false on error.
+     * @return true if the subscription was successful, false on error or
+     *         timeout.
      */
     ZEROEQ_API static bool subscribe(const std::string& hostname,
                                      const std::string& name,
                                      const Publisher& publisher);
 
 private:
+    class Impl;
+    std::unique_ptr<Impl> _impl;
+
     Service(const Service&) = delete;
     Service& operator=(const Service&) = delete;
 };
@@ -0,0 +1,197 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include "browser.h"
+
+
+#include "../log.h"
+
+#include <zeroeq/types.h>
+
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace zeroeq
+{
+namespace detail
+{
+namespace
+{
+const auto cacheTimeout = std::chrono::seconds(5);
+
+std::string getCacheFile(const std::string& service)
+{
+    const char* directory = ::getenv(ENV_DISCOVERY_CACHE.c_str());
+    if (!directory || std::string(directory).empty())
+        return std::string();
+
+#ifdef _WIN32
+    if (::_mkdir(directory) != 0 && errno != EEXIST)
+#else
+    if (::mkdir(directory, 0755) != 0 && errno != EEXIST)
+#endif
+    {
+        ZEROEQWARN << "Cannot create discovery cache directory " << directory
+                   << std::endl;
+        return std::string();
+    }
+
+    std::string name = service;
+    for (char& c : name)
+        if (!::isalnum(static_cast<unsigned char>(c)))
+            c = '_';
+    return std::string(directory) + "/" + name + ".cache";
+}
+
+bool isValid(const std::string& string, const char* separators = "\t\n=")
+{
+    return string.find_first_of(separators) == std::string::npos;
+}
+
+// One instance per line: name, followed by tab-separated key=value properties
+void readCache(const std::string& filename,
+               std::map<std::string, Browser::Instance>& cache)
+{
+    std::ifstream file(filename);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        size_t pos = line.find('\t');
+        Browser::Instance instance{line.substr(0, pos), {}, true};
+        while (pos != std::string::npos)
+        {
+            const size_t begin = pos + 1;
+            pos = line.find('\t', begin);
+            const std::string property = line.substr(begin, pos - begin);
+            const size_t separator = property.find('=');
+            if (separator != std::string::npos)
+                instance.properties[property.substr(0, separator)] =
+                    property.substr(separator + 1);
+        }
+        if (!instance.name.empty())
+            cache[instance.name] = instance;
+    }
+}
+}
+
+std::shared_ptr<Browser> Browser::get(const std::string& service)
+{
+    if (!servus::Servus::isAvailable())
+        return {};
+    return getShared<Browser>(service);
+}
+
+Browser::Browser(const std::string& service)
+    : _servus(service)
+    , _cacheFile(getCacheFile(service))
+    , _cacheDeadline(std::chrono::steady_clock::now() + cacheTimeout)
+{
+    if (!_cacheFile.empty())
+        readCache(_cacheFile, _cached);
+
+    _servus.addListener(this);
+    _servus.beginBrowsing(servus::Servus::IF_ALL);
+}
+
+Browser::~Browser()
+{
+    if (_servus.isBrowsing())
+        _servus.endBrowsing();
+    _servus.removeListener(this);
+}
+
+void Browser::_update()
+{
+    if (_servus.isBrowsing())
+        _servus.browse(0);
+    if (!_cached.empty() && std::chrono::steady_clock::now() > _cacheDeadline)
+        _expireCache();
+}
+
+void Browser::_getInstances(Instances& instances) const
+{
+    for (const InstanceMap* map : {&_instances, &_cached})
+        for (const auto& i : *map)
+            instances.push_back(i.second);
+}
+
+void Browser::instanceAdded(const std::string& name)
+{
+    Instance instance{name, {}, true};
+    for (const auto& key : _servus.getKeys(name))
+        instance.properties[key] = _servus.get(name, key);
+
+    _instances[name] = instance;
+    _cached.erase(name); // confirmed
+    _push(instance);
+    _saveCache();
+}
+
+void Browser::instanceRemoved(const std::string& name)
+{
+    _instances.erase(name);
+    _push(Instance{name, {}, false});
+    _saveCache();
+}
+
+void Browser::_expireCache()
+{
+    for (const auto& i : _cached)
+        _push(Instance{i.first, {}, false});
+    _cached.clear();
+    _saveCache();
+}
+
+void Browser::_saveCache() const
+{
+    if (_cacheFile.empty())
+        return;
+
+    const std::string tmpFile = _cacheFile + ".tmp";
+    {
+        std::ofstream file(tmpFile);
+        for (const InstanceMap* instances : {&_instances, &_cached})
+        {
+            for (const auto& i : *instances)
+            {
+                if (!isValid(i.first))
+                    continue;
+                file << i.first;
+                for (const auto& property : i.second.properties)
+                {
+                    if (isValid(property.first) &&
+                        isValid(property.second, "\t\n"))
+                    {
+                        file << '\t' << property.first << '='
+                             << property.second;
+                    }
+                }
+                file << '\n';
+            }
+        }
+        if (!file)
+        {
+            ZEROEQINFO << "Cannot write discovery cache " << tmpFile
+                       << std::endl;
+            return;
+        }
+    }
+
+#ifdef _WIN32
+    std::remove(_cacheFile.c_str()); // rename does not replace on Windows
+#endif
+    if (std::rename(tmpFile.c_str(), _cacheFile.c_str()) != 0)
+        std::remove(tmpFile.c_str());
+}
+}
+}
@@ -0,0 +1,58 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include "discovery.h"
+
+#include <servus/listener.h>
+#include <servus/servus.h> // member
+
+#include <chrono>
+
+namespace zeroeq
+{
+namespace detail
+{
+/**
+ * Zeroconf discovery of one service type.
+ *
+ * If the ZEROEQ_DISCOVERY_CACHE environment variable names a directory, the
+ * resolved instances of the service are stored in a cache file in this
+ * directory. Cached instances are reported to new receivers right away, and
+ * are removed again unless live discovery confirms them within a few seconds.
+ */
+class Browser : public Discovery, public servus::Listener
+{
+public:
+    /**
+     * @return the browser of the given service, shared as long as it is
+     *         referenced, or nullptr if Servus cannot browse.
+     */
+    static std::shared_ptr<Browser> get(const std::string& service);
+
+    ~Browser();
+
+private:
+    friend class Discovery; // getShared()
+    using InstanceMap = std::map<std::string, Instance>;
+
+    explicit Browser(const std::string& service);
+
+    servus::Servus _servus;
+    InstanceMap _instances; // resolved by live discovery
+
+    std::string _cacheFile;
+    InstanceMap _cached; // from cache file, not yet confirmed
+    std::chrono::steady_clock::time_point _cacheDeadline;
+
+    void _update() final;
+    void _getInstances(Instances& instances) const final;
+    void instanceAdded(const std::string& instance) final;
+    void instanceRemoved(const std::string& instance) final;
+    void _expireCache();
+    void _saveCache() const;
+};
+}
+}
@@ -99,6 +99,19 @@ inline std::string getApplicationName()
     return execPath.substr(lastSeparator + 1);
 }
 
+inline std::string getHostName()
+{
+    char hostname[256] = {0};
+    gethostname(hostname, sizeof(hostname) - 1);
+    return hostname;
+}
+
+inline std::string getRackName()
+{
+    const char* rack = getenv(zeroeq::ENV_RACK.c_str());
+    return rack ? rack : std::string();
+}
+
 inline std::string getDefaultPubSession()
 {
     const char* pubSession = getenv(zeroeq::ENV_PUB_SESSION.c_str());
@@ -0,0 +1,141 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include "socket.h"
+
+#include <zeroeq/types.h>
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace zeroeq
+{
+namespace detail
+{
+/**
+ * Indexed table of the connections of a Receiver.
+ *
+ * Connections are added, found by key or URI and removed in constant time. Each
+ * socket has one entry in a dense poll array, reference counted by the
+ * connections using it. The entry of the last socket takes the place of a
+ * removed entry.
+ */
+class Connections
+{
+public:
+    struct Connection
+    {
+        std::string zmqURI;
+        zmq::SocketPtr socket;
+    };
+
+    /** @return false if a connection with the given key already exists. */
+    bool add(const std::string& key, const std::string& zmqURI,
+             zmq::SocketPtr socket)
+    {
+        const auto result =
+            _connections.emplace(key, Connection{zmqURI, socket});
+        if (!result.second)
+            return false;
+        _keys.emplace(zmqURI, key);
+
+        const auto position = _positions.find(socket.get());
+        if (position != _positions.end())
+        {
+            ++_references[position->second];
+            return true;
+        }
+
+        detail::Socket entry;
+        entry.socket = socket.get();
+        entry.fd = 0;
+        entry.events = ZMQ_POLLIN;
+        entry.revents = 0;
+        _positions[socket.get()] = _entries.size();
+        _entries.push_back(entry);
+        _references.push_back(1);
+        return true;
+    }
+
+    /** @return the connection with the given key, or nullptr. */
+    const Connection* find(const std::string& key) const
+    {
+        const auto i = _connections.find(key);
+        return i == _connections.end() ? nullptr : &i->second;
+    }
+
+    /** @return the key of the connection to the given URI, or nullptr. */
+    const std::string* findURI(const std::string& zmqURI) const
+    {
+        const auto i = _keys.find(zmqURI);
+        return i == _keys.end() ? nullptr : &i->second;
+    }
+
+    /** @return the URIs of all connections, sorted. */
+    std::vector<std::string> getURIs() const
+    {
+        std::vector<std::string> uris;
+        uris.reserve(_connections.size());
+        for (const auto& i : _connections)
+            uris.push_back(i.second.zmqURI);
+        std::sort(uris.begin(), uris.end());
+        return uris;
+    }
+
+    /** @return false if no connection with the given key exists. */
+    bool remove(const std::string& key)
+    {
+        const auto i = _connections.find(key);
+        if (i == _connections.end())
+            return false;
+
+        const auto keys = _keys.equal_range(i->second.zmqURI);
+        for (auto j = keys.first; j != keys.second; ++j)
+        {
+            if (j->second == key)
+            {
+                _keys.erase(j);
+                break;
+            }
+        }
+
+        const auto position = _positions.find(i->second.socket.get());
+        _connections.erase(i);
+
+        const size_t index = position->second;
+        if (--_references[index] > 0) // socket still used by others
+            return true;
+
+        const size_t last = _entries.size() - 1;
+        if (index != last)
+        {
+            _entries[index] = _entries[last];
+            _references[index] = _references[last];
+            _positions[_entries[index].socket] = index;
+        }
+        _entries.pop_back();
+        _references.pop_back();
+        _positions.erase(position);
+        return true;
+    }
+
+    /** @return the poll entries, one per socket. */
+    const std::vector<detail::Socket>& getEntries() const { return _entries; }
+
+    /** @return the number of connections. */
+    size_t size() const { return _connections.size(); }
+
+private:
+    std::unordered_map<std::string, Connection> _connections;
+    std::unordered_multimap<std::string, std::string> _keys; // by URI
+    std::unordered_map<const void*, size_t> _positions; // socket -> entry
+    std::vector<detail::Socket> _entries;
+    std::vector<size_t> _references; // connections per entry
+};
+}
+}
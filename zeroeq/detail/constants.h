@@ -19,6 +19,9 @@ const std::string KEY_INSTANCE("Instance");
 const std::string KEY_SESSION("Session");
 const std::string KEY_USER("User");
 const std::string KEY_APPLICATION("Application");
+const std::string KEY_PRIORITY_PORT("PriorityPort");
+const std::string KEY_RELAY("Relay"); // host name of a Proxy
+const std::string KEY_RACK("Rack");
 
 const std::string ENV_SESSION("ZEROEQ_SESSION");
 const std::string UNKNOWN_USER("Unknown user");
@@ -26,6 +29,22 @@ const std::string UNKNOWN_USER("Unknown user");
 const std::string DEFAULT_SCHEMA("tcp");
 
 const servus::uint128_t MEERKAT(servus::make_uint128("zeroeq::Meerkat"));
+const servus::uint128_t FANOUT_JOIN(
+    servus::make_uint128("zeroeq::FanOut::join"));
+const servus::uint128_t FANOUT_REDIRECT(
+    servus::make_uint128("zeroeq::FanOut::redirect"));
+const servus::uint128_t FANOUT_ANNOUNCE(
+    servus::make_uint128("zeroeq::FanOut::announce"));
+const servus::uint128_t HISTORY_REQUEST(
+    servus::make_uint128("zeroeq::History"));
+
+const std::string DIRECTORY_STORE("zeroeq::Directory");
+const servus::uint128_t DIRECTORY_REGISTER(
+    servus::make_uint128("zeroeq::Directory::register"));
+const servus::uint128_t DIRECTORY_UNREGISTER(
+    servus::make_uint128("zeroeq::Directory::unregister"));
+const servus::uint128_t DIRECTORY_INFO(
+    servus::make_uint128("zeroeq::Directory::info"));
 }
 
 #endif
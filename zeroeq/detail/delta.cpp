@@ -0,0 +1,206 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include "delta.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ZEROEQ_USE_SSE2
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace zeroeq
+{
+namespace detail
+{
+namespace
+{
+// Unchanged runs shorter than this are merged into the surrounding literal
+const size_t minRun = 8;
+
+#ifdef ZEROEQ_USE_SSE2
+inline size_t countTrailingZeros(const unsigned value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return index;
+#else
+    return __builtin_ctz(value);
+#endif
+}
+#endif
+
+/** @return the first position in [pos, end) where a and b differ, or end. */
+size_t findChange(const uint8_t* a, const uint8_t* b, size_t pos,
+                  const size_t end)
+{
+#ifdef ZEROEQ_USE_SSE2
+    while (pos + 16 <= end)
+    {
+        const __m128i x = _mm_loadu_si128((const __m128i*)(a + pos));
+        const __m128i y = _mm_loadu_si128((const __m128i*)(b + pos));
+        const unsigned equal = _mm_movemask_epi8(_mm_cmpeq_epi8(x, y));
+        if (equal != 0xffffu)
+            return pos + countTrailingZeros(~equal & 0xffffu);
+        pos += 16;
+    }
+#endif
+    while (pos + sizeof(uint64_t) <= end)
+    {
+        uint64_t x, y;
+        ::memcpy(&x, a + pos, sizeof(x));
+        ::memcpy(&y, b + pos, sizeof(y));
+        if (x != y)
+            break;
+        pos += sizeof(uint64_t);
+    }
+    while (pos < end && a[pos] == b[pos])
+        ++pos;
+    return pos;
+}
+
+/** @return the end of the changed run starting at pos. */
+size_t findRunEnd(const uint8_t* a, const uint8_t* b, size_t pos,
+                  const size_t end)
+{
+    while (pos < end)
+    {
+        if (a[pos] != b[pos])
+        {
+            ++pos;
+            continue;
+        }
+
+        const size_t next = findChange(a, b, pos, end);
+        if (next - pos >= minRun || next == end)
+            return pos;
+        pos = next;
+    }
+    return end;
+}
+
+void writeVarint(uint64_t value, std::vector<uint8_t>& out)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(uint8_t(value));
+}
+
+bool readVarint(const uint8_t*& in, const uint8_t* end, uint64_t& value)
+{
+    value = 0;
+    for (unsigned shift = 0; in < end && shift < 64; shift += 7)
+    {
+        const uint8_t byte = *in++;
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+void writeLiteral(const uint8_t* a, const uint8_t* b, const size_t size,
+                  std::vector<uint8_t>& out)
+{
+    const size_t start = out.size();
+    out.resize(start + size);
+    uint8_t* to = out.data() + start;
+    for (size_t i = 0; i < size; ++i) // auto-vectorized
+        to[i] = a[i] ^ b[i];
+}
+}
+
+void encodeDelta(const void* base, const size_t baseSize, const void* target,
+                 const size_t targetSize, std::vector<uint8_t>& delta)
+{
+    const uint8_t* a = static_cast<const uint8_t*>(base);
+    const uint8_t* b = static_cast<const uint8_t*>(target);
+    const size_t common = std::min(baseSize, targetSize);
+
+    delta.clear();
+    size_t pos = 0;
+    while (pos < common)
+    {
+        const size_t start = findChange(a, b, pos, common);
+        if (start == common)
+            break;
+
+        const size_t end = findRunEnd(a, b, start, common);
+        writeVarint(start - pos, delta);
+        writeVarint(end - start, delta);
+        writeLiteral(a + start, b + start, end - start, delta);
+        pos = end;
+    }
+
+    if (targetSize > common) // base is zero-padded, XOR is the target
+    {
+        pos = std::min(pos, common);
+        writeVarint(common - pos, delta);
+        writeVarint(targetSize - common, delta);
+        delta.insert(delta.end(), b + common, b + targetSize);
+    }
+}
+
+bool decodeDelta(const void* base, const size_t baseSize, const void* delta,
+                 const size_t deltaSize, const size_t targetSize,
+                 std::vector<uint8_t>& target)
+{
+    const uint8_t* a = static_cast<const uint8_t*>(base);
+    const uint8_t* in = static_cast<const uint8_t*>(delta);
+    const uint8_t* const inEnd = in + deltaSize;
+
+    target.resize(targetSize);
+    uint8_t* to = target.data();
+
+    // copy unchanged bytes from the zero-padded base
+    const auto copyBase = [&](const size_t pos, const size_t size) {
+        if (size == 0)
+            return;
+        const size_t fromBase =
+            pos < baseSize ? std::min(size, baseSize - pos) : 0;
+        ::memcpy(to + pos, a + pos, fromBase);
+        ::memset(to + pos + fromBase, 0, size - fromBase);
+    };
+
+    size_t pos = 0;
+    while (in < inEnd)
+    {
+        uint64_t unchanged, changed;
+        if (!readVarint(in, inEnd, unchanged) ||
+            !readVarint(in, inEnd, changed) ||
+            unchanged > targetSize - pos ||
+            changed > targetSize - pos - unchanged ||
+            changed > uint64_t(inEnd - in))
+        {
+            return false;
+        }
+
+        copyBase(pos, unchanged);
+        pos += unchanged;
+
+        const size_t xored =
+            pos < baseSize ? std::min(size_t(changed), baseSize - pos) : 0;
+        for (size_t i = 0; i < xored; ++i) // auto-vectorized
+            to[pos + i] = a[pos + i] ^ in[i];
+        if (changed > xored)
+            ::memcpy(to + pos + xored, in + xored, changed - xored);
+        pos += changed;
+        in += changed;
+    }
+
+    copyBase(pos, targetSize - pos);
+    return true;
+}
+}
+}
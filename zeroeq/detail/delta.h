@@ -0,0 +1,37 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include <zeroeq/types.h>
+
+#include <vector>
+
+namespace zeroeq
+{
+namespace detail
+{
+/**
+ * Encode the difference of target to base.
+ *
+ * The delta is the XOR of both buffers, run-length encoded as a sequence of
+ * (unchanged bytes, changed bytes) varint pairs, each followed by the XOR of
+ * the changed bytes. A base shorter than the target is treated as zero-padded.
+ *
+ * @param delta the output buffer, cleared before encoding
+ */
+void encodeDelta(const void* base, size_t baseSize, const void* target,
+                 size_t targetSize, std::vector<uint8_t>& delta);
+
+/**
+ * Reconstruct a buffer from its base and a delta from encodeDelta().
+ *
+ * @param target the output buffer, resized to targetSize
+ * @return false if the delta is malformed
+ */
+bool decodeDelta(const void* base, size_t baseSize, const void* delta,
+                 size_t deltaSize, size_t targetSize,
+                 std::vector<uint8_t>& target);
+}
+}
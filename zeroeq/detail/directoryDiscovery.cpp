@@ -0,0 +1,112 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include "directoryDiscovery.h"
+
+#include "constants.h"
+#include "registration.h"
+
+#include "../client.h"
+#include "../log.h"
+#include "../stateStore.h"
+#include "../subscriber.h"
+#include "../uri.h"
+
+#include <cstdlib>
+
+namespace zeroeq
+{
+namespace detail
+{
+std::shared_ptr<DirectoryDiscovery> DirectoryDiscovery::get(
+    const std::string& service)
+{
+    const char* uri = ::getenv(ENV_DIRECTORY.c_str());
+    if (!uri || std::string(uri).empty())
+        return {};
+
+    try
+    {
+        return getShared<DirectoryDiscovery>(service + '\n' + uri);
+    }
+    catch (const std::exception& e)
+    {
+        ZEROEQWARN << "Cannot use directory " << uri << ": " << e.what()
+                   << std::endl;
+        return {};
+    }
+}
+
+DirectoryDiscovery::DirectoryDiscovery(const std::string& key)
+    : _service(key.substr(0, key.find('\n')))
+    , _client(new Client({URI(key.substr(key.find('\n') + 1))}))
+{
+    _client->request(DIRECTORY_INFO, nullptr, 0,
+                     [this](const uint128_t&, const void* data,
+                            const size_t size) {
+                         _publisherURI.assign(static_cast<const char*>(data),
+                                              size);
+                     });
+}
+
+DirectoryDiscovery::~DirectoryDiscovery()
+{
+}
+
+void DirectoryDiscovery::_update()
+{
+    while (_client->receive(0))
+        /* nop */;
+    if (!_subscriber)
+    {
+        if (_publisherURI.empty())
+            return;
+        _connect();
+    }
+
+    while (_subscriber->receive(0))
+        /* nop */;
+    if (!_store->isSynchronized() || _store->getSequence() == _sequence)
+        return;
+    _sequence = _store->getSequence();
+
+    InstanceMap instances;
+    const std::string prefix = _service + '\t';
+    for (const auto& entry : *_store->getSnapshot())
+    {
+        if (entry.first.compare(0, prefix.size(), prefix) != 0)
+            continue;
+
+        const std::string name = entry.first.substr(prefix.size());
+        instances[name] = Instance{name, deserialize(*entry.second), true};
+    }
+
+    for (const auto& i : _instances)
+        if (instances.count(i.first) == 0)
+            _push(Instance{i.first, {}, false});
+    for (const auto& i : instances)
+    {
+        const auto known = _instances.find(i.first);
+        if (known == _instances.end() ||
+            known->second.properties != i.second.properties)
+        {
+            _push(i.second);
+        }
+    }
+    _instances.swap(instances);
+}
+
+void DirectoryDiscovery::_getInstances(Instances& instances) const
+{
+    for (const auto& i : _instances)
+        instances.push_back(i.second);
+}
+
+void DirectoryDiscovery::_connect()
+{
+    _subscriber.reset(new Subscriber({URI(_publisherURI)}));
+    _store.reset(new StateStore(DIRECTORY_STORE, *_subscriber, *_client));
+}
+}
+}
@@ -0,0 +1,54 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include "discovery.h"
+
+#include <zeroeq/types.h>
+
+namespace zeroeq
+{
+class StateStore;
+
+namespace detail
+{
+/**
+ * Discovery of the instances of one service registered with the Directory in
+ * ZEROEQ_DIRECTORY.
+ *
+ * The address of the directory's change stream is requested first, followed
+ * by a StateStore replica of the directory.
+ */
+class DirectoryDiscovery : public Discovery
+{
+public:
+    /**
+     * @return the directory discovery of the given service, shared as long as
+     *         it is referenced, or nullptr if no directory is configured.
+     */
+    static std::shared_ptr<DirectoryDiscovery> get(const std::string& service);
+
+    ~DirectoryDiscovery();
+
+private:
+    friend class Discovery; // getShared()
+    using InstanceMap = std::map<std::string, Instance>;
+
+    explicit DirectoryDiscovery(const std::string& key);
+
+    const std::string _service;
+    std::unique_ptr<Client> _client;
+    std::unique_ptr<Subscriber> _subscriber;
+    std::unique_ptr<StateStore> _store; // destroyed first
+    std::string _publisherURI; // from info reply
+    uint64_t _sequence{0};     // of the store when _instances was updated
+    InstanceMap _instances;
+
+    void _update() final;
+    void _getInstances(Instances& instances) const final;
+    void _connect();
+};
+}
+}
@@ -0,0 +1,38 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include "discovery.h"
+
+namespace zeroeq
+{
+namespace detail
+{
+void Discovery::add(const Receiver* receiver)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _getInstances(_changes[receiver]);
+}
+
+void Discovery::remove(const Receiver* receiver)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _changes.erase(receiver);
+}
+
+void Discovery::update(const Receiver* receiver, Instances& changes)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _update();
+
+    changes.clear();
+    changes.swap(_changes[receiver]);
+}
+
+void Discovery::_push(const Instance& instance)
+{
+    for (auto& i : _changes)
+        i.second.push_back(instance);
+}
+}
+}
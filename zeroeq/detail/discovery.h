@@ -0,0 +1,89 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace zeroeq
+{
+namespace detail
+{
+class Receiver;
+
+/**
+ * Source of instances to connect to for receivers, shared by all receivers of
+ * a process.
+ *
+ * Instance changes are queued for each registered receiver, which applies
+ * them in its own thread during update(). A newly registered receiver first
+ * gets all known instances.
+ */
+class Discovery
+{
+public:
+    struct Instance
+    {
+        std::string name; //!< host:port, or a ZeroMQ URI
+        std::map<std::string, std::string> properties;
+        bool added; //!< false if the instance was removed
+
+        bool contains(const std::string& key) const
+        {
+            return properties.count(key) > 0;
+        }
+
+        std::string get(const std::string& key) const
+        {
+            const auto i = properties.find(key);
+            return i == properties.end() ? std::string() : i->second;
+        }
+    };
+    using Instances = std::vector<Instance>;
+
+    virtual ~Discovery() {}
+    void add(const Receiver* receiver);
+    void remove(const Receiver* receiver);
+
+    /** Look for changes without blocking and return those of the receiver. */
+    void update(const Receiver* receiver, Instances& changes);
+
+protected:
+    /** @return the instance of T for the key, shared while referenced. */
+    template <class T>
+    static std::shared_ptr<T> getShared(const std::string& key)
+    {
+        static std::map<std::string, std::weak_ptr<T>> instances;
+        static std::mutex mutex;
+        std::lock_guard<std::mutex> lock(mutex);
+
+        std::shared_ptr<T> instance = instances[key].lock();
+        if (!instance)
+        {
+            instance.reset(new T(key));
+            instances[key] = instance;
+        }
+        return instance;
+    }
+
+    /** Look for changes and _push() them, called locked. */
+    virtual void _update() = 0;
+
+    /** Append all known instances, called locked. */
+    virtual void _getInstances(Instances& instances) const = 0;
+
+    /** Queue a change for all receivers, called locked. */
+    void _push(const Instance& instance);
+
+private:
+    std::mutex _mutex;
+    std::unordered_map<const Receiver*, Instances> _changes;
+};
+}
+}
@@ -0,0 +1,500 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include "fanOut.h"
+
+#include "byteswap.h"
+#include "common.h"
+#include "constants.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <set>
+
+#ifndef _MSC_VER
+#include <ifaddrs.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#endif
+
+namespace zeroeq
+{
+namespace detail
+{
+namespace
+{
+void append(std::string& string, uint128_t value)
+{
+#ifdef ZEROEQ_BIGENDIAN
+    byteswap(value); // convert to little endian wire protocol
+#endif
+    string.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+uint128_t read(const uint8_t* data)
+{
+    uint128_t value;
+    ::memcpy(&value, data, sizeof(value));
+#ifdef ZEROEQ_BIGENDIAN
+    byteswap(value); // convert from little endian wire protocol
+#endif
+    return value;
+}
+
+std::vector<std::string> split(const char* data, const size_t size)
+{
+    std::vector<std::string> lines;
+    const char* const end = data + size;
+    while (data < end)
+    {
+        const char* next = static_cast<const char*>(
+            ::memchr(data, '\n', size_t(end - data)));
+        if (!next)
+            next = end;
+        lines.emplace_back(data, next);
+        data = next + 1;
+    }
+    return lines;
+}
+
+bool splitHostPort(const std::string& uri, std::string& host,
+                   std::string& port)
+{
+    const size_t start = uri.find("://");
+    const size_t end = uri.rfind(':');
+    if (start == std::string::npos || end == std::string::npos ||
+        end < start + 3)
+    {
+        return false;
+    }
+    host = uri.substr(start + 3, end - start - 3);
+    port = uri.substr(end + 1);
+    if (host.size() > 1 && host.front() == '[' && host.back() == ']')
+        host = host.substr(1, host.size() - 2); // IPv6 address
+    std::transform(host.begin(), host.end(), host.begin(), ::tolower);
+    return !host.empty() && !port.empty();
+}
+
+/** @return the wildcard, loopback, host names and addresses of this host. */
+std::set<std::string> getLocalHosts()
+{
+    std::set<std::string> hosts{"*", "0.0.0.0", "localhost", "127.0.0.1",
+                                "::", "::1"};
+    std::string hostname = getHostName();
+    std::transform(hostname.begin(), hostname.end(), hostname.begin(),
+                   ::tolower);
+    if (!hostname.empty())
+        hosts.insert(hostname);
+
+#ifndef _MSC_VER
+    ifaddrs* addresses = nullptr;
+    if (getifaddrs(&addresses) != 0)
+        return hosts;
+
+    for (const ifaddrs* i = addresses; i; i = i->ifa_next)
+    {
+        if (!i->ifa_addr || (i->ifa_addr->sa_family != AF_INET &&
+                             i->ifa_addr->sa_family != AF_INET6))
+        {
+            continue;
+        }
+        const socklen_t size = i->ifa_addr->sa_family == AF_INET
+                                   ? sizeof(sockaddr_in)
+                                   : sizeof(sockaddr_in6);
+        char address[NI_MAXHOST] = {0};
+        if (getnameinfo(i->ifa_addr, size, address, sizeof(address), nullptr,
+                        0, NI_NUMERICHOST) == 0)
+        {
+            std::string host(address);
+            host = host.substr(0, host.find('%')); // IPv6 scope
+            hosts.insert(host);
+        }
+    }
+    freeifaddrs(addresses);
+#endif
+    return hosts;
+}
+
+bool isLocal(const std::string& host)
+{
+    static const std::set<std::string> localHosts = getLocalHosts();
+    return localHosts.count(host) > 0;
+}
+}
+
+namespace fanout
+{
+std::string makeRedirectTopic(const uint128_t& node)
+{
+    std::string topic;
+    append(topic, FANOUT_REDIRECT);
+    append(topic, node);
+    return topic;
+}
+
+std::string makeAnnounceTopic()
+{
+    std::string topic;
+    append(topic, FANOUT_ANNOUNCE);
+    append(topic, uint128_t());
+    return topic;
+}
+
+bool isAnnounceTopic(const void* data, const size_t size)
+{
+    static const std::string topic = makeAnnounceTopic();
+    return size == topic.size() && ::memcmp(data, topic.data(), size) == 0;
+}
+
+std::string makeJoinFilter(const uint128_t& node, const std::string& relay,
+                           const std::vector<std::string>& uris)
+{
+    std::string filter;
+    append(filter, FANOUT_JOIN);
+    append(filter, node);
+    filter += relay;
+    for (const auto& uri : uris)
+        filter += '\n' + uri;
+    return filter;
+}
+
+bool parseRedirectTopic(const void* data, const size_t size, uint128_t& node)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    if (size != topicSize || read(bytes) != FANOUT_REDIRECT)
+        return false;
+    node = read(bytes + sizeof(uint128_t));
+    return true;
+}
+
+bool parseRedirect(const void* data, const size_t size, std::string& from,
+                   std::string& to)
+{
+    const auto lines = split(static_cast<const char*>(data), size);
+    if (lines.size() != 2 || lines[0].empty() || lines[1].empty())
+        return false;
+    from = lines[0];
+    to = lines[1];
+    return true;
+}
+
+bool parseJoinFilter(const void* data, const size_t size, uint128_t& node,
+                     std::string& relay, std::vector<std::string>& uris)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    if (size < topicSize || read(bytes) != FANOUT_JOIN)
+        return false;
+
+    node = read(bytes + sizeof(uint128_t));
+    uris = split(reinterpret_cast<const char*>(bytes) + topicSize,
+                 size - topicSize);
+    if (uris.empty())
+        relay.clear();
+    else
+    {
+        relay = uris.front();
+        uris.erase(uris.begin());
+    }
+    return true;
+}
+
+bool matches(const std::string& uri1, const std::string& uri2)
+{
+    if (uri1 == uri2)
+        return true;
+
+    // tcp endpoints may be addressed with different names of the same host
+    static const std::string tcp(DEFAULT_SCHEMA + "://");
+    if (uri1.compare(0, tcp.size(), tcp) != 0 ||
+        uri2.compare(0, tcp.size(), tcp) != 0)
+    {
+        return false;
+    }
+
+    std::string host1, port1, host2, port2;
+    if (!splitHostPort(uri1, host1, port1) ||
+        !splitHostPort(uri2, host2, port2) || port1 != port2)
+    {
+        return false;
+    }
+    return host1 == host2 || (isLocal(host1) && isLocal(host2));
+}
+}
+
+bool FanOut::update(const uint8_t* data, const size_t size,
+                    Redirects& redirects)
+{
+    // Message is one byte 0=unsub or 1=sub, followed by the filter
+    uint128_t id;
+    std::string relay;
+    std::vector<std::string> uris;
+    if (size <= 1 + fanout::topicSize ||
+        !fanout::parseJoinFilter(data + 1, size - 1, id, relay, uris))
+    {
+        return false;
+    }
+
+    const std::string filter(reinterpret_cast<const char*>(data) + 1,
+                             size - 1);
+    if (data[0] == 0)
+    {
+        _leave(id, filter, redirects);
+        return true;
+    }
+
+    // Subscriptions are passed for each subscriber, unsubscriptions only
+    // after the last one, e.g., while a node moves to another relay
+    const auto i = _nodes.find(id);
+    if (_filters.insert(filter).second || i == _nodes.end() ||
+        i->second.filter != filter)
+    {
+        _join(id, filter, relay, uris, redirects);
+    }
+    return true;
+}
+
+void FanOut::setMaxChildren(const size_t maxChildren, Redirects& redirects)
+{
+    _maxChildren = maxChildren;
+    for (auto& i : _nodes)
+        _place(i.first, i.second, redirects);
+}
+
+size_t FanOut::getNumChildren(const uint128_t& node) const
+{
+    const auto i = _children.find(node);
+    return i == _children.end() ? 0 : i->second;
+}
+
+void FanOut::_join(const uint128_t& id, const std::string& filter,
+                   const std::string& relay,
+                   const std::vector<std::string>& uris, Redirects& redirects)
+{
+    Node& node = _nodes[id];
+    if (node.filter.empty())
+        node.order = ++_order;
+
+    _detach(node);
+    if (!node.relay.empty() && node.relay != relay)
+        _relays.erase(node.relay);
+    node.filter = filter;
+    node.relay = relay;
+    node.uris = uris;
+    node.redirected = false; // moved, or did not follow the redirect
+    _resolve(id, node);
+    _attach(node);
+
+    if (!relay.empty() && _relays.count(relay) == 0)
+    {
+        _relays[relay] = id;
+
+        // adopt the nodes connected to the new relay
+        for (auto& i : _nodes)
+        {
+            Node& orphan = i.second;
+            if (orphan.attached || orphan.redirected)
+                continue;
+            _resolve(i.first, orphan);
+            _attach(orphan);
+            _place(i.first, orphan, redirects);
+        }
+    }
+    _place(id, node, redirects);
+}
+
+void FanOut::_leave(const uint128_t& id, const std::string& filter,
+                    Redirects& redirects)
+{
+    if (_filters.erase(filter) == 0)
+        return;
+
+    const auto i = _nodes.find(id);
+    if (i == _nodes.end() || i->second.filter != filter)
+        return;
+
+    // another join filter of the node is still subscribed, e.g., while moving
+    const std::string prefix = filter.substr(0, fanout::topicSize);
+    const auto other = _filters.lower_bound(prefix);
+    if (other != _filters.end() &&
+        other->compare(0, prefix.size(), prefix) == 0)
+    {
+        uint128_t node;
+        std::string relay;
+        std::vector<std::string> uris;
+        fanout::parseJoinFilter(other->data(), other->size(), node, relay,
+                                uris);
+        _join(id, *other, relay, uris, redirects);
+        return;
+    }
+
+    _detach(i->second);
+    if (!i->second.relay.empty())
+        _relays.erase(i->second.relay);
+    _nodes.erase(i);
+    _children.erase(id);
+
+    // children of the node lost their parent
+    for (auto& j : _nodes)
+    {
+        Node& child = j.second;
+        const uint128_t* parent = _getEffectiveParent(child);
+        if (!parent || *parent != id)
+            continue;
+        child.attached = false;
+        child.redirected = false;
+        _resolve(j.first, child);
+        _attach(child);
+    }
+}
+
+void FanOut::_resolve(const uint128_t& id, Node& node)
+{
+    node.attached = false;
+    for (const auto& uri : node.uris)
+    {
+        if (fanout::matches(uri, _self))
+        {
+            node.attached = true;
+            node.parent = uint128_t();
+            node.parentURI = uri;
+            return;
+        }
+    }
+
+    for (const auto& uri : node.uris)
+    {
+        uint128_t relay;
+        if (_findRelay(uri, relay) && relay != id)
+        {
+            node.attached = true;
+            node.parent = relay;
+            node.parentURI = uri;
+            return;
+        }
+    }
+}
+
+void FanOut::_place(const uint128_t& id, Node& node, Redirects& redirects)
+{
+    if (_maxChildren == 0 || !node.attached || node.redirected ||
+        getNumChildren(node.parent) <= _maxChildren)
+    {
+        return;
+    }
+
+    // breadth first: the highest relay with a free slot
+    bool found = false;
+    uint128_t target;
+    std::string to;
+    int depth = 0;
+    uint64_t order = 0;
+    if (node.parent != uint128_t() && getNumChildren() < _maxChildren)
+    {
+        found = true;
+        to = _self;
+    }
+
+    for (const auto& i : _relays)
+    {
+        const uint128_t& relay = i.second;
+        if (relay == id || relay == node.parent ||
+            getNumChildren(relay) >= _maxChildren)
+        {
+            continue;
+        }
+
+        const int relayDepth = _getDepth(relay, id);
+        if (relayDepth < 0) // detached, or below the node
+            continue;
+
+        const uint64_t relayOrder = _nodes.find(relay)->second.order;
+        if (!found || relayDepth < depth ||
+            (relayDepth == depth && relayOrder < order))
+        {
+            found = true;
+            target = relay;
+            to = i.first;
+            depth = relayDepth;
+            order = relayOrder;
+        }
+    }
+    if (!found)
+        return;
+
+    _detach(node);
+    node.redirected = true;
+    node.target = target;
+    _attach(node);
+    redirects.push_back({id, node.parentURI, to});
+}
+
+bool FanOut::_findRelay(const std::string& uri, uint128_t& relay) const
+{
+    const auto i = _relays.find(uri);
+    if (i != _relays.end())
+    {
+        relay = i->second;
+        return true;
+    }
+
+    for (const auto& j : _relays)
+    {
+        if (fanout::matches(uri, j.first))
+        {
+            relay = j.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+int FanOut::_getDepth(uint128_t relay, const uint128_t& node) const
+{
+    int depth = 1;
+    for (size_t i = 0; i <= _nodes.size(); ++i, ++depth)
+    {
+        if (relay == node)
+            return -1;
+
+        const auto j = _nodes.find(relay);
+        if (j == _nodes.end())
+            return -1;
+
+        const uint128_t* parent = _getEffectiveParent(j->second);
+        if (!parent)
+            return -1;
+        if (*parent == uint128_t())
+            return depth;
+        relay = *parent;
+    }
+    return -1; // cycle
+}
+
+const uint128_t* FanOut::_getEffectiveParent(const Node& node) const
+{
+    if (node.redirected)
+        return &node.target;
+    return node.attached ? &node.parent : nullptr;
+}
+
+void FanOut::_detach(Node& node)
+{
+    const uint128_t* parent = _getEffectiveParent(node);
+    if (!parent)
+        return;
+
+    const auto i = _children.find(*parent);
+    if (i != _children.end() && --i->second == 0)
+        _children.erase(i);
+}
+
+void FanOut::_attach(Node& node)
+{
+    const uint128_t* parent = _getEffectiveParent(node);
+    if (parent)
+        ++_children[*parent];
+}
+}
+}
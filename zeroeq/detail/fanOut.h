@@ -0,0 +1,147 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include <zeroeq/types.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace zeroeq
+{
+namespace detail
+{
+/**
+ * Wire format of the fan-out tree, see FanOut.
+ *
+ * Every tree node subscribes to its redirect topic [FANOUT_REDIRECT][node] and
+ * to its join filter [FANOUT_JOIN][node][relay URI][\\nconnected URI]*. Join
+ * filters never match an event, they only tell the publishers about the node,
+ * its upstream connections and, for relays, the URI it re-publishes on. A
+ * redirect message is the redirect topic followed by a 'from URI\\nto URI'
+ * frame, asking the node to move its connection from one upstream to another.
+ *
+ * Subscribers only send their join filter once a publisher with a fan-out tree
+ * published the announce topic [FANOUT_ANNOUNCE][0], which they subscribe to
+ * until then. Relays always send it.
+ */
+namespace fanout
+{
+static const size_t topicSize = 2 * sizeof(uint128_t);
+
+/** @return the redirect topic of the given node. */
+std::string makeRedirectTopic(const uint128_t& node);
+
+/** @return the topic announcing a publisher with a fan-out tree. */
+std::string makeAnnounceTopic();
+
+/** @return true if the data is the announce topic. */
+bool isAnnounceTopic(const void* data, size_t size);
+
+/** @return the join filter of the given node. */
+std::string makeJoinFilter(const uint128_t& node, const std::string& relay,
+                           const std::vector<std::string>& uris);
+
+/** @return true and the node if the data starts with a redirect topic. */
+bool parseRedirectTopic(const void* data, size_t size, uint128_t& node);
+
+/** @return true and the URIs of a redirect message payload. */
+bool parseRedirect(const void* data, size_t size, std::string& from,
+                   std::string& to);
+
+/** @return true and its content if the data is a join filter. */
+bool parseJoinFilter(const void* data, size_t size, uint128_t& node,
+                     std::string& relay, std::vector<std::string>& uris);
+
+/**
+ * @return true if both URIs address the same endpoint: equal URIs, or tcp URIs
+ *         with the same port on the same host. The wildcard, loopback, host
+ *         name and interface addresses of this host all name the same host.
+ */
+bool matches(const std::string& uri1, const std::string& uri2);
+}
+
+/**
+ * Fan-out tree of the receivers of a Publisher with bounded out-degree.
+ *
+ * The tree is derived from the join filters of its nodes: a node is a child of
+ * the publisher or of the relay it is connected to. When a node joins below a
+ * parent which already has the maximum number of children, it is redirected
+ * to the highest relay in the tree with a free slot, which is neither the
+ * node itself nor one of its descendants.
+ */
+class FanOut
+{
+public:
+    struct Redirect
+    {
+        uint128_t node;
+        std::string from;
+        std::string to;
+    };
+    using Redirects = std::vector<Redirect>;
+
+    /** Set the URI of the publisher, the root of the tree. */
+    void setURI(const std::string& self) { _self = self; }
+
+    /** Set the maximum number of children, appending the redirects. */
+    void setMaxChildren(size_t maxChildren, Redirects& redirects);
+    size_t getMaxChildren() const { return _maxChildren; }
+
+    /**
+     * Apply a subscription message, appending the necessary redirects.
+     *
+     * @return false if the message is not a join filter
+     */
+    bool update(const uint8_t* data, size_t size, Redirects& redirects);
+
+    /** @return the number of children of a node, or of the publisher. */
+    size_t getNumChildren(const uint128_t& node = uint128_t()) const;
+
+    /** @return the number of nodes in the tree. */
+    size_t getNumNodes() const { return _nodes.size(); }
+
+private:
+    struct Node
+    {
+        std::string filter;
+        std::string relay;
+        std::vector<std::string> uris;
+        uint64_t order{0};
+        bool attached{false}; // parent is known
+        uint128_t parent;     // uint128_t() is the publisher
+        std::string parentURI;
+        bool redirected{false}; // waiting for the node to move to target
+        uint128_t target;
+    };
+
+    std::string _self;
+    size_t _maxChildren{0};
+    uint64_t _order{0};
+    std::set<std::string> _filters; // subscribed join filters
+    std::unordered_map<uint128_t, Node> _nodes;
+    std::map<std::string, uint128_t> _relays; // by relay URI
+    std::unordered_map<uint128_t, size_t> _children;
+
+    void _join(const uint128_t& id, const std::string& filter,
+               const std::string& relay, const std::vector<std::string>& uris,
+               Redirects& redirects);
+    void _leave(const uint128_t& id, const std::string& filter,
+                Redirects& redirects);
+
+    void _resolve(const uint128_t& id, Node& node);
+    void _place(const uint128_t& id, Node& node, Redirects& redirects);
+    bool _findRelay(const std::string& uri, uint128_t& relay) const;
+    int _getDepth(uint128_t relay, const uint128_t& node) const;
+
+    const uint128_t* _getEffectiveParent(const Node& node) const;
+    void _detach(Node& node);
+    void _attach(Node& node);
+};
+}
+}
@@ -0,0 +1,124 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include "hash.h"
+
+#include "byteswap.h"
+
+#include <cstring>
+
+namespace zeroeq
+{
+namespace detail
+{
+namespace
+{
+const uint64_t PRIME1 = 11400714785074694791ull;
+const uint64_t PRIME2 = 14029467366897019727ull;
+const uint64_t PRIME3 = 1609587929392839161ull;
+const uint64_t PRIME4 = 9650029242287828579ull;
+const uint64_t PRIME5 = 2870177450012600261ull;
+
+inline uint64_t rotl(const uint64_t value, const int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// Unaligned little endian loads
+inline uint64_t read64(const uint8_t* data)
+{
+    uint64_t value;
+    ::memcpy(&value, data, sizeof(value));
+#ifdef ZEROEQ_BIGENDIAN
+    byteswap(value);
+#endif
+    return value;
+}
+
+inline uint64_t read32(const uint8_t* data)
+{
+    uint32_t value;
+    ::memcpy(&value, data, sizeof(value));
+#ifdef ZEROEQ_BIGENDIAN
+    byteswap(value);
+#endif
+    return value;
+}
+
+inline uint64_t round(uint64_t acc, const uint64_t input)
+{
+    acc += input * PRIME2;
+    acc = rotl(acc, 31);
+    return acc * PRIME1;
+}
+
+inline uint64_t merge(uint64_t acc, const uint64_t value)
+{
+    acc ^= round(0, value);
+    return acc * PRIME1 + PRIME4;
+}
+}
+
+uint64_t hash64(const void* data, const size_t size, const uint64_t seed)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* const end = p + size;
+    uint64_t hash;
+
+    if (size >= 32)
+    {
+        const uint8_t* const limit = end - 32;
+        uint64_t v1 = seed + PRIME1 + PRIME2;
+        uint64_t v2 = seed + PRIME2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME1;
+
+        do
+        {
+            v1 = round(v1, read64(p));
+            v2 = round(v2, read64(p + 8));
+            v3 = round(v3, read64(p + 16));
+            v4 = round(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        hash = merge(hash, v1);
+        hash = merge(hash, v2);
+        hash = merge(hash, v3);
+        hash = merge(hash, v4);
+    }
+    else
+        hash = seed + PRIME5;
+
+    hash += uint64_t(size);
+
+    for (; p + 8 <= end; p += 8)
+    {
+        hash ^= round(0, read64(p));
+        hash = rotl(hash, 27) * PRIME1 + PRIME4;
+    }
+
+    if (p + 4 <= end)
+    {
+        hash ^= read32(p) * PRIME1;
+        hash = rotl(hash, 23) * PRIME2 + PRIME3;
+        p += 4;
+    }
+
+    for (; p < end; ++p)
+    {
+        hash ^= (*p) * PRIME5;
+        hash = rotl(hash, 11) * PRIME1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME2;
+    hash ^= hash >> 29;
+    hash *= PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
+}
+}
@@ -0,0 +1,22 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include <zeroeq/types.h>
+
+namespace zeroeq
+{
+namespace detail
+{
+/** @return the 64 bit xxHash (XXH64) of the given data. */
+uint64_t hash64(const void* data, size_t size, uint64_t seed = 0);
+
+/** @return a 128 bit hash of the given data, e.g., for cache keys. */
+inline uint128_t hash128(const void* data, const size_t size)
+{
+    return uint128_t(hash64(data, size, 0), hash64(data, size, size + 1));
+}
+}
+}
@@ -0,0 +1,58 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include "hashRing.h"
+
+#include "hash.h"
+
+#include <algorithm>
+
+namespace zeroeq
+{
+namespace detail
+{
+void HashRing::add(const std::string& node)
+{
+    if (std::any_of(_points.begin(), _points.end(),
+                    [&node](const Point& point) { return point.node == node; }))
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < _virtualNodes; ++i)
+    {
+        const Point point{hash64(node.data(), node.size(), i), node};
+        _points.insert(std::upper_bound(_points.begin(), _points.end(), point,
+                                        [](const Point& a, const Point& b) {
+                                            return a.hash < b.hash;
+                                        }),
+                       point);
+    }
+}
+
+void HashRing::remove(const std::string& node)
+{
+    _points.erase(std::remove_if(_points.begin(), _points.end(),
+                                 [&node](const Point& point) {
+                                     return point.node == node;
+                                 }),
+                  _points.end());
+}
+
+uint64_t HashRing::hash(const void* key, const size_t size)
+{
+    return hash64(key, size);
+}
+
+size_t HashRing::_lowerBound(const uint64_t key) const
+{
+    const auto i =
+        std::lower_bound(_points.begin(), _points.end(), key,
+                         [](const Point& point, const uint64_t hash) {
+                             return point.hash < hash;
+                         });
+    return size_t(i - _points.begin()); // wraps to the first point in find()
+}
+}
+}
@@ -0,0 +1,76 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include <zeroeq/api.h>
+#include <zeroeq/types.h>
+
+#include <string>
+#include <vector>
+
+namespace zeroeq
+{
+namespace detail
+{
+/**
+ * Consistent hash ring mapping keys to a set of nodes.
+ *
+ * Each node is placed at a number of pseudo-random points on the ring, its
+ * virtual nodes. A key belongs to the node of the first point at or after the
+ * hash of the key, so that adding or removing a node only moves the keys of
+ * its own points, and keys are spread evenly over the nodes.
+ */
+class HashRing
+{
+public:
+    explicit HashRing(size_t virtualNodes = 128)
+        : _virtualNodes(virtualNodes)
+    {
+    }
+
+    /** Add a node, no-op if it is already on the ring. */
+    ZEROEQ_API void add(const std::string& node);
+
+    /** Remove a node, no-op if it is not on the ring. */
+    ZEROEQ_API void remove(const std::string& node);
+
+    /** @return the hash of a key on the ring. */
+    ZEROEQ_API static uint64_t hash(const void* key, size_t size);
+
+    /**
+     * @return the first node at or after the given key hash which is accepted
+     *         by the filter, or nullptr if none is accepted
+     */
+    template <class F>
+    const std::string* find(const uint64_t key, const F& accept) const
+    {
+        const size_t size = _points.size();
+        size_t i = _lowerBound(key);
+        for (size_t n = 0; n < size; ++n, ++i)
+        {
+            const std::string& node = _points[i % size].node;
+            if (accept(node))
+                return &node;
+        }
+        return nullptr;
+    }
+
+    /** @return the number of nodes on the ring. */
+    size_t size() const { return _points.size() / _virtualNodes; }
+
+private:
+    struct Point
+    {
+        uint64_t hash;
+        std::string node;
+    };
+
+    const size_t _virtualNodes;
+    std::vector<Point> _points; // sorted by hash
+
+    ZEROEQ_API size_t _lowerBound(uint64_t key) const;
+};
+}
+}
@@ -0,0 +1,203 @@
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace zeroeq
+{
+namespace detail
+{
+/**
+ * An immutable map of string keys, implemented as a hash array mapped trie.
+ *
+ * Modifications return a new version of the map which shares all unmodified
+ * nodes with the previous one. They copy the nodes on the path to the key,
+ * which costs O(log n) instead of the O(n) of copying the whole map. Versions
+ * are immutable, so they can be read concurrently from any thread.
+ */
+template <class T>
+class HashTrie
+{
+public:
+    /** @return the value of the key, or nullptr if it is not set. */
+    const T* find(const std::string& key) const
+    {
+        const size_t hash = std::hash<std::string>()(key);
+        const Node* node = _root.get();
+        for (size_t shift = 0; node && !node->isLeaf(); shift += bits)
+            node = node->children[(hash >> shift) & mask].get();
+
+        if (!node || node->hash != hash)
+            return nullptr;
+        for (const auto& entry : node->entries)
+            if (entry.first == key)
+                return &entry.second;
+        return nullptr;
+    }
+
+    /** @return a new version with the key set to the value. */
+    HashTrie set(const std::string& key, const T& value) const
+    {
+        bool added = false;
+        HashTrie trie;
+        trie._root = _set(_root, std::hash<std::string>()(key), 0, key, value,
+                          added);
+        trie._size = _size + (added ? 1 : 0);
+        return trie;
+    }
+
+    /** @return a new version without the key. */
+    HashTrie erase(const std::string& key) const
+    {
+        bool removed = false;
+        HashTrie trie;
+        trie._root = _erase(_root, std::hash<std::string>()(key), 0, key,
+                            removed);
+        trie._size = _size - (removed ? 1 : 0);
+        return trie;
+    }
+
+    /** Call func(key, value) for all entries, in no particular order. */
+    template <class F>
+    void forEach(const F& func) const
+    {
+        _forEach(_root.get(), func);
+    }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+private:
+    static const size_t bits = 5;
+    static const size_t mask = (1u << bits) - 1;
+
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    /** A leaf of the entries of one hash, or an inner node. */
+    struct Node
+    {
+        size_t hash{0};
+        std::vector<std::pair<std::string, T>> entries; // leaf
+        std::array<NodePtr, 1u << bits> children;       // inner node
+
+        bool isLeaf() const { return !entries.empty(); }
+    };
+
+    NodePtr _root;
+    size_t _size{0};
+
+    static NodePtr _set(const NodePtr& node, const size_t hash,
+                        const size_t shift, const std::string& key,
+                        const T& value, bool& added)
+    {
+        if (!node)
+        {
+            auto leaf = std::make_shared<Node>();
+            leaf->hash = hash;
+            leaf->entries.emplace_back(key, value);
+            added = true;
+            return leaf;
+        }
+
+        if (node->isLeaf())
+        {
+            if (node->hash == hash)
+            {
+                auto leaf = std::make_shared<Node>(*node);
+                for (auto& entry : leaf->entries)
+                {
+                    if (entry.first == key)
+                    {
+                        entry.second = value;
+                        return leaf;
+                    }
+                }
+                leaf->entries.emplace_back(key, value); // hash collision
+                added = true;
+                return leaf;
+            }
+
+            // different hashes differ in a later group of bits, split the leaf
+            auto inner = std::make_shared<Node>();
+            inner->children[(node->hash >> shift) & mask] = node;
+            return _set(inner, hash, shift, key, value, added);
+        }
+
+        auto inner = std::make_shared<Node>(*node);
+        NodePtr& child = inner->children[(hash >> shift) & mask];
+        child = _set(child, hash, shift + bits, key, value, added);
+        return inner;
+    }
+
+    static NodePtr _erase(const NodePtr& node, const size_t hash,
+                          const size_t shift, const std::string& key,
+                          bool& removed)
+    {
+        if (!node)
+            return node;
+
+        if (node->isLeaf())
+        {
+            if (node->hash != hash)
+                return node;
+            for (size_t i = 0; i < node->entries.size(); ++i)
+            {
+                if (node->entries[i].first != key)
+                    continue;
+
+                removed = true;
+                if (node->entries.size() == 1)
+                    return {};
+                auto leaf = std::make_shared<Node>(*node);
+                leaf->entries.erase(leaf->entries.begin() + i);
+                return leaf;
+            }
+            return node;
+        }
+
+        const size_t index = (hash >> shift) & mask;
+        const NodePtr child =
+            _erase(node->children[index], hash, shift + bits, key, removed);
+        if (!removed)
+            return node;
+
+        auto inner = std::make_shared<Node>(*node);
+        inner->children[index] = child;
+
+        // collapse an inner node left with a single leaf, or with nothing
+        NodePtr last;
+        size_t count = 0;
+        for (const NodePtr& remaining : inner->children)
+        {
+            if (remaining)
+            {
+                last = remaining;
+                ++count;
+            }
+        }
+        if (count == 0 || (count == 1 && last->isLeaf()))
+            return last;
+        return inner;
+    }
+
+    template <class F>
+    static void _forEach(const Node* node, const F& func)
+    {
+        if (!node)
+            return;
+        for (const auto& entry : node->entries)
+            func(entry.first, entry.second);
+        for (const NodePtr& child : node->children)
+            _forEach(child.get(), func);
+    }
+};
+}
+}
@@ -0,0 +1,97 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include "byteswap.h"
+
+#include <zeroeq/types.h>
+
+#include <cstring>
+
+namespace zeroeq
+{
+namespace detail
+{
+/**
+ * Optional header frame of a published event, sent between the event and the
+ * payload frame. Events without header consist of two frames at most.
+ *
+ * The header starts with a magic byte and a version, headers of unknown
+ * versions are rejected. Subscribers before the header was introduced cannot
+ * receive events with a header.
+ */
+struct Header
+{
+    static const uint8_t magic = 0xEE;
+    static const uint8_t version = 1;
+
+    enum Encoding
+    {
+        ENCODING_PLAIN = 0,    //!< payload is the event data
+        ENCODING_KEYFRAME = 1, //!< payload is the event data and a new base
+        ENCODING_DELTA = 2     //!< payload is a delta against the keyframe
+    };
+
+    uint8_t encoding{ENCODING_PLAIN};
+    uint128_t sender;     //!< publisher instance, scope of the sequences
+    uint64_t sequence{0}; //!< per-event sequence number of this message
+    uint64_t keyframe{0}; //!< sequence number of the base keyframe
+    uint64_t size{0};     //!< size of the decoded payload
+
+    static const size_t wireSize =
+        3 * sizeof(uint8_t) + sizeof(uint128_t) + 3 * sizeof(uint64_t);
+
+    /** Serialize into the given buffer of wireSize bytes. */
+    void write(uint8_t* to) const
+    {
+        to[0] = magic;
+        to[1] = version;
+        to[2] = encoding;
+        _write(to + 3, sender.low());
+        _write(to + 11, sender.high());
+        _write(to + 19, sequence);
+        _write(to + 27, keyframe);
+        _write(to + 35, size);
+    }
+
+    /** @return false if the given data is not a valid header. */
+    bool read(const uint8_t* from, const size_t length)
+    {
+        if (length != wireSize || from[0] != magic || from[1] != version ||
+            from[2] > ENCODING_DELTA)
+        {
+            return false;
+        }
+
+        encoding = from[2];
+        uint64_t low, high;
+        _read(from + 3, low);
+        _read(from + 11, high);
+        sender = uint128_t(high, low);
+        _read(from + 19, sequence);
+        _read(from + 27, keyframe);
+        _read(from + 35, size);
+        return true;
+    }
+
+private:
+    static void _write(uint8_t* to, uint64_t value)
+    {
+#ifdef ZEROEQ_BIGENDIAN
+        byteswap(value); // convert to little endian wire protocol
+#endif
+        ::memcpy(to, &value, sizeof(value));
+    }
+
+    static void _read(const uint8_t* from, uint64_t& value)
+    {
+        ::memcpy(&value, from, sizeof(value));
+#ifdef ZEROEQ_BIGENDIAN
+        byteswap(value); // convert from little endian wire protocol
+#endif
+    }
+};
+}
+}
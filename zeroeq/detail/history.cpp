@@ -0,0 +1,347 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include "history.h"
+
+#include "byteswap.h"
+
+#include "../log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+namespace zeroeq
+{
+namespace detail
+{
+namespace
+{
+const std::string suffix(".journal");
+const size_t nameSize = 32 + 1 + 16 + 8; // <event>.<first sequence>.journal
+const uint64_t minSegmentSize = 1 << 16;
+const uint64_t maxSegmentSize = 1 << 26;
+const uint64_t retentionInterval = 1000000; // of all events, in microseconds
+
+uint64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+std::string toHex(const uint64_t value)
+{
+    char buffer[17];
+    ::snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long)value);
+    return buffer;
+}
+
+bool fromHex(const std::string& string, uint64_t& value)
+{
+    if (string.size() != 16 ||
+        string.find_first_not_of("0123456789abcdef") != std::string::npos)
+    {
+        return false;
+    }
+    value = std::strtoull(string.c_str(), nullptr, 16);
+    return true;
+}
+
+void write(std::vector<uint8_t>& out, uint64_t value)
+{
+#ifdef ZEROEQ_BIGENDIAN
+    byteswap(value); // convert to little endian wire protocol
+#endif
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(value));
+}
+
+void store(uint8_t* to, uint64_t value)
+{
+#ifdef ZEROEQ_BIGENDIAN
+    byteswap(value); // convert to little endian wire protocol
+#endif
+    ::memcpy(to, &value, sizeof(value));
+}
+
+void createDirectory(const std::string& directory)
+{
+#ifdef _WIN32
+    if (::_mkdir(directory.c_str()) == 0 || errno == EEXIST)
+#else
+    if (::mkdir(directory.c_str(), 0755) == 0 || errno == EEXIST)
+#endif
+        return;
+
+    ZEROEQTHROW(std::runtime_error("Cannot create history directory '" +
+                                   directory + "': " + ::strerror(errno)));
+}
+
+std::vector<std::string> listDirectory(const std::string& directory)
+{
+    std::vector<std::string> names;
+#ifdef _WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE handle = ::FindFirstFileA((directory + "/*").c_str(), &data);
+    if (handle == INVALID_HANDLE_VALUE)
+        return names;
+    do
+        names.push_back(data.cFileName);
+    while (::FindNextFileA(handle, &data));
+    ::FindClose(handle);
+#else
+    DIR* dir = ::opendir(directory.c_str());
+    if (!dir)
+        return names;
+    while (const dirent* entry = ::readdir(dir))
+        names.push_back(entry->d_name);
+    ::closedir(dir);
+#endif
+    return names;
+}
+
+void removeSegment(const std::string& filename)
+{
+    std::remove(filename.c_str());
+    std::remove((filename + ".index").c_str());
+}
+}
+
+History::History(const std::string& directory, const uint64_t maxSize,
+                 const uint32_t maxAge)
+    : _directory(directory)
+    , _maxSize(maxSize)
+    , _maxAge(uint64_t(maxAge) * 1000000)
+    , _segmentSize(maxSize == 0 ? maxSegmentSize
+                                : std::min(std::max(maxSize / 8,
+                                                    minSegmentSize),
+                                           maxSegmentSize))
+{
+    createDirectory(directory);
+    _recover();
+    _retainAll(now());
+}
+
+History::~History()
+{
+}
+
+uint64_t History::append(const uint128_t& event, const void* data,
+                         const size_t size)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    Topic& topic = _topics[event];
+    const uint64_t timestamp = now();
+    try
+    {
+        if (!topic.writer || topic.segments.back().size >= _segmentSize)
+            _roll(event, topic);
+        topic.writer->append(timestamp, event, data, size);
+    }
+    catch (const std::runtime_error& e)
+    {
+        ZEROEQWARN << "Cannot append to history of event " << event << ": "
+                   << e.what() << std::endl;
+        return 0;
+    }
+
+    Segment& segment = topic.segments.back();
+    topic.size += topic.writer->getSize() - segment.size;
+    segment.size = topic.writer->getSize();
+    segment.timestamp = timestamp;
+    ++segment.count;
+
+    _retain(topic, timestamp);
+    if (timestamp > _lastRetention + retentionInterval) // idle events
+        _retainAll(timestamp);
+    return ++topic.sequence;
+}
+
+void History::query(const uint128_t& event, const uint64_t since,
+                    const size_t maxBytes, const uint128_t& publisher,
+                    std::vector<uint8_t>& reply)
+{
+    reply.resize(replyHeaderSize);
+    uint64_t first = since + 1;
+    uint64_t last = 0;
+    uint64_t count = 0;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto i = _topics.find(event);
+    if (i != _topics.end())
+    {
+        Topic& topic = i->second;
+        _retain(topic, now()); // do not serve expired segments
+        last = topic.sequence;
+        if (!topic.segments.empty())
+            first = topic.segments.front().first;
+
+        bool full = false;
+        for (Segment& segment : topic.segments)
+        {
+            if (full)
+                break;
+            if (segment.first + segment.count <= since + 1) // all older
+                continue;
+
+            try
+            {
+                const JournalWriter* writer =
+                    &segment == &topic.segments.back() ? topic.writer.get()
+                                                       : nullptr;
+                if (!writer && !segment.reader)
+                    segment.reader.reset(new JournalReader(segment.filename));
+
+                size_t j = since >= segment.first ? since - segment.first + 1
+                                                  : 0;
+                Record record;
+                for (; j < segment.count &&
+                       (writer ? writer->get(j, record)
+                               : segment.reader->get(j, record));
+                     ++j)
+                {
+                    if (count > 0 && reply.size() + recordHeaderSize +
+                                             record.size >
+                                         maxBytes)
+                    {
+                        full = true;
+                        break;
+                    }
+
+                    write(reply, segment.first + j);
+                    write(reply, record.timestamp);
+                    write(reply, record.size);
+                    const uint8_t* bytes =
+                        static_cast<const uint8_t*>(record.data);
+                    reply.insert(reply.end(), bytes, bytes + record.size);
+                    ++count;
+                }
+            }
+            catch (const std::runtime_error& e)
+            {
+                ZEROEQWARN << "Skipping history segment: " << e.what()
+                           << std::endl;
+            }
+        }
+    }
+
+    store(reply.data(), publisher.low());
+    store(reply.data() + 8, publisher.high());
+    store(reply.data() + 16, first);
+    store(reply.data() + 24, last);
+    store(reply.data() + 32, count);
+}
+
+void History::_recover()
+{
+    for (const auto& name : listDirectory(_directory))
+    {
+        uint64_t high, low, first;
+        if (name.size() != nameSize || name[32] != '.' ||
+            name.compare(49, suffix.size(), suffix) != 0 ||
+            !fromHex(name.substr(0, 16), high) ||
+            !fromHex(name.substr(16, 16), low) ||
+            !fromHex(name.substr(33, 16), first))
+        {
+            continue;
+        }
+
+        Segment segment;
+        segment.filename = _directory + "/" + name;
+        segment.first = first;
+        try
+        {
+            segment.reader.reset(new JournalReader(segment.filename));
+            segment.count = segment.reader->getNumRecords();
+            segment.size = segment.reader->getSize(); // as counted on append
+
+            Record record;
+            if (segment.count > 0 &&
+                segment.reader->get(segment.count - 1, record))
+            {
+                segment.timestamp = record.timestamp;
+            }
+        }
+        catch (const std::runtime_error& e)
+        {
+            ZEROEQWARN << "Ignoring history segment: " << e.what()
+                       << std::endl;
+            continue;
+        }
+
+        if (segment.count == 0)
+        {
+            segment.reader.reset();
+            removeSegment(segment.filename);
+            continue;
+        }
+        _topics[uint128_t(high, low)].segments.push_back(std::move(segment));
+    }
+
+    for (auto& i : _topics)
+    {
+        Topic& topic = i.second;
+        std::sort(topic.segments.begin(), topic.segments.end(),
+                  [](const Segment& a, const Segment& b) {
+                      return a.first < b.first;
+                  });
+        for (const Segment& segment : topic.segments)
+            topic.size += segment.size;
+
+        const Segment& last = topic.segments.back();
+        topic.sequence = last.first + last.count - 1;
+    }
+}
+
+void History::_roll(const uint128_t& event, Topic& topic)
+{
+    Segment segment;
+    segment.first = topic.sequence + 1;
+    segment.filename = _directory + "/" + toHex(event.high()) +
+                       toHex(event.low()) + "." + toHex(segment.first) +
+                       suffix;
+
+    topic.writer.reset(); // truncate and close previous segment
+    topic.writer.reset(new JournalWriter(segment.filename));
+    topic.segments.push_back(std::move(segment));
+}
+
+void History::_retainAll(const uint64_t timestamp)
+{
+    for (auto& i : _topics)
+        _retain(i.second, timestamp);
+    _lastRetention = timestamp;
+}
+
+void History::_retain(Topic& topic, const uint64_t timestamp)
+{
+    while (topic.segments.size() > 1)
+    {
+        const Segment& oldest = topic.segments.front();
+        const bool tooLarge = _maxSize > 0 && topic.size > _maxSize;
+        const bool tooOld = _maxAge > 0 && oldest.timestamp + _maxAge < timestamp;
+        if (!tooLarge && !tooOld)
+            return;
+
+        const std::string filename = oldest.filename;
+        topic.size -= oldest.size;
+        topic.segments.pop_front(); // unmap before removal
+        removeSegment(filename);
+    }
+}
+}
+}
@@ -0,0 +1,105 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include "journal.h"
+
+#include <zeroeq/types.h>
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace zeroeq
+{
+namespace detail
+{
+/**
+ * Persistent per-event history of a Publisher.
+ *
+ * Each event is stored in a sequence of journal segments named
+ * '<event>.<first sequence>.journal' in the history directory. The journal
+ * index provides the time index of a segment, and the sequence of a record is
+ * the first sequence of its segment plus its position. Existing segments are
+ * recovered on construction, and the oldest segments are deleted when the
+ * history of an event exceeds its size or age limit. The size of a segment is
+ * the size of its records, excluding file headers and unused capacity.
+ *
+ * Limits are applied on construction, on append() and query() of an event,
+ * and to all events at most once per second on append(), so that the history
+ * of events which are no longer published expires as well. The newest segment
+ * of an event is kept to continue its sequence.
+ *
+ * Closed segments stay mapped once read, and the open segment is read through
+ * its writer. append() and query() are thread safe.
+ *
+ * History replies are serialized as [publisher low][publisher high][first
+ * available sequence][last sequence][count], followed by count
+ * [sequence][timestamp][size][payload] records, all little endian uint64_t.
+ * The publisher identifies the live events the sequences refer to.
+ */
+class History
+{
+public:
+    /**
+     * @param maxSize the maximum size of each event history, 0 for unlimited
+     * @param maxAge the maximum age of segments in seconds, 0 for unlimited
+     * @throw std::runtime_error if the directory cannot be created
+     */
+    History(const std::string& directory, uint64_t maxSize, uint32_t maxAge);
+    ~History();
+
+    /** @return the sequence of the appended event, 0 on error. */
+    uint64_t append(const uint128_t& event, const void* data, size_t size);
+
+    /**
+     * Serialize the records of the event after the given sequence.
+     *
+     * @param maxBytes the approximate maximum size of the reply, at least one
+     *                 record is serialized
+     * @param publisher the instance of the publisher serving the reply
+     */
+    void query(const uint128_t& event, uint64_t since, size_t maxBytes,
+               const uint128_t& publisher, std::vector<uint8_t>& reply);
+
+    static const size_t replyHeaderSize = 5 * sizeof(uint64_t);
+    static const size_t recordHeaderSize = 3 * sizeof(uint64_t);
+
+private:
+    struct Segment
+    {
+        std::string filename;
+        uint64_t first{0}; // sequence of the first record
+        uint64_t count{0};
+        uint64_t size{0};
+        uint64_t timestamp{0}; // of the last record
+        std::unique_ptr<JournalReader> reader; // if closed and read before
+    };
+
+    struct Topic
+    {
+        std::deque<Segment> segments;
+        std::unique_ptr<JournalWriter> writer; // for segments.back()
+        uint64_t sequence{0};                  // last appended
+        uint64_t size{0};
+    };
+
+    const std::string _directory;
+    const uint64_t _maxSize;
+    const uint64_t _maxAge; // microseconds
+    const uint64_t _segmentSize;
+    std::mutex _mutex; // publish() and query() may run in different threads
+    std::unordered_map<uint128_t, Topic> _topics;
+    uint64_t _lastRetention{0}; // of all topics
+
+    void _recover();
+    void _roll(const uint128_t& event, Topic& topic);
+    void _retainAll(uint64_t now);
+    void _retain(Topic& topic, uint64_t now);
+};
+}
+}
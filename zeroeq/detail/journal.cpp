@@ -0,0 +1,256 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include "journal.h"
+
+#include "byteswap.h"
+
+#include "../log.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace zeroeq
+{
+namespace detail
+{
+namespace
+{
+// File header: [magic][version][journal size or index count][reserved]
+const size_t headerSize = 32;
+const size_t recordHeaderSize = 32; // [timestamp][event low][high][size]
+const size_t entrySize = 16;        // [timestamp][offset]
+const uint64_t version = 1;
+const char journalMagic[] = "ZEQJRNL1";
+const char indexMagic[] = "ZEQINDX1";
+
+inline void store(uint8_t* to, uint64_t value)
+{
+#ifdef ZEROEQ_BIGENDIAN
+    byteswap(value); // convert to little endian file format
+#endif
+    ::memcpy(to, &value, sizeof(value));
+}
+
+inline uint64_t load(const uint8_t* from)
+{
+    uint64_t value;
+    ::memcpy(&value, from, sizeof(value));
+#ifdef ZEROEQ_BIGENDIAN
+    byteswap(value); // convert from little endian file format
+#endif
+    return value;
+}
+
+inline uint64_t align(const uint64_t size)
+{
+    return (size + 7) & ~uint64_t(7);
+}
+
+void initHeader(MappedFile& file, const char* magic)
+{
+    file.resize(headerSize);
+    uint8_t* header = file.getData();
+    ::memset(header, 0, headerSize);
+    ::memcpy(header, magic, 8);
+    store(header + 8, version);
+}
+
+bool checkHeader(const MappedFile& file, const char* magic)
+{
+    const uint8_t* header = file.getData();
+    return file.getSize() >= headerSize && ::memcmp(header, magic, 8) == 0 &&
+           load(header + 8) == version;
+}
+}
+
+JournalWriter::JournalWriter(const std::string& filename)
+    : _journal(filename, MappedFile::MODE_WRITE)
+    , _index(filename + ".index", MappedFile::MODE_WRITE)
+{
+    initHeader(_journal, journalMagic);
+    initHeader(_index, indexMagic);
+}
+
+JournalWriter::~JournalWriter()
+{
+}
+
+void JournalWriter::append(const uint64_t timestamp, const uint128_t& event,
+                           const void* data, const size_t size)
+{
+    const size_t offset = _journal.getSize();
+    _journal.resize(offset + recordHeaderSize + align(size));
+
+    uint8_t* record = _journal.getData() + offset;
+    store(record, timestamp);
+    store(record + 8, event.low());
+    store(record + 16, event.high());
+    store(record + 24, size);
+    if (size > 0)
+        ::memcpy(record + recordHeaderSize, data, size);
+
+    const size_t entry = _index.getSize();
+    _index.resize(entry + entrySize);
+    store(_index.getData() + entry, timestamp);
+    store(_index.getData() + entry + 8, offset);
+
+    // commit, record before index
+    ++_numRecords;
+    store(_journal.getData() + 16, getSize());
+    store(_index.getData() + 16, _numRecords);
+}
+
+bool JournalWriter::get(const size_t index, Record& record) const
+{
+    if (index >= _numRecords)
+        return false;
+
+    const uint64_t offset =
+        load(_index.getData() + headerSize + index * entrySize + 8);
+    const uint8_t* data = _journal.getData() + offset;
+    record.timestamp = load(data);
+    record.event = uint128_t(load(data + 16), load(data + 8));
+    record.data = data + recordHeaderSize;
+    record.size = load(data + 24);
+    return true;
+}
+
+uint64_t JournalWriter::getSize() const
+{
+    return _journal.getSize() - headerSize;
+}
+
+void JournalWriter::flush()
+{
+    _journal.flush();
+    _index.flush();
+}
+
+JournalReader::JournalReader(const std::string& filename)
+    : _journal(std::make_shared<MappedFile>(filename, MappedFile::MODE_READ))
+{
+    if (!checkHeader(*_journal, journalMagic))
+        ZEROEQTHROW(std::runtime_error("Not a journal: " + filename));
+
+    const uint64_t size = load(_journal->getData() + 16);
+    if (size > _journal->getSize() - headerSize)
+        ZEROEQTHROW(std::runtime_error("Truncated journal: " + filename));
+    _end = headerSize + size;
+
+    if (!_readIndex(filename + ".index"))
+        _scan();
+}
+
+uint64_t JournalReader::getSize() const
+{
+    return _end - headerSize;
+}
+
+bool JournalReader::get(const size_t index, Record& record) const
+{
+    if (index >= _numRecords)
+        return false;
+
+    const uint64_t offset = _getOffset(index);
+    if (offset < headerSize || offset > _end - recordHeaderSize)
+        return false;
+
+    const uint8_t* data = _journal->getData() + offset;
+    const uint64_t size = load(data + 24);
+    if (size > _end - offset - recordHeaderSize)
+        return false;
+
+    record.timestamp = load(data);
+    record.event = uint128_t(load(data + 16), load(data + 8));
+    record.data = data + recordHeaderSize;
+    record.size = size;
+    return true;
+}
+
+size_t JournalReader::find(const uint64_t timestamp) const
+{
+    size_t first = 0;
+    size_t count = _numRecords;
+    while (count > 0)
+    {
+        const size_t step = count / 2;
+        if (_getTimestamp(first + step) < timestamp)
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+            count = step;
+    }
+    return first;
+}
+
+uint64_t JournalReader::_getTimestamp(const size_t index) const
+{
+    return load(_entries + index * entrySize);
+}
+
+uint64_t JournalReader::_getOffset(const size_t index) const
+{
+    return load(_entries + index * entrySize + 8);
+}
+
+bool JournalReader::_readIndex(const std::string& filename)
+{
+    try
+    {
+        _index.reset(new MappedFile(filename, MappedFile::MODE_READ));
+    }
+    catch (const std::runtime_error&)
+    {
+        return false;
+    }
+
+    if (!checkHeader(*_index, indexMagic))
+        return false;
+
+    const uint64_t count = load(_index->getData() + 16);
+    if (count > (_index->getSize() - headerSize) / entrySize)
+        return false;
+
+    _entries = _index->getData() + headerSize;
+    _numRecords = count;
+
+    // consistent if the last indexed record ends the journal
+    if (count == 0)
+        return _end == headerSize;
+
+    Record last;
+    return get(count - 1, last) &&
+           _getOffset(count - 1) + recordHeaderSize + align(last.size) == _end;
+}
+
+void JournalReader::_scan()
+{
+    ZEROEQINFO << "Rebuilding index of " << _journal->getFilename()
+               << std::endl;
+    _index.reset();
+    _scanned.clear();
+
+    const uint8_t* data = _journal->getData();
+    uint64_t offset = headerSize;
+    while (offset + recordHeaderSize <= _end)
+    {
+        const uint64_t size = load(data + offset + 24);
+        if (size > _end - offset - recordHeaderSize)
+            break;
+
+        uint8_t entry[entrySize];
+        store(entry, load(data + offset));
+        store(entry + 8, offset);
+        _scanned.insert(_scanned.end(), entry, entry + entrySize);
+        offset += recordHeaderSize + align(size);
+    }
+
+    _entries = _scanned.data();
+    _numRecords = _scanned.size() / entrySize;
+}
+}
+}
@@ -0,0 +1,108 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include "mappedFile.h"
+
+#include <zeroeq/types.h>
+
+#include <memory>
+#include <vector>
+
+namespace zeroeq
+{
+namespace detail
+{
+/**
+ * A record of an event journal.
+ *
+ * Journals are append-only files of 8-byte aligned records. Each record
+ * consists of the timestamp in microseconds, the event identifier and the
+ * payload size as little endian integers, followed by the payload. A sidecar
+ * index file '<journal>.index' stores the timestamp and offset of each record.
+ */
+struct Record
+{
+    uint64_t timestamp{0};
+    uint128_t event;
+    const void* data{nullptr}; //!< payload, pointing into the mapped journal
+    size_t size{0};
+};
+
+/** Appends records to a new journal and its index. */
+class JournalWriter
+{
+public:
+    /** @throw std::runtime_error if the files cannot be created */
+    explicit JournalWriter(const std::string& filename);
+    ~JournalWriter();
+
+    /** @throw std::runtime_error if the files cannot be grown */
+    void append(uint64_t timestamp, const uint128_t& event, const void* data,
+                size_t size);
+
+    size_t getNumRecords() const { return _numRecords; }
+
+    /**
+     * @return false if the record is out of range. The payload is valid until
+     *         the next append().
+     */
+    bool get(size_t index, Record& record) const;
+
+    /** @return the size of all records in bytes. */
+    uint64_t getSize() const;
+
+    void flush();
+
+private:
+    MappedFile _journal;
+    MappedFile _index;
+    size_t _numRecords{0};
+};
+
+/**
+ * Reads records from a journal.
+ *
+ * Uses the index of the journal if it is consistent with the journal,
+ * otherwise the journal is scanned once on construction.
+ */
+class JournalReader
+{
+public:
+    /** @throw std::runtime_error if the journal cannot be read */
+    explicit JournalReader(const std::string& filename);
+
+    size_t getNumRecords() const { return _numRecords; }
+
+    /** @return the size of all complete records in bytes. */
+    uint64_t getSize() const;
+
+    /** @return false if the record is out of range or corrupt. */
+    bool get(size_t index, Record& record) const;
+
+    /**
+     * @return the index of the first record at or after the timestamp, for
+     *         journals with non-decreasing timestamps.
+     */
+    size_t find(uint64_t timestamp) const;
+
+    /** @return the mapped journal, keeping record payloads valid. */
+    std::shared_ptr<const MappedFile> getFile() const { return _journal; }
+
+private:
+    std::shared_ptr<MappedFile> _journal;
+    std::unique_ptr<MappedFile> _index;
+    const uint8_t* _entries{nullptr}; // mapped or scanned index entries
+    std::vector<uint8_t> _scanned;
+    size_t _numRecords{0};
+    size_t _end{0}; // end of the last complete record in the journal
+
+    uint64_t _getTimestamp(size_t index) const;
+    uint64_t _getOffset(size_t index) const;
+    bool _readIndex(const std::string& filename);
+    void _scan();
+};
+}
+}
@@ -0,0 +1,199 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include "mappedFile.h"
+
+#include "../log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace zeroeq
+{
+namespace detail
+{
+namespace
+{
+const size_t minCapacity = 1 << 16;
+
+std::runtime_error error(const std::string& what, const std::string& filename)
+{
+#ifdef _WIN32
+    return std::runtime_error(what + " '" + filename + "': error " +
+                              std::to_string(::GetLastError()));
+#else
+    return std::runtime_error(what + " '" + filename +
+                              "': " + ::strerror(errno));
+#endif
+}
+}
+
+MappedFile::MappedFile(const std::string& filename, const Mode mode)
+    : _filename(filename)
+    , _mode(mode)
+{
+#ifdef _WIN32
+    _file = ::CreateFileA(filename.c_str(),
+                          mode == MODE_READ ? GENERIC_READ
+                                            : GENERIC_READ | GENERIC_WRITE,
+                          FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                          mode == MODE_READ ? OPEN_EXISTING : CREATE_ALWAYS,
+                          FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (_file == INVALID_HANDLE_VALUE)
+        ZEROEQTHROW(error("Cannot open", filename));
+
+    if (mode == MODE_READ)
+    {
+        LARGE_INTEGER size;
+        if (!::GetFileSizeEx(_file, &size))
+        {
+            ::CloseHandle(_file);
+            ZEROEQTHROW(error("Cannot stat", filename));
+        }
+        _size = size_t(size.QuadPart);
+    }
+#else
+    _fd = ::open(filename.c_str(),
+                 mode == MODE_READ ? O_RDONLY : O_RDWR | O_CREAT | O_TRUNC,
+                 0644);
+    if (_fd == -1)
+        ZEROEQTHROW(error("Cannot open", filename));
+
+    if (mode == MODE_READ)
+    {
+        struct stat info;
+        if (::fstat(_fd, &info) == -1)
+        {
+            ::close(_fd);
+            ZEROEQTHROW(error("Cannot stat", filename));
+        }
+        _size = size_t(info.st_size);
+    }
+#endif
+
+    try
+    {
+        _map(mode == MODE_READ ? _size : minCapacity);
+    }
+    catch (...)
+    {
+#ifdef _WIN32
+        ::CloseHandle(_file);
+#else
+        ::close(_fd);
+#endif
+        throw;
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    _unmap();
+#ifdef _WIN32
+    if (_mode == MODE_WRITE)
+    {
+        LARGE_INTEGER size;
+        size.QuadPart = LONGLONG(_size);
+        ::SetFilePointerEx(_file, size, nullptr, FILE_BEGIN);
+        ::SetEndOfFile(_file);
+    }
+    ::CloseHandle(_file);
+#else
+    if (_mode == MODE_WRITE && ::ftruncate(_fd, off_t(_size)) == -1)
+        ZEROEQWARN << "Cannot truncate '" << _filename
+                   << "': " << ::strerror(errno) << std::endl;
+    ::close(_fd);
+#endif
+}
+
+void MappedFile::resize(const size_t size)
+{
+    if (_mode != MODE_WRITE)
+        ZEROEQTHROW(std::runtime_error("Cannot resize read-only file " +
+                                       _filename));
+
+    if (size > _capacity)
+    {
+        const size_t capacity = std::max(size, 2 * _capacity);
+        _unmap();
+        _map(capacity);
+    }
+    _size = size;
+}
+
+void MappedFile::flush()
+{
+    if (!_data || _mode != MODE_WRITE)
+        return;
+#ifdef _WIN32
+    ::FlushViewOfFile(_data, _size);
+#else
+    ::msync(_data, _size, MS_ASYNC);
+#endif
+}
+
+void MappedFile::_map(const size_t capacity)
+{
+    if (capacity == 0) // empty read-only file, nothing to map
+        return;
+
+#ifdef _WIN32
+    const DWORD protect = _mode == MODE_READ ? PAGE_READONLY : PAGE_READWRITE;
+    _mapping = ::CreateFileMappingA(_file, nullptr, protect,
+                                    DWORD(uint64_t(capacity) >> 32),
+                                    DWORD(capacity & 0xffffffffu), nullptr);
+    if (!_mapping)
+        ZEROEQTHROW(error("Cannot map", _filename));
+
+    void* data =
+        ::MapViewOfFile(_mapping, _mode == MODE_READ ? FILE_MAP_READ
+                                                     : FILE_MAP_WRITE,
+                        0, 0, capacity);
+    if (!data)
+    {
+        ::CloseHandle(_mapping);
+        _mapping = nullptr;
+        ZEROEQTHROW(error("Cannot map", _filename));
+    }
+#else
+    if (_mode == MODE_WRITE && ::ftruncate(_fd, off_t(capacity)) == -1)
+        ZEROEQTHROW(error("Cannot grow", _filename));
+
+    void* data =
+        ::mmap(nullptr, capacity,
+               _mode == MODE_READ ? PROT_READ : PROT_READ | PROT_WRITE,
+               MAP_SHARED, _fd, 0);
+    if (data == MAP_FAILED)
+        ZEROEQTHROW(error("Cannot map", _filename));
+#endif
+    _data = static_cast<uint8_t*>(data);
+    _capacity = capacity;
+}
+
+void MappedFile::_unmap()
+{
+    if (!_data)
+        return;
+#ifdef _WIN32
+    ::UnmapViewOfFile(_data);
+    ::CloseHandle(_mapping);
+    _mapping = nullptr;
+#else
+    ::munmap(_data, _capacity);
+#endif
+    _data = nullptr;
+    _capacity = 0;
+}
+}
+}
@@ -0,0 +1,74 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include <zeroeq/types.h>
+
+#include <string>
+
+namespace zeroeq
+{
+namespace detail
+{
+/**
+ * A memory-mapped file, either read-only or writable and growing on demand.
+ *
+ * A writable file is created or truncated on construction. Its mapping grows
+ * geometrically in resize(), and the file is truncated to the used size on
+ * destruction.
+ */
+class MappedFile
+{
+public:
+    enum Mode
+    {
+        MODE_READ,
+        MODE_WRITE
+    };
+
+    /** @throw std::runtime_error if the file cannot be opened or mapped */
+    MappedFile(const std::string& filename, Mode mode);
+    ~MappedFile();
+
+    uint8_t* getData() { return _data; }
+    const uint8_t* getData() const { return _data; }
+
+    /** @return the used size of the file. */
+    size_t getSize() const { return _size; }
+
+    /**
+     * Set the used size of a writable file, remapping it if needed.
+     *
+     * Invalidates previously returned data pointers when the mapping grows.
+     * @throw std::runtime_error if the file cannot be grown
+     */
+    void resize(size_t size);
+
+    /** Schedule the write-back of modified pages. */
+    void flush();
+
+    const std::string& getFilename() const { return _filename; }
+
+private:
+    const std::string _filename;
+    const Mode _mode;
+#ifdef _WIN32
+    void* _file;
+    void* _mapping{nullptr};
+#else
+    int _fd;
+#endif
+    uint8_t* _data{nullptr};
+    size_t _size{0};
+    size_t _capacity{0};
+
+    void _map(size_t capacity);
+    void _unmap();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+};
+}
+}
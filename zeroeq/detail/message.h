@@ -0,0 +1,124 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include <zmq.h>
+
+#include <deque>
+#include <string>
+
+namespace zeroeq
+{
+namespace detail
+{
+/**
+ * The frames of a multi-part message, received and forwarded without copying.
+ *
+ * Frames are kept in a deque, so their data stays in place when the message is
+ * moved or more frames are received.
+ */
+class Message
+{
+public:
+    Message() {}
+    Message(Message&& from)
+        : _frames(std::move(from._frames))
+    {
+    }
+    ~Message()
+    {
+        for (zmq_msg_t& frame : _frames)
+            zmq_msg_close(&frame);
+    }
+
+    /** @return false if no message was received */
+    bool recv(void* socket, const int flags)
+    {
+        while (true)
+        {
+            _frames.emplace_back(); // deque does not move existing frames
+            zmq_msg_t& frame = _frames.back();
+            zmq_msg_init(&frame);
+            if (zmq_msg_recv(&frame, socket, _frames.size() == 1 ? flags : 0) ==
+                -1)
+            {
+                zmq_msg_close(&frame);
+                _frames.pop_back();
+                return false;
+            }
+            if (!zmq_msg_more(&frame))
+                return true;
+        }
+    }
+
+    /** @return a copy of all frames, sharing the data of large frames. */
+    Message copy()
+    {
+        Message message;
+        for (zmq_msg_t& frame : _frames)
+        {
+            message._frames.emplace_back();
+            zmq_msg_init(&message._frames.back());
+            zmq_msg_copy(&message._frames.back(), &frame);
+        }
+        return message;
+    }
+
+    /** Send the frames starting at the given one. */
+    bool send(void* socket, const size_t first)
+    {
+        return send(socket, first, _frames.size(), 0);
+    }
+
+    /**
+     * Send the frames in [first, last), the last one with the given flags.
+     *
+     * Sent frames are empty afterwards.
+     */
+    bool send(void* socket, const size_t first, const size_t last,
+              const int flags)
+    {
+        for (size_t i = first; i < last; ++i)
+        {
+            if (zmq_msg_send(&_frames[i], socket,
+                             i + 1 < last ? ZMQ_SNDMORE : flags) == -1)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** @return the number of frames. */
+    size_t getNumFrames() const { return _frames.size(); }
+
+    /** @return the data of the given frame. */
+    const void* getData(const size_t index)
+    {
+        return zmq_msg_data(&_frames[index]);
+    }
+
+    /** @return the size of the given frame. */
+    size_t getSize(const size_t index) const
+    {
+        return zmq_msg_size(&_frames[index]);
+    }
+
+    std::string getString(const size_t index)
+    {
+        if (index >= _frames.size())
+            return std::string();
+        return std::string(static_cast<const char*>(getData(index)),
+                           getSize(index));
+    }
+
+private:
+    std::deque<zmq_msg_t> _frames;
+
+    Message(const Message&) = delete;
+    Message& operator=(const Message&) = delete;
+};
+}
+}
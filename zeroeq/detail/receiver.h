@@ -4,117 +4,161 @@
 
 #pragma once
 
+#include "browser.h"
 #include "common.h"
+#include "connections.h"
 #include "constants.h"
 #include "context.h"
+#include "directoryDiscovery.h"
+#include "sender.h"
 #include "socket.h"
+#include "staticDiscovery.h"
 
 #include "../log.h"
 
-#include <servus/listener.h>
 #include <servus/servus.h>
 #include <zmq.h>
 
-#include <algorithm>
-
 namespace zeroeq
 {
 namespace detail
 {
-/** Manages and updates a set of connections with a zeroconf browser. */
-class Receiver : public servus::Listener
+/**
+ * Manages and updates a set of connections with the discovery backends shared
+ * by all receivers of the process: zeroconf, the static list from the
+ * environment and the directory.
+ */
+class Receiver
 {
 public:
     Receiver(const std::string& service, const std::string session)
-        : _servus(session == TEST_SESSION ? session : service)
-        , _session(session)
+        : _session(session)
         , _context(detail::getContext())
     {
         if (session == zeroeq::NULL_SESSION || session.empty())
             ZEROEQTHROW(std::runtime_error(
                 std::string("Invalid session name for browsing")));
 
-        if (!servus::Servus::isAvailable())
+        if (auto backend = StaticDiscovery::get(service))
+            _backends.push_back(backend);
+        if (auto backend = DirectoryDiscovery::get(service))
+            _backends.push_back(backend);
+
+        if (auto backend =
+                Browser::get(session == TEST_SESSION ? session : service))
+        {
+            _backends.push_back(backend);
+        }
+        else if (_backends.empty())
         {
             ZEROEQWARN << "ZeroEQ::Receiver: Cannot browse Zeroconf for "
                           "incoming connections; no implementation provided by "
                           "Servus"
                        << std::endl;
-            return;
         }
 
-        _servus.addListener(this);
-        _servus.beginBrowsing(servus::Servus::IF_ALL);
+        for (const auto& backend : _backends)
+            backend->add(this);
     }
 
-    Receiver(const std::string& service)
-        : _servus(service)
-        , _session(zeroeq::NULL_SESSION)
+    Receiver(const std::string&)
+        : _session(zeroeq::NULL_SESSION)
         , _context(detail::getContext())
     {
     }
 
     virtual ~Receiver()
     {
-        if (_servus.isBrowsing())
-        {
-            _servus.endBrowsing();
-            _servus.addListener(this);
-        }
+        for (const auto& backend : _backends)
+            backend->remove(this);
     }
 
     const std::string& getSession() const { return _session; }
     bool update() //!< @return true if new connection made
     {
-        if (!_servus.isBrowsing())
-            return false;
-
         _updated = false;
-        _servus.browse(0);
+        for (const auto& backend : _backends)
+        {
+            backend->update(this, _changes);
+            for (const Discovery::Instance& instance : _changes)
+            {
+                if (instance.contains(KEY_RELAY))
+                    _relayChanged(instance);
+                else if (instance.added)
+                {
+                    _instances[instance.name] = instance;
+                    if (_relay.empty())
+                        _instanceAdded(instance);
+                }
+                else
+                {
+                    _instances.erase(instance.name);
+                    if (_instanceRemoved(instance.name) && _relay.empty())
+                    {
+                        // connect another instance with the same endpoint
+                        for (const auto& i : _instances)
+                            _instanceAdded(i.second);
+                    }
+                }
+            }
+        }
+        if (_updated)
+            connectionsChanged();
         return _updated;
     }
 
-    void instanceAdded(const std::string& instance) final
+    bool addConnection(const std::string& zmqURI)
     {
-        const std::string& zmqURI = _getZmqURI(instance);
-        if (_sockets.count(zmqURI) > 0) // Already got this instance
-            return;
-
-        const std::string& session = _servus.get(instance, KEY_SESSION);
-        if (_servus.containsKey(instance, KEY_SESSION) && !_session.empty() &&
-            session != _session)
-        {
-            return;
-        }
-
-        const uint128_t identifier(_servus.get(instance, KEY_INSTANCE));
-        zmq::SocketPtr socket = createSocket(identifier);
-        if (socket && _connect(zmqURI, socket))
-            _updated = true;
+        if (_connections.find(zmqURI) || _connections.findURI(zmqURI))
+            return true; // already connected
+        zmq::SocketPtr socket = createSocket(uint128_t());
+        if (!socket)
+            return true;
+        if (!_connect(zmqURI, zmqURI, socket, _connections))
+            return false;
+        connectionsChanged();
+        return true;
     }
 
-    void instanceRemoved(const std::string& instance) final
+    /**
+     * Move the connection to the from URI to the to URI, keeping its key.
+     *
+     * The priority lane of the instance is dropped, since the new upstream
+     * forwards the events of all lanes.
+     * @return false if there is no connection to from, or on error
+     */
+    bool redirect(const std::string& from, const std::string& to)
     {
-        if (_disconnect(_getZmqURI(instance)))
-            _updated = true;
+        const std::string* key = _connections.findURI(from);
+        if (!key || _connections.findURI(to))
+            return false;
+
+        const std::string name = *key;
+        const zmq::SocketPtr socket = _connections.find(name)->socket;
+        _disconnect(name, _lanes);
+        if (!_disconnect(name, _connections) ||
+            !_connect(name, to, socket, _connections))
+        {
+            return false;
+        }
+        connectionsChanged();
+        return true;
     }
 
-    bool addConnection(const std::string& zmqURI)
+    /** @return the URIs of the connections, sorted. */
+    std::vector<std::string> getConnectionURIs() const
     {
-        zmq::SocketPtr socket = createSocket(uint128_t());
-        if (socket)
-            return _connect(zmqURI, socket);
-        return true;
+        return _connections.getURIs();
     }
 
     void addSockets(std::vector<detail::Socket>& entries)
     {
-        entries.insert(entries.end(), _entries.begin(), _entries.end());
+        for (const Connections* connections : {&_connections, &_lanes})
+            entries.insert(entries.end(), connections->getEntries().begin(),
+                           connections->getEntries().end());
     }
 
 protected:
-    using SocketMap = std::map<std::string, zmq::SocketPtr>;
-
     void* getContext() { return _context.get(); }
     /**
      * Create the socket for the given instance, return nullptr if connection is
@@ -122,9 +166,32 @@ protected:
      */
     virtual zmq::SocketPtr createSocket(const uint128_t& instance) = 0;
 
-    const SocketMap& getSockets() { return _sockets; }
-    bool _connect(const std::string& zmqURI, zmq::SocketPtr socket)
+    /**
+     * Create the socket for the high priority lane of the given instance,
+     * return nullptr if the lane is not used.
+     */
+    virtual zmq::SocketPtr createPrioritySocket(const uint128_t&)
     {
+        return {};
+    }
+
+    /** @return false to ignore relays, i.e., to connect to all instances. */
+    virtual bool useRelays() const { return true; }
+
+    /** Called after connections were added, removed or redirected. */
+    virtual void connectionsChanged() {}
+
+    /** Called before the socket is connected to the given URI. */
+    virtual void prepareConnect(void* /*socket*/,
+                                const std::string& /*zmqURI*/)
+    {
+    }
+
+    /** Connect the socket and track it under the given key. */
+    bool _connect(const std::string& key, const std::string& zmqURI,
+                  zmq::SocketPtr socket, Connections& connections)
+    {
+        prepareConnect(socket.get(), zmqURI);
         if (zmq_connect(socket.get(), zmqURI.c_str()) == -1)
         {
             ZEROEQINFO << "Cannot connect to " << zmqURI << ": "
@@ -132,48 +199,165 @@ protected:
             return false;
         }
 
-        _sockets[zmqURI] = socket; // ref socket since zmq struct is void*
-
-        detail::Socket entry;
-        entry.socket = socket.get();
-        entry.events = ZMQ_POLLIN;
-        _entries.push_back(entry);
+        connections.add(key, zmqURI, socket);
         return true;
     }
 
-    bool _disconnect(const std::string& zmqURI)
+    bool _disconnect(const std::string& key, Connections& connections)
     {
-        auto i = _sockets.find(zmqURI);
-        if (i == _sockets.end()) // Don't know this instance
+        const Connections::Connection* connection = connections.find(key);
+        if (!connection) // Don't know this instance
             return false;
 
-        auto socket = i->second;
-        if (zmq_disconnect(socket.get(), zmqURI.c_str()) == -1)
+        if (zmq_disconnect(connection->socket.get(),
+                           connection->zmqURI.c_str()) == -1)
         {
-            ZEROEQINFO << "Cannot disconnect from " << zmqURI << ": "
-                       << zmq_strerror(zmq_errno()) << std::endl;
+            ZEROEQINFO << "Cannot disconnect from " << connection->zmqURI
+                       << ": " << zmq_strerror(zmq_errno()) << std::endl;
         }
-
-        std::remove_if(_entries.begin(), _entries.end(),
-                       [socket](const detail::Socket& candidate) {
-                           return candidate.socket == socket.get();
-                       });
-        _sockets.erase(i);
-        return true;
+        return connections.remove(key);
     }
 
 private:
-    servus::Servus _servus;
+    std::vector<std::shared_ptr<Discovery>> _backends;
+    Discovery::Instances _changes; // reused by update()
     const std::string _session;
 
     zmq::ContextPtr _context;
-    SocketMap _sockets;
-    std::vector<detail::Socket> _entries;
+    Connections _connections; // by instance, or URI if added explicitly
+    Connections _lanes;       // priority lanes by instance
 
     bool _updated{false};
 
+    // Discovered instances, which are not connected while a relay is used
+    std::map<std::string, Discovery::Instance> _instances;
+    std::map<std::string, Discovery::Instance> _relays; // on this node or rack
+    std::string _relay;                                 // used relay, if any
+
+    void _instanceAdded(const Discovery::Instance& instance)
+    {
+        if (_connections.find(instance.name)) // Already got this instance
+            return;
+
+        if (instance.contains(KEY_SESSION) && !_session.empty() &&
+            instance.get(KEY_SESSION) != _session)
+        {
+            return;
+        }
+
+        // The same endpoint may be found by several backends, e.g., as
+        // tcp://host:port statically and as host:port by zeroconf
+        const std::string& zmqURI = _getZmqURI(instance.name);
+        if (_connections.findURI(zmqURI))
+            return;
+
+        const uint128_t identifier(instance.get(KEY_INSTANCE));
+        zmq::SocketPtr socket = createSocket(identifier);
+        if (!socket || !_connect(instance.name, zmqURI, socket, _connections))
+        {
+            return;
+        }
+
+        _updated = true;
+        if (instance.contains(KEY_PRIORITY_PORT))
+            _connectPriorityLane(instance, identifier);
+    }
+
+    /** @return true if the instance was connected. */
+    bool _instanceRemoved(const std::string& instance)
+    {
+        _disconnect(instance, _lanes);
+        if (!_disconnect(instance, _connections))
+            return false;
+        _updated = true;
+        return true;
+    }
+
+    void _relayChanged(const Discovery::Instance& instance)
+    {
+        if (!instance.added)
+            _relays.erase(instance.name);
+        else if (useRelays() && _getLocality(instance) > 0 &&
+                 instance.get(KEY_SESSION) == _session &&
+                 uint128_t(instance.get(KEY_INSTANCE)) != Sender::getUUID())
+        {
+            _relays[instance.name] = instance;
+        }
+        _selectRelay();
+    }
+
+    /** @return 2 for a relay on this node, 1 on this rack, 0 otherwise. */
+    int _getLocality(const Discovery::Instance& relay) const
+    {
+        if (relay.get(KEY_RELAY) == getHostName())
+            return 2;
+        const std::string& rack = getRackName();
+        return !rack.empty() && relay.get(KEY_RACK) == rack ? 1 : 0;
+    }
+
+    /**
+     * Receive from the closest relay, if any, instead of all instances. The
+     * relay forwards the events of all instances, so only one of both is
+     * connected.
+     */
+    void _selectRelay()
+    {
+        std::string relay;
+        int locality = 0;
+        for (const auto& i : _relays)
+        {
+            const int candidate = _getLocality(i.second);
+            if (candidate > locality)
+            {
+                relay = i.first;
+                locality = candidate;
+            }
+        }
+        if (relay == _relay)
+            return;
+
+        if (_relay.empty())
+        {
+            for (const auto& i : _instances)
+                _instanceRemoved(i.first);
+        }
+        else
+            _instanceRemoved(_relay);
+
+        _relay = relay;
+        if (_relay.empty())
+        {
+            ZEROEQINFO << "Receiving directly from publishers" << std::endl;
+            for (const auto& i : _instances)
+                _instanceAdded(i.second);
+        }
+        else
+        {
+            ZEROEQINFO << "Receiving through relay " << _relay << std::endl;
+            _instanceAdded(_relays[_relay]);
+        }
+    }
+
+    void _connectPriorityLane(const Discovery::Instance& instance,
+                              const uint128_t& identifier)
+    {
+        zmq::SocketPtr socket = createPrioritySocket(identifier);
+        if (!socket)
+            return;
+
+        const std::string& host =
+            instance.name.substr(0, instance.name.find(":"));
+        const std::string& port = instance.get(KEY_PRIORITY_PORT);
+        const std::string& laneURI =
+            buildZmqURI(DEFAULT_SCHEMA, host, std::stoi(port));
+        _connect(instance.name, laneURI, socket, _lanes);
+    }
+
     std::string _getZmqURI(const std::string& instance)
     {
+        if (instance.find("://") != std::string::npos) // static discovery
+            return instance;
+
         const size_t pos = instance.find(":");
         const std::string& host = instance.substr(0, pos);
         const std::string& port = instance.substr(pos + 1);
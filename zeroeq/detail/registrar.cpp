@@ -0,0 +1,159 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include "registrar.h"
+
+#include "constants.h"
+
+#include "../client.h"
+#include "../log.h"
+#include "../uri.h"
+
+#include <chrono>
+#include <cstdlib>
+
+namespace zeroeq
+{
+namespace detail
+{
+namespace
+{
+const uint32_t leaseTime = 10;                  // seconds
+const auto renewInterval = std::chrono::seconds(3);
+const uint32_t unregisterTimeout = 1000;        // ms, on shutdown
+
+std::string serialize(const Registration& registration)
+{
+    return registration.getKey() + '\t' +
+           detail::serialize(registration.properties) + '\n';
+}
+}
+
+std::shared_ptr<Registrar> Registrar::get()
+{
+    const char* uri = ::getenv(ENV_DIRECTORY.c_str());
+    if (!uri || std::string(uri).empty())
+        return {};
+
+    static std::map<std::string, std::weak_ptr<Registrar>> registrars;
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::shared_ptr<Registrar> registrar = registrars[uri].lock();
+    if (!registrar)
+    {
+        registrar.reset(new Registrar(uri));
+        registrars[uri] = registrar;
+    }
+    return registrar;
+}
+
+Registrar::Registrar(const std::string& uri)
+    : _thread([this, uri] { _run(uri); })
+{
+}
+
+Registrar::~Registrar()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+    }
+    _condition.notify_all();
+    _thread.join();
+}
+
+void Registrar::add(const Registration& registration)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _registrations[registration.getKey()] = registration;
+        _changed = true;
+    }
+    _condition.notify_all();
+}
+
+void Registrar::remove(const Registration& registration)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_registrations.erase(registration.getKey()) == 0)
+            return;
+        _removed.push_back(registration);
+    }
+    _condition.notify_all();
+}
+
+void Registrar::_run(const std::string& uri)
+{
+    std::unique_ptr<Client> client;
+    try
+    {
+        client.reset(new Client({URI(uri)}));
+    }
+    catch (const std::exception& e)
+    {
+        ZEROEQWARN << "Cannot connect to directory " << uri << ": "
+                   << e.what() << std::endl;
+        return;
+    }
+
+    size_t pending = 0;
+    const auto onReply = [&pending](const uint128_t&, const void*, size_t) {
+        --pending;
+    };
+
+    auto nextRenewal = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+        _condition.wait_until(lock, nextRenewal, [this] {
+            return !_running || _changed || !_removed.empty();
+        });
+
+        std::string unregistration;
+        for (const auto& registration : _removed)
+            unregistration += registration.getKey() + '\n';
+        _removed.clear();
+
+        std::string registration;
+        const bool running = _running;
+        const auto now = std::chrono::steady_clock::now();
+        if (running && (_changed || now >= nextRenewal))
+        {
+            registration = std::to_string(leaseTime) + '\n';
+            for (const auto& i : _registrations)
+                registration += serialize(i.second);
+            _changed = false;
+            nextRenewal = now + renewInterval;
+        }
+        lock.unlock();
+
+        if (!unregistration.empty() &&
+            client->request(DIRECTORY_UNREGISTER, unregistration.data(),
+                            unregistration.size(), onReply))
+        {
+            ++pending;
+        }
+        if (!registration.empty() &&
+            client->request(DIRECTORY_REGISTER, registration.data(),
+                            registration.size(), onReply))
+        {
+            ++pending;
+        }
+
+        if (!running)
+        {
+            // let the directory know before the process is gone
+            while (pending > 0 && client->receive(unregisterTimeout))
+                /* nop */;
+            return;
+        }
+        while (client->receive(0))
+            /* nop */;
+        lock.lock();
+    }
+}
+}
+}
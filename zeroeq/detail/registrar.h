@@ -0,0 +1,53 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include "registration.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace zeroeq
+{
+namespace detail
+{
+/**
+ * Registers all senders of a process with the Directory in ZEROEQ_DIRECTORY.
+ *
+ * A background thread sends all registrations of the process in one request
+ * and renews their lease periodically. Removed registrations are unregistered
+ * right away.
+ */
+class Registrar
+{
+public:
+    /**
+     * @return the registrar of the process, shared as long as it is
+     *         referenced, or nullptr if no directory is configured.
+     */
+    static std::shared_ptr<Registrar> get();
+
+    ~Registrar();
+
+    void add(const Registration& registration);
+    void remove(const Registration& registration);
+
+private:
+    explicit Registrar(const std::string& uri);
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::map<std::string, Registration> _registrations;
+    Registrations _removed;
+    bool _changed{false};
+    bool _running{true};
+    std::thread _thread; // last, started after all members
+
+    void _run(const std::string& uri);
+};
+}
+}
@@ -0,0 +1,89 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace zeroeq
+{
+namespace detail
+{
+/**
+ * An instance of a service registered with a Directory.
+ *
+ * Registrations are serialized as text, one per line:
+ * 'service\\tname\\tkey=value\\tkey=value...'. A registration request starts
+ * with a line containing the lease time in seconds, an unregistration request
+ * only contains 'service\\tname' lines. The Directory stores the properties of
+ * a registration under the key 'service\\tname'.
+ */
+struct Registration
+{
+    using Properties = std::map<std::string, std::string>;
+
+    std::string service;
+    std::string name; //!< host:port
+    Properties properties;
+
+    std::string getKey() const { return service + '\t' + name; }
+};
+using Registrations = std::vector<Registration>;
+
+inline std::string serialize(const Registration::Properties& properties)
+{
+    std::string string;
+    for (const auto& property : properties)
+    {
+        if (property.first.find_first_of("\t\n=") != std::string::npos ||
+            property.second.find_first_of("\t\n") != std::string::npos)
+        {
+            continue;
+        }
+        if (!string.empty())
+            string += '\t';
+        string += property.first + '=' + property.second;
+    }
+    return string;
+}
+
+inline Registration::Properties deserialize(const std::string& string)
+{
+    Registration::Properties properties;
+    size_t begin = 0;
+    while (begin < string.size())
+    {
+        size_t end = string.find('\t', begin);
+        if (end == std::string::npos)
+            end = string.size();
+        const size_t separator = string.find('=', begin);
+        if (separator < end)
+            properties[string.substr(begin, separator - begin)] =
+                string.substr(separator + 1, end - separator - 1);
+        begin = end + 1;
+    }
+    return properties;
+}
+
+/** @return the registration of the given line, or false if malformed. */
+inline bool parse(const std::string& line, Registration& registration)
+{
+    const size_t first = line.find('\t');
+    if (first == std::string::npos || first == 0)
+        return false;
+    const size_t second = line.find('\t', first + 1);
+
+    registration.service = line.substr(0, first);
+    registration.name = line.substr(first + 1, second == std::string::npos
+                                                   ? std::string::npos
+                                                   : second - first - 1);
+    registration.properties =
+        second == std::string::npos ? Registration::Properties()
+                                    : deserialize(line.substr(second + 1));
+    return !registration.name.empty();
+}
+}
+}
@@ -0,0 +1,123 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include "replyCache.h"
+
+#include <cstring>
+#include <iterator>
+
+namespace zeroeq
+{
+namespace detail
+{
+ReplyData ReplyCache::copy(const ReplyData& reply)
+{
+    const size_t size = reply.second.ptr ? reply.second.size : 0;
+    ReplyData result{reply.first, {}};
+    if (size > 0)
+    {
+        std::shared_ptr<uint8_t> data(new uint8_t[size],
+                                      std::default_delete<uint8_t[]>());
+        ::memcpy(data.get(), reply.second.ptr.get(), size);
+        result.second.ptr = data;
+        result.second.size = size;
+    }
+    return result;
+}
+
+const ReplyData* ReplyCache::get(const uint128_t& request,
+                                 const uint128_t& hash, const uint64_t now)
+{
+    const auto i = _index.find(Key(request, hash));
+    if (i == _index.end())
+    {
+        ++_misses;
+        return nullptr;
+    }
+
+    if (now >= i->second->expires)
+    {
+        _erase(i->second);
+        ++_misses;
+        return nullptr;
+    }
+
+    _entries.splice(_entries.begin(), _entries, i->second);
+    ++_hits;
+    return &_entries.front().reply;
+}
+
+const ReplyData* ReplyCache::put(const uint128_t& request,
+                                 const uint128_t& hash, const ReplyData& reply,
+                                 const uint64_t expires)
+{
+    const size_t size = _getSize(reply);
+    if (size > _maxSize)
+        return nullptr;
+
+    invalidate(request, hash);
+
+    _entries.push_front(Entry{Key(request, hash), copy(reply), expires});
+    _index[_entries.front().key] = _entries.begin();
+    _size += size;
+    _evict();
+    return &_entries.front().reply;
+}
+
+void ReplyCache::invalidate(const uint128_t& request)
+{
+    for (auto i = _entries.begin(); i != _entries.end();)
+    {
+        auto entry = i++;
+        if (entry->key.first == request)
+            _erase(entry);
+    }
+}
+
+void ReplyCache::invalidate(const uint128_t& request, const uint128_t& hash)
+{
+    const auto i = _index.find(Key(request, hash));
+    if (i != _index.end())
+        _erase(i->second);
+}
+
+void ReplyCache::clear()
+{
+    _entries.clear();
+    _index.clear();
+    _size = 0;
+}
+
+void ReplyCache::setMaxSize(const size_t bytes)
+{
+    _maxSize = bytes;
+    _evict();
+}
+
+size_t ReplyCache::_getSize(const ReplyData& reply)
+{
+    // list node, index node and bucket, so empty replies are bounded too
+    const size_t overhead =
+        sizeof(Entry) + sizeof(Key) + sizeof(Entries::iterator) +
+        4 * sizeof(void*);
+    return overhead + (reply.second.ptr ? reply.second.size : 0);
+}
+
+void ReplyCache::_erase(const Entries::iterator entry)
+{
+    _size -= _getSize(entry->reply);
+    _index.erase(entry->key);
+    _entries.erase(entry);
+}
+
+void ReplyCache::_evict()
+{
+    while (_size > _maxSize)
+    {
+        _erase(std::prev(_entries.end()));
+        ++_evictions;
+    }
+}
+}
+}
@@ -0,0 +1,89 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include <zeroeq/types.h>
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+namespace zeroeq
+{
+namespace detail
+{
+/**
+ * Least recently used cache of server replies, bounded by the size of the
+ * reply payloads plus a fixed overhead per entry.
+ *
+ * Entries are keyed by request ID and payload hash, and expire after an
+ * optional time to live. The cached payloads are owned by the cache and may
+ * be sent without copying while they are referenced.
+ */
+class ReplyCache
+{
+public:
+    using Key = std::pair<uint128_t, uint128_t>; // request ID, payload hash
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const
+        {
+            return key.first.low() ^ key.second.low();
+        }
+    };
+
+    /** @return a copy of the reply owning its data. */
+    static ReplyData copy(const ReplyData& reply);
+
+    /** @return the reply for the request, or nullptr on a miss. */
+    const ReplyData* get(const uint128_t& request, const uint128_t& hash,
+                         uint64_t now);
+
+    /**
+     * Copy the reply into the cache, evicting the least recently used.
+     * @return the cached reply, or nullptr if it is too large
+     */
+    const ReplyData* put(const uint128_t& request, const uint128_t& hash,
+                         const ReplyData& reply, uint64_t expires);
+
+    /** Remove the replies of the given request, or all replies. */
+    void invalidate(const uint128_t& request);
+    void invalidate(const uint128_t& request, const uint128_t& hash);
+    void clear();
+
+    void setMaxSize(size_t bytes);
+    size_t getMaxSize() const { return _maxSize; }
+    size_t getSize() const { return _size; }
+    size_t getNumEntries() const { return _entries.size(); }
+
+    uint64_t getNumHits() const { return _hits; }
+    uint64_t getNumMisses() const { return _misses; }
+    uint64_t getNumEvictions() const { return _evictions; }
+
+private:
+    struct Entry
+    {
+        Key key;
+        ReplyData reply;
+        uint64_t expires;
+    };
+    using Entries = std::list<Entry>; // most recently used first
+
+    Entries _entries;
+    std::unordered_map<Key, Entries::iterator, KeyHash> _index;
+    size_t _maxSize{64 * 1024 * 1024};
+    size_t _size{0};
+
+    uint64_t _hits{0};
+    uint64_t _misses{0};
+    uint64_t _evictions{0};
+
+    /** @return the accounted size of an entry with the given reply. */
+    static size_t _getSize(const ReplyData& reply);
+    void _erase(Entries::iterator entry);
+    void _evict();
+};
+}
+}
@@ -9,6 +9,7 @@
 #include "common.h"
 #include "constants.h"
 #include "context.h"
+#include "registrar.h"
 #include "socket.h"
 
 #include <zmq.h>
@@ -36,6 +37,7 @@ Sender::Sender(const URI& uri_, const int type, const std::string service,
     , uri(uri_)
     , socket(zmq_socket(_context.get(), type), [](void* s) { ::zmq_close(s); })
     , _service(session == TEST_SESSION ? session : service)
+    , _serviceName(service)
     , _session(session)
 {
     const int hwm = 0;
@@ -44,6 +46,8 @@ Sender::Sender(const URI& uri_, const int type, const std::string service,
 
 Sender::~Sender()
 {
+    if (_registrar)
+        _registrar->remove(Registration{_serviceName, getAddress(), {}});
     socket.reset();
 }
 
@@ -66,7 +70,7 @@ void Sender::initURI()
         return;
 
     std::string hostStr, portStr;
-    _getEndPoint(hostStr, portStr);
+    _getEndPoint(socket.get(), hostStr, portStr);
 
     if (port == 0)
     {
@@ -83,24 +87,31 @@ void Sender::initURI()
 
 void Sender::announce()
 {
+    addProperty("Type", "ZeroEQ");
+    addProperty(KEY_INSTANCE, getUUID().getString());
+    addProperty(KEY_USER, getUserName());
+    addProperty(KEY_APPLICATION, getApplicationName());
+    if (!_session.empty())
+        addProperty(KEY_SESSION, _session);
+
+    _registrar = Registrar::get();
+    if (_registrar)
+        _registrar->add(Registration{_serviceName, getAddress(), _properties});
+
     if (!servus::Servus::isAvailable())
     {
-        ZEROEQWARN << "ZeroEQ::Sender: Cannot announce on Zeroconf; no "
-                      "implementation provided by Servus"
-                   << std::endl;
+        if (!_registrar)
+            ZEROEQWARN << "ZeroEQ::Sender: Cannot announce on Zeroconf; no "
+                          "implementation provided by Servus"
+                       << std::endl;
         return;
     }
 
-    _service.set("Type", "ZeroEQ");
-    _service.set(KEY_INSTANCE, getUUID().getString());
-    _service.set(KEY_USER, getUserName());
-    _service.set(KEY_APPLICATION, getApplicationName());
-    if (!_session.empty())
-        _service.set(KEY_SESSION, _session);
-
     const auto& result = _service.announce(uri.getPort(), getAddress());
     if (result == servus::Servus::Result::NOT_SUPPORTED)
     {
+        if (_registrar)
+            return;
         ZEROEQWARN << "ZeroEQ::Sender: Cannot announce on Zeroconf; no "
                       "implementation provided by Servus"
                    << std::endl;
@@ -111,6 +122,19 @@ void Sender::announce()
                                        result.getString()));
 }
 
+void Sender::addProperty(const std::string& key, const std::string& value)
+{
+    _service.set(key, value);
+    _properties[key] = value;
+}
+
+uint16_t Sender::getBoundPort(void* socket_) const
+{
+    std::string host, port;
+    _getEndPoint(socket_, host, port);
+    return std::stoi(port);
+}
+
 void Sender::addSockets(std::vector<zeroeq::detail::Socket>& entries)
 {
     zeroeq::detail::Socket entry;
@@ -119,11 +143,12 @@ void Sender::addSockets(std::vector<zeroeq::detail::Socket>& entries)
     entries.push_back(entry);
 }
 
-void Sender::_getEndPoint(std::string& host, std::string& port) const
+void Sender::_getEndPoint(void* socket_, std::string& host,
+                          std::string& port) const
 {
     char buffer[1024];
     size_t size = sizeof(buffer);
-    if (zmq_getsockopt(socket.get(), ZMQ_LAST_ENDPOINT, &buffer, &size) == -1)
+    if (zmq_getsockopt(socket_, ZMQ_LAST_ENDPOINT, &buffer, &size) == -1)
     {
         ZEROEQTHROW(std::runtime_error("Cannot determine port of publisher"));
     }
@@ -11,10 +11,15 @@
 
 #include <servus/servus.h> // member
 
+#include <map>
+#include <memory>
+
 namespace zeroeq
 {
 namespace detail
 {
+class Registrar;
+
 class Sender
 {
     zmq::ContextPtr _context; // must be private before socket
@@ -29,6 +34,16 @@ public:
 
     void initURI();
     ZEROEQ_API void announce();
+
+    /**
+     * Add a key-value pair to the zeroconf record and directory registration,
+     * call before announce().
+     */
+    void addProperty(const std::string& key, const std::string& value);
+
+    /** @return the port the given bound socket is listening on. */
+    uint16_t getBoundPort(void* socket_) const;
+
     void addSockets(std::vector<zeroeq::detail::Socket>& entries);
 
     const std::string& getSession() const { return _session; }
@@ -38,11 +53,15 @@ public:
     zmq::SocketPtr socket;
 
 private:
-    void _getEndPoint(std::string& host, std::string& port) const;
+    void _getEndPoint(void* socket_, std::string& host,
+                      std::string& port) const;
     void* _createContext(void* context);
 
     servus::Servus _service;
+    const std::string _serviceName;
     const std::string _session;
+    std::map<std::string, std::string> _properties;
+    std::shared_ptr<Registrar> _registrar; // if a directory is used
 };
 }
 }
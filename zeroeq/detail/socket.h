@@ -12,6 +12,31 @@ namespace zeroeq
 {
 namespace detail
 {
+/**
+ * XPUB option to pass the subscriptions of all subscribers, not only the first
+ * one of each topic. Before ZeroMQ 4.2, only the last unsubscription of a topic
+ * is passed, so subscribers can not be counted.
+ */
+#ifdef ZMQ_XPUB_VERBOSER
+const int XPUB_VERBOSE_OPTION = ZMQ_XPUB_VERBOSER;
+const bool XPUB_COUNTS_SUBSCRIBERS = true;
+#else
+const int XPUB_VERBOSE_OPTION = ZMQ_XPUB_VERBOSE;
+const bool XPUB_COUNTS_SUBSCRIBERS = false;
+#endif
+
+/**
+ * ROUTER option to set the routing id of the next connected peer, used to
+ * address servers by their URI. Renamed in ZeroMQ 4.3.
+ */
+#if defined(ZMQ_CONNECT_ROUTING_ID)
+const int CONNECT_ROUTING_ID_OPTION = ZMQ_CONNECT_ROUTING_ID;
+#elif defined(ZMQ_CONNECT_RID)
+const int CONNECT_ROUTING_ID_OPTION = ZMQ_CONNECT_RID;
+#else
+#error "ZeroEQ needs ZeroMQ 4.1 or later for ZMQ_CONNECT_RID"
+#endif
+
 /**
  * Wrapper to hide zmq_pollitem_t from the API (it's a typedef which can't be
  * forward declared)
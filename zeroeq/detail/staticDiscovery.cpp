@@ -0,0 +1,122 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include "staticDiscovery.h"
+
+#include "common.h"
+
+#include <fstream>
+
+namespace zeroeq
+{
+namespace detail
+{
+namespace
+{
+const auto checkInterval = std::chrono::milliseconds(500);
+
+std::string getEnv(const std::string& name)
+{
+    const char* value = ::getenv(name.c_str());
+    return value ? value : std::string();
+}
+
+std::string trim(const std::string& string)
+{
+    const size_t first = string.find_first_not_of(" \t\r");
+    if (first == std::string::npos)
+        return std::string();
+    return string.substr(first, string.find_last_not_of(" \t\r") - first + 1);
+}
+
+void addURI(const std::string& entry, std::set<std::string>& uris)
+{
+    const std::string& uri = trim(entry);
+    if (uri.empty() || uri[0] == '#')
+        return;
+
+    try
+    {
+        uris.insert(buildZmqURI(URI(uri)));
+    }
+    catch (const std::exception& e)
+    {
+        ZEROEQWARN << "Ignoring invalid URI '" << uri << "': " << e.what()
+                   << std::endl;
+    }
+}
+}
+
+std::shared_ptr<StaticDiscovery> StaticDiscovery::get(
+    const std::string& service)
+{
+    std::string list, filename;
+    if (service == PUBLISHER_SERVICE)
+    {
+        list = getEnv(ENV_PUBLISHERS);
+        filename = getEnv(ENV_PUBLISHERS_FILE);
+    }
+    else if (service == SERVER_SERVICE)
+    {
+        list = getEnv(ENV_SERVERS);
+        filename = getEnv(ENV_SERVERS_FILE);
+    }
+
+    if (list.empty() && filename.empty())
+        return {};
+    return getShared<StaticDiscovery>(list + '\n' + filename);
+}
+
+StaticDiscovery::StaticDiscovery(const std::string& key)
+    : _filename(key.substr(key.find('\n') + 1))
+    , _nextCheck(std::chrono::steady_clock::now() + checkInterval)
+{
+    std::string list = key.substr(0, key.find('\n'));
+    while (!list.empty())
+    {
+        const size_t pos = list.find(',');
+        addURI(list.substr(0, pos), _listed);
+        list = pos == std::string::npos ? std::string() : list.substr(pos + 1);
+    }
+    _fromFile = _readFile();
+}
+
+void StaticDiscovery::_update()
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (_filename.empty() || now < _nextCheck)
+        return;
+    _nextCheck = now + checkInterval;
+
+    const URISet uris = _readFile();
+    for (const auto& uri : _fromFile)
+        if (uris.count(uri) == 0 && _listed.count(uri) == 0)
+            _push(Instance{uri, {}, false});
+    for (const auto& uri : uris)
+        if (_fromFile.count(uri) == 0 && _listed.count(uri) == 0)
+            _push(Instance{uri, {}, true});
+    _fromFile = uris;
+}
+
+void StaticDiscovery::_getInstances(Instances& instances) const
+{
+    for (const URISet* uris : {&_listed, &_fromFile})
+        for (const auto& uri : *uris)
+            instances.push_back(Instance{uri, {}, true});
+}
+
+StaticDiscovery::URISet StaticDiscovery::_readFile() const
+{
+    URISet uris;
+    if (_filename.empty())
+        return uris;
+
+    std::ifstream file(_filename);
+    std::string line;
+    while (std::getline(file, line))
+        addURI(line, uris);
+    return uris;
+}
+}
+}
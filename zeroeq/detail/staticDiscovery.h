@@ -0,0 +1,51 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include "discovery.h"
+
+#include <zeroeq/types.h>
+
+#include <chrono>
+#include <set>
+
+namespace zeroeq
+{
+namespace detail
+{
+/**
+ * Discovery of a fixed set of instances given by the environment.
+ *
+ * Publishers are listed in ZEROEQ_PUBLISHERS and servers in ZEROEQ_SERVERS as
+ * comma-separated URIs. ZEROEQ_PUBLISHERS_FILE and ZEROEQ_SERVERS_FILE name a
+ * file with one URI per line, which is watched for changes. Empty lines and
+ * lines starting with '#' are ignored.
+ */
+class StaticDiscovery : public Discovery
+{
+public:
+    /**
+     * @return the static discovery of the given service, shared as long as it
+     *         is referenced, or nullptr if no instances are configured.
+     */
+    static std::shared_ptr<StaticDiscovery> get(const std::string& service);
+
+private:
+    friend class Discovery; // getShared()
+    using URISet = std::set<std::string>;
+
+    explicit StaticDiscovery(const std::string& key);
+
+    URISet _listed;   // from the environment variable
+    URISet _fromFile; // from the watched file
+    std::string _filename;
+    std::chrono::steady_clock::time_point _nextCheck;
+
+    void _update() final;
+    void _getInstances(Instances& instances) const final;
+    URISet _readFile() const;
+};
+}
+}
@@ -0,0 +1,194 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include "directory.h"
+
+#include "publisher.h"
+#include "server.h"
+#include "stateStore.h"
+#include "uri.h"
+
+#include "detail/constants.h"
+#include "detail/registration.h"
+#include "log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+namespace zeroeq
+{
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+URI getPublisherURI(URI uri)
+{
+    uri.setPort(0);
+    return uri;
+}
+
+ReplyData makeReply(const uint128_t& type, const std::string& string)
+{
+    auto data = std::make_shared<std::string>(string);
+    servus::Serializable::Data reply;
+    reply.ptr = std::shared_ptr<const void>(data, data->data());
+    reply.size = data->size();
+    return ReplyData{type, reply};
+}
+}
+
+class Directory::Impl
+{
+public:
+    explicit Impl(const URI& uri)
+        : _server(uri, NULL_SESSION)
+        , _publisher(getPublisherURI(uri), NULL_SESSION)
+        , _store(DIRECTORY_STORE, _publisher, _server)
+    {
+        _server.handle(DIRECTORY_REGISTER, [this](const void* data,
+                                                  const size_t size) {
+            return makeReply(DIRECTORY_REGISTER,
+                             std::to_string(_register(data, size)));
+        });
+        _server.handle(DIRECTORY_UNREGISTER, [this](const void* data,
+                                                    const size_t size) {
+            return makeReply(DIRECTORY_UNREGISTER,
+                             std::to_string(_unregister(data, size)));
+        });
+        _server.handle(DIRECTORY_INFO, [this](const void*, size_t) {
+            return makeReply(DIRECTORY_INFO,
+                             std::to_string(_publisher.getURI()));
+        });
+    }
+
+    ~Impl()
+    {
+        _server.remove(DIRECTORY_REGISTER);
+        _server.remove(DIRECTORY_UNREGISTER);
+        _server.remove(DIRECTORY_INFO);
+    }
+
+    bool receive(const uint32_t timeout)
+    {
+        uint32_t wait = timeout;
+        if (!_leases.empty())
+        {
+            const auto next = std::min_element(_leases.begin(), _leases.end(),
+                                               [](const Leases::value_type& a,
+                                                  const Leases::value_type& b) {
+                                                   return a.second < b.second;
+                                               });
+            const auto due = std::chrono::duration_cast<
+                                 std::chrono::milliseconds>(next->second -
+                                                            Clock::now())
+                                 .count();
+            wait = std::min<int64_t>(timeout, std::max<int64_t>(due, 0));
+        }
+
+        const bool handled = _server.receive(wait);
+        _expire();
+        return handled;
+    }
+
+    const URI& getURI() const { return _server.getURI(); }
+    size_t getNumRegistrations() const { return _leases.size(); }
+
+private:
+    using Leases = std::map<std::string, Clock::time_point>;
+
+    Server _server;
+    Publisher _publisher;
+    StateStore _store;
+    Leases _leases;
+
+    size_t _register(const void* data, const size_t size)
+    {
+        std::istringstream request(
+            std::string(static_cast<const char*>(data), size));
+        uint32_t lease = 0;
+        std::string line;
+        if (!(request >> lease) || !std::getline(request, line) || lease == 0)
+            return 0;
+
+        const auto expiry = Clock::now() + std::chrono::seconds(lease);
+        size_t accepted = 0;
+        while (std::getline(request, line))
+        {
+            detail::Registration registration;
+            if (!detail::parse(line, registration))
+                continue;
+
+            const std::string& key = registration.getKey();
+            const std::string& value =
+                detail::serialize(registration.properties);
+            const auto current = _store.get(key);
+            if (!current || *current != value)
+                _store.set(key, value);
+            _leases[key] = expiry;
+            ++accepted;
+        }
+        return accepted;
+    }
+
+    size_t _unregister(const void* data, const size_t size)
+    {
+        std::istringstream request(
+            std::string(static_cast<const char*>(data), size));
+        size_t removed = 0;
+        std::string line;
+        while (std::getline(request, line))
+        {
+            detail::Registration registration;
+            if (detail::parse(line, registration) &&
+                _leases.erase(registration.getKey()) > 0)
+            {
+                _store.erase(registration.getKey());
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
+    void _expire()
+    {
+        const auto now = Clock::now();
+        for (auto i = _leases.begin(); i != _leases.end();)
+        {
+            if (i->second > now)
+            {
+                ++i;
+                continue;
+            }
+            ZEROEQINFO << "Lease of " << i->first << " expired" << std::endl;
+            _store.erase(i->first);
+            i = _leases.erase(i);
+        }
+    }
+};
+
+Directory::Directory(const URI& uri)
+    : _impl(new Impl(uri))
+{
+}
+
+Directory::~Directory()
+{
+}
+
+const URI& Directory::getURI() const
+{
+    return _impl->getURI();
+}
+
+bool Directory::receive(const uint32_t timeout)
+{
+    return _impl->receive(timeout);
+}
+
+size_t Directory::getNumRegistrations() const
+{
+    return _impl->getNumRegistrations();
+}
+}
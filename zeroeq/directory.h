@@ -0,0 +1,71 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include <zeroeq/api.h>
+#include <zeroeq/types.h>
+#include <zeroeq/uri.h> // default argument
+
+#include <memory>
+
+namespace zeroeq
+{
+/**
+ * Rendezvous directory of publishers and servers, replacing zeroconf where
+ * multicast is not available.
+ *
+ * Publishers and servers register their address, session and instance with a
+ * lease and renew it periodically, all instances of a process in one request.
+ * Subscribers and clients get a snapshot of the directory, followed by a
+ * stream of changes, using a replicated StateStore. Registrations which are
+ * not renewed expire.
+ *
+ * Setting ZEROEQ_DIRECTORY to the URI of a directory enables it for all
+ * publishers, servers, subscribers and clients of a process. The zeroeqDirectory
+ * application runs a directory.
+ *
+ * Not thread safe.
+ *
+ * Example: @include tests/directory.cpp
+ */
+class Directory
+{
+public:
+    /**
+     * Create a new directory.
+     *
+     * @param uri the URI of the directory requests, in the format
+     *            [*|host|IP|IF][:port]. The change stream is published on a
+     *            random port of the same host.
+     * @throw std::runtime_error if socket setup fails
+     */
+    ZEROEQ_API explicit Directory(const URI& uri = URI());
+
+    /** Destroy this directory. */
+    ZEROEQ_API ~Directory();
+
+    /** @return the URI to set in ZEROEQ_DIRECTORY. */
+    ZEROEQ_API const URI& getURI() const;
+
+    /**
+     * Serve registrations and expire leases.
+     *
+     * @param timeout timeout in ms for poll, default blocking poll until at
+     *                least one request has been handled
+     * @return true if at least one request was handled
+     */
+    ZEROEQ_API bool receive(uint32_t timeout = TIMEOUT_INDEFINITE);
+
+    /** @return the number of current registrations. */
+    ZEROEQ_API size_t getNumRegistrations() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> _impl;
+
+    Directory(const Directory&) = delete;
+    Directory& operator=(const Directory&) = delete;
+};
+}
@@ -0,0 +1,475 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include "loadBalancer.h"
+
+#include "detail/common.h"
+#include "detail/message.h"
+#include "detail/receiver.h"
+#include "detail/sender.h"
+#include "detail/socket.h"
+#include "log.h"
+
+#include <zmq.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace zeroeq
+{
+namespace
+{
+uint64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * @return the envelope of a request or reply, the frames from the given one
+ *         up to the empty delimiter, identifying the client and its request.
+ */
+std::string getEnvelope(detail::Message& message, const size_t first)
+{
+    std::string envelope;
+    for (size_t i = first;
+         i < message.getNumFrames() && message.getSize(i) > 0; ++i)
+    {
+        const uint64_t size = message.getSize(i);
+        envelope.append(reinterpret_cast<const char*>(&size), sizeof(size));
+        envelope.append(static_cast<const char*>(message.getData(i)), size);
+    }
+    return envelope;
+}
+}
+
+class LoadBalancer::Impl : public detail::Receiver
+{
+public:
+    Impl(const URI& uri, const std::string& session)
+        : detail::Receiver(SERVER_SERVICE, session == DEFAULT_SESSION
+                                               ? getDefaultRepSession()
+                                               : session)
+        , _frontend(uri, ZMQ_ROUTER)
+        , _backend(zmq_socket(getContext(), ZMQ_ROUTER),
+                   [](void* s) { ::zmq_close(s); })
+    {
+        _init();
+        update();
+    }
+
+    Impl(const URIs& servers, const URI& uri)
+        : detail::Receiver(SERVER_SERVICE)
+        , _frontend(uri, ZMQ_ROUTER)
+        , _backend(zmq_socket(getContext(), ZMQ_ROUTER),
+                   [](void* s) { ::zmq_close(s); })
+    {
+        _init();
+        for (const URI& server : servers)
+        {
+            if (!server.isFullyQualified())
+                ZEROEQTHROW(std::runtime_error(std::string(
+                    "Non-fully qualified URI used for load balancer")));
+
+            const std::string& zmqURI = buildZmqURI(server);
+            if (!addConnection(zmqURI))
+                ZEROEQTHROW(std::runtime_error(
+                    "Cannot connect load balancer to " + zmqURI + ": " +
+                    zmq_strerror(zmq_errno())));
+        }
+    }
+
+    void addSockets(std::vector<detail::Socket>& entries)
+    {
+        for (void* socket : {_frontend.socket.get(), _backend.get()})
+        {
+            detail::Socket entry;
+            entry.socket = socket;
+            entry.events = ZMQ_POLLIN;
+            entries.push_back(entry);
+        }
+    }
+
+    bool process(detail::Socket& socket)
+    {
+        if (socket.socket == _backend.get())
+            return _forwardReplies() > 0;
+
+        while (true)
+        {
+            detail::Message request;
+            if (!request.recv(_frontend.socket.get(), ZMQ_DONTWAIT))
+                break;
+            _queue.push_back(Request{std::move(request), false});
+        }
+        _dispatch();
+        return false;
+    }
+
+    void update()
+    {
+        detail::Receiver::update();
+        for (auto& i : _workers) // retry servers which were not connected yet
+            i.second.reachable = true;
+        _dispatch();
+    }
+
+    const URI& getURI() const { return _frontend.uri; }
+
+    void setMaxQueueDepth(const size_t depth)
+    {
+        _maxQueueDepth = std::max(depth, size_t(1));
+        _dispatch();
+    }
+
+    size_t getMaxQueueDepth() const { return _maxQueueDepth; }
+    size_t getQueueSize() const { return _queue.size(); }
+
+    std::vector<Stats> getStats() const
+    {
+        std::vector<Stats> stats;
+        for (const auto& i : _workers)
+            stats.push_back(i.second.stats);
+        return stats;
+    }
+
+    // All servers are connected on one socket, addressed by their URI
+    zmq::SocketPtr createSocket(const uint128_t&) final { return _backend; }
+
+    void prepareConnect(void* socket, const std::string& zmqURI) final
+    {
+        if (zmq_setsockopt(socket, detail::CONNECT_ROUTING_ID_OPTION,
+                           zmqURI.data(), zmqURI.size()) == -1)
+        {
+            ZEROEQTHROW(std::runtime_error(
+                "Cannot set routing id of server " + zmqURI + ": " +
+                zmq_strerror(zmq_errno())));
+        }
+    }
+
+    void connectionsChanged() final
+    {
+        const std::vector<std::string>& uris = getConnectionURIs();
+        for (const auto& uri : uris)
+            _workers[uri].stats.uri = uri;
+
+        for (auto i = _workers.begin(); i != _workers.end();)
+        {
+            if (std::binary_search(uris.begin(), uris.end(), i->first))
+            {
+                ++i;
+                continue;
+            }
+
+            _recover(i->first, i->second);
+            i = _workers.erase(i);
+        }
+        _dispatch();
+    }
+
+private:
+    struct Request
+    {
+        detail::Message message;
+        bool retried; // lost once on a removed server
+    };
+
+    struct Dispatched
+    {
+        uint64_t time;
+        Request request; // kept to recover from a removed server
+    };
+
+    struct Worker
+    {
+        Stats stats;
+        // outstanding requests, by envelope
+        std::unordered_multimap<std::string, Dispatched> dispatched;
+        uint64_t totalLatency{0};
+        bool reachable{true}; // false until connected
+    };
+
+    detail::Sender _frontend;
+    zmq::SocketPtr _backend;
+    std::map<std::string, Worker> _workers; // by URI, the routing id
+    std::deque<Request> _queue;             // requests waiting for a server
+    size_t _maxQueueDepth{1};
+
+    void _init()
+    {
+        const int on = 1; // report unconnected servers instead of dropping
+        zmq_setsockopt(_backend.get(), ZMQ_ROUTER_MANDATORY, &on, sizeof(on));
+        const int hwm = 0;
+        zmq_setsockopt(_backend.get(), ZMQ_SNDHWM, &hwm, sizeof(hwm));
+        zmq_setsockopt(_backend.get(), ZMQ_RCVHWM, &hwm, sizeof(hwm));
+
+        const std::string& zmqURI = buildZmqURI(_frontend.uri);
+        if (zmq_bind(_frontend.socket.get(), zmqURI.c_str()) == -1)
+            ZEROEQTHROW(std::runtime_error(
+                std::string("Cannot bind load balancer socket '") + zmqURI +
+                "': " + zmq_strerror(zmq_errno())));
+        _frontend.initURI();
+    }
+
+    /** @return the ready server with the fewest outstanding requests. */
+    Worker* _selectWorker()
+    {
+        Worker* best = nullptr;
+        for (auto& i : _workers)
+        {
+            Worker& worker = i.second;
+            if (!worker.reachable || worker.dispatched.size() >= _maxQueueDepth)
+                continue;
+
+            if (!best || worker.dispatched.size() < best->dispatched.size() ||
+                (worker.dispatched.size() == best->dispatched.size() &&
+                 worker.stats.latency < best->stats.latency))
+            {
+                best = &worker;
+            }
+        }
+        return best;
+    }
+
+    void _dispatch()
+    {
+        while (!_queue.empty())
+        {
+            Worker* worker = _selectWorker();
+            if (!worker)
+                return;
+
+            const std::string& uri = worker->stats.uri;
+            if (zmq_send(_backend.get(), uri.data(), uri.size(),
+                         ZMQ_SNDMORE) == -1)
+            {
+                if (zmq_errno() == EHOSTUNREACH)
+                {
+                    worker->reachable = false;
+                    continue;
+                }
+                ZEROEQWARN << "Cannot dispatch request: "
+                           << zmq_strerror(zmq_errno()) << std::endl;
+                return;
+            }
+
+            Request& request = _queue.front();
+            std::string envelope = getEnvelope(request.message, 0);
+            Request kept{request.message.copy(), request.retried};
+            if (!request.message.send(_backend.get(), 0))
+                ZEROEQWARN << "Cannot dispatch request: "
+                           << zmq_strerror(zmq_errno()) << std::endl;
+            _queue.pop_front();
+
+            worker->dispatched.emplace(std::move(envelope),
+                                       Dispatched{now(), std::move(kept)});
+            worker->stats.queueDepth = worker->dispatched.size();
+            ++worker->stats.requests;
+        }
+    }
+
+    /**
+     * Dispatch the outstanding requests of a removed server again, in their
+     * original order before all waiting requests. Requests lost a second time
+     * are failed instead, since they may take down every server.
+     */
+    void _recover(const std::string& uri, Worker& worker)
+    {
+        if (worker.dispatched.empty())
+            return;
+
+        std::vector<Dispatched*> lost;
+        for (auto& i : worker.dispatched)
+            lost.push_back(&i.second);
+        std::sort(lost.begin(), lost.end(),
+                  [](const Dispatched* a, const Dispatched* b) {
+                      return a->time > b->time;
+                  });
+
+        size_t failed = 0;
+        for (Dispatched* dispatched : lost) // newest first
+        {
+            Request& request = dispatched->request;
+            if (request.retried)
+            {
+                _fail(request.message);
+                ++failed;
+                continue;
+            }
+            request.retried = true;
+            _queue.push_front(std::move(request));
+        }
+        ZEROEQWARN << "Lost " << lost.size() << " requests on server " << uri
+                   << ", failed " << failed << " of them and dispatching the "
+                   << "others again" << std::endl;
+    }
+
+    /** Reply to a request with a zero reply ID, like an unhandled request. */
+    void _fail(detail::Message& request)
+    {
+        // [client][request id][empty][request...]
+        size_t delimiter = 0;
+        while (delimiter < request.getNumFrames() &&
+               request.getSize(delimiter) > 0)
+        {
+            ++delimiter;
+        }
+
+        const uint128_t replyID = uint128_t();
+        if (delimiter == request.getNumFrames() ||
+            !request.send(_frontend.socket.get(), 0, delimiter + 1,
+                          ZMQ_SNDMORE) ||
+            zmq_send(_frontend.socket.get(), &replyID, sizeof(replyID), 0) ==
+                -1)
+        {
+            ZEROEQWARN << "Cannot fail lost request: "
+                       << zmq_strerror(zmq_errno()) << std::endl;
+        }
+    }
+
+    /**
+     * Account the reply to the request with the given envelope.
+     * @return false if the request is not outstanding on the worker.
+     */
+    bool _complete(Worker& worker, const std::string& envelope)
+    {
+        const auto i = worker.dispatched.find(envelope);
+        if (i == worker.dispatched.end()) // server was removed and re-added
+            return false;
+
+        const uint64_t latency = now() - i->second.time;
+        worker.dispatched.erase(i);
+        worker.totalLatency += latency;
+
+        Stats& stats = worker.stats;
+        stats.queueDepth = worker.dispatched.size();
+        ++stats.replies;
+        stats.latency = worker.totalLatency / stats.replies;
+        stats.maxLatency = std::max(stats.maxLatency, latency);
+        return true;
+    }
+
+    /** @return the number of replies forwarded to the clients. */
+    size_t _forwardReplies()
+    {
+        size_t replies = 0;
+        while (true)
+        {
+            // [server][client][request id][empty][reply...]
+            detail::Message reply;
+            if (!reply.recv(_backend.get(), ZMQ_DONTWAIT))
+                break;
+
+            // servers may reply out of order, e.g., asynchronous handlers
+            auto i = _workers.find(reply.getString(0));
+            if (i == _workers.end() ||
+                !_complete(i->second, getEnvelope(reply, 1)))
+            {
+                // the request was recovered from a removed server
+                ZEROEQINFO << "Dropping late reply of server "
+                           << reply.getString(0) << std::endl;
+                continue;
+            }
+
+            if (!reply.send(_frontend.socket.get(), 1))
+                ZEROEQWARN << "Cannot forward reply: "
+                           << zmq_strerror(zmq_errno()) << std::endl;
+            ++replies;
+        }
+        _dispatch();
+        return replies;
+    }
+};
+
+LoadBalancer::LoadBalancer()
+    : Receiver()
+    , _impl(new Impl(URI(), DEFAULT_SESSION))
+{
+}
+
+LoadBalancer::LoadBalancer(const std::string& session)
+    : Receiver()
+    , _impl(new Impl(URI(), session))
+{
+}
+
+LoadBalancer::LoadBalancer(const URI& uri, const std::string& session)
+    : Receiver()
+    , _impl(new Impl(uri, session))
+{
+}
+
+LoadBalancer::LoadBalancer(const URIs& servers, const URI& uri)
+    : Receiver()
+    , _impl(new Impl(servers, uri))
+{
+}
+
+LoadBalancer::LoadBalancer(const URIs& servers, const URI& uri,
+                           Receiver& shared)
+    : Receiver(shared)
+    , _impl(new Impl(servers, uri))
+{
+}
+
+LoadBalancer::~LoadBalancer()
+{
+}
+
+const URI& LoadBalancer::getURI() const
+{
+    return _impl->getURI();
+}
+
+const std::string& LoadBalancer::getSession() const
+{
+    return _impl->getSession();
+}
+
+void LoadBalancer::setMaxQueueDepth(const size_t depth)
+{
+    _impl->setMaxQueueDepth(depth);
+}
+
+size_t LoadBalancer::getMaxQueueDepth() const
+{
+    return _impl->getMaxQueueDepth();
+}
+
+size_t LoadBalancer::getQueueSize() const
+{
+    return _impl->getQueueSize();
+}
+
+std::vector<LoadBalancer::Stats> LoadBalancer::getStats() const
+{
+    return _impl->getStats();
+}
+
+void LoadBalancer::addSockets(std::vector<detail::Socket>& entries)
+{
+    _impl->addSockets(entries);
+}
+
+bool LoadBalancer::process(detail::Socket& socket)
+{
+    return _impl->process(socket);
+}
+
+void LoadBalancer::update()
+{
+    _impl->update();
+}
+
+bool LoadBalancer::addConnection(const std::string& uri)
+{
+    return _impl->addConnection(uri);
+}
+}
@@ -0,0 +1,137 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include <zeroeq/receiver.h> // base class
+
+#include <memory>
+#include <vector>
+
+namespace zeroeq
+{
+/**
+ * Dispatches the requests of clients to the least loaded of a pool of servers.
+ *
+ * Clients connect to the URI of the load balancer instead of to the servers.
+ * Each request is forwarded to the connected server with the fewest
+ * outstanding requests, preferring the server with the lower mean latency.
+ * Servers with the maximum queue depth are busy, and requests are queued in
+ * the load balancer until a server is ready, so that a slow server does not
+ * accumulate a queue while others are idle. Requests and replies are
+ * forwarded without copying.
+ *
+ * The outstanding requests of a server which disappears are dispatched again
+ * to the other servers, ahead of the waiting requests. A request which is lost
+ * a second time gets a reply with a zero reply ID, like an unhandled request,
+ * and late replies of recovered requests are dropped.
+ *
+ * The servers are discovered in the given session, or given explicitly. The
+ * load balancer itself is not announced, so that clients of the session do
+ * not bypass it. The zeroeqLoadBalancer application runs a load balancer.
+ *
+ * Not thread safe.
+ *
+ * Example: @include tests/loadBalancer.cpp
+ */
+class LoadBalancer : public Receiver
+{
+public:
+    /** Statistics of a server. */
+    struct Stats
+    {
+        std::string uri;        //!< the server URI
+        size_t queueDepth{0};   //!< outstanding requests on the server
+        uint64_t requests{0};   //!< dispatched requests
+        uint64_t replies{0};    //!< forwarded replies
+        uint64_t latency{0};    //!< mean reply latency in microseconds
+        uint64_t maxLatency{0}; //!< maximum reply latency in microseconds
+    };
+
+    /**
+     * Create a load balancer for the servers of the default session.
+     *
+     * @throw std::runtime_error if socket setup fails
+     */
+    ZEROEQ_API LoadBalancer();
+
+    /**
+     * Create a load balancer for the servers of the given session.
+     *
+     * @param session the session of the servers
+     * @throw std::runtime_error if socket setup fails
+     */
+    ZEROEQ_API explicit LoadBalancer(const std::string& session);
+
+    /**
+     * Create a load balancer for the servers of the given session, serving
+     * clients on the given URI.
+     *
+     * @param uri serving URI in the format [scheme://][*|host|IP|IF][:port]
+     * @param session the session of the servers
+     * @throw std::runtime_error if socket setup fails
+     */
+    ZEROEQ_API LoadBalancer(const URI& uri, const std::string& session);
+
+    /**
+     * Create a load balancer for the servers on the given URIs.
+     *
+     * @param servers server URIs in the format [scheme://]*|host|IP|IF:port
+     * @param uri serving URI in the format [scheme://][*|host|IP|IF][:port]
+     * @throw std::runtime_error if an URI is not fully qualified or socket
+     *        setup fails
+     */
+    ZEROEQ_API LoadBalancer(const URIs& servers, const URI& uri);
+
+    /**
+     * Create a shared load balancer for the servers on the given URIs.
+     *
+     * @sa LoadBalancer(const URIs&, const URI&)
+     *
+     * @param servers server URIs in the format [scheme://]*|host|IP|IF:port
+     * @param uri serving URI in the format [scheme://][*|host|IP|IF][:port]
+     * @param shared another receiver to share data reception with
+     */
+    ZEROEQ_API LoadBalancer(const URIs& servers, const URI& uri,
+                            Receiver& shared);
+
+    /** Destroy this load balancer. */
+    ZEROEQ_API ~LoadBalancer();
+
+    /** @return the URI clients connect to. */
+    ZEROEQ_API const URI& getURI() const;
+
+    /** @return the session of the servers. */
+    ZEROEQ_API const std::string& getSession() const;
+
+    /**
+     * Set the maximum number of outstanding requests per server.
+     *
+     * @param depth the queue depth, at least 1 (the default)
+     */
+    ZEROEQ_API void setMaxQueueDepth(size_t depth);
+
+    /** @return the maximum number of outstanding requests per server. */
+    ZEROEQ_API size_t getMaxQueueDepth() const;
+
+    /** @return the number of requests waiting for a ready server. */
+    ZEROEQ_API size_t getQueueSize() const;
+
+    /** @return the statistics of all connected servers. */
+    ZEROEQ_API std::vector<Stats> getStats() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> _impl;
+
+    LoadBalancer(const LoadBalancer&) = delete;
+    LoadBalancer& operator=(const LoadBalancer&) = delete;
+
+    // Receiver API
+    void addSockets(std::vector<detail::Socket>& entries) final;
+    bool process(detail::Socket& socket) final;
+    void update() final;
+    bool addConnection(const std::string& uri) final;
+};
+}
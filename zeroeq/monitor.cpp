@@ -20,7 +20,7 @@ class Monitor::Impl
 public:
     Impl() {}
     virtual ~Impl() {}
-    void addSockets(std::vector<zeroeq::detail::Socket>& entries)
+    virtual void addSockets(std::vector<zeroeq::detail::Socket>& entries)
     {
         zeroeq::detail::Socket entry;
         entry.socket = _socket.get();
@@ -39,55 +39,57 @@ namespace
 class XPubImpl : public Monitor::Impl
 {
 public:
-    XPubImpl(Sender& sender)
+    XPubImpl(Publisher& publisher)
+        : _publisher(publisher)
+        , _context(detail::getContext())
     {
-        _socket = sender.getSocket();
+        _socket = static_cast<Sender&>(publisher).getSocket();
 
-        const int on = 1;
-        if (zmq_setsockopt(_socket.get(), ZMQ_XPUB_VERBOSE, &on, sizeof(on)) ==
-            -1)
+        // The publisher consumes all subscription messages, it signals new
+        // subscribers on this socket.
+        const auto inproc = std::string("inproc://zeroeq.monitor.") +
+                            servus::make_UUID().getString();
+        _notifications.reset(::zmq_socket(_context.get(), ZMQ_PAIR),
+                             [](void* s) { ::zmq_close(s); });
+        if (::zmq_bind(_notifications.get(), inproc.c_str()) != 0)
         {
             ZEROEQTHROW(std::runtime_error(
-                std::string("Enabling ZMQ_XPUB_VERBOSE failed: ") +
+                std::string("Cannot bind inproc socket: ") +
                 zmq_strerror(zmq_errno())));
         }
+        _publisher.setNotifier(inproc);
     }
 
-    ~XPubImpl()
+    ~XPubImpl() { _publisher.setNotifier(std::string()); }
+
+    void addSockets(std::vector<zeroeq::detail::Socket>& entries) final
     {
-        const int off = 0;
-        zmq_setsockopt(_socket.get(), ZMQ_XPUB_VERBOSE, &off, sizeof(off));
+        Monitor::Impl::addSockets(entries);
+
+        zeroeq::detail::Socket entry;
+        entry.socket = _notifications.get();
+        entry.events = ZMQ_POLLIN;
+        entries.push_back(entry);
     }
 
     bool process(void* socket, Monitor& monitor)
     {
-        // Message event is one byte 0=unsub or 1=sub, followed by topic
-        zmq_msg_t msg;
-        zmq_msg_init(&msg);
-        if (zmq_msg_recv(&msg, socket, 0) == -1)
-            return false;
+        if (socket == _socket.get())
+            _publisher.processSubscriptions();
 
-        const uint8_t* data = (const uint8_t*)zmq_msg_data(&msg);
-        switch (*data)
+        bool notified = false;
+        while (zmq_recv(_notifications.get(), nullptr, 0, ZMQ_DONTWAIT) != -1)
         {
-        case 0:
-            break; // unsub
-
-        case 1: // sub
-            if (zmq_msg_size(&msg) == sizeof(uint8_t) + sizeof(uint128_t) &&
-                *(const uint128_t*)(data + 1) == MEERKAT) // new subscriber
-            {
-                monitor.notifyNewConnection();
-                return true;
-            }
-            break;
-
-        default:
-            ZEROEQWARN << "Unhandled monitor event" << std::endl;
+            monitor.notifyNewConnection();
+            notified = true;
         }
-        zmq_msg_close(&msg);
-        return false;
+        return notified;
     }
+
+private:
+    Publisher& _publisher;
+    zmq::ContextPtr _context;
+    zmq::SocketPtr _notifications;
 };
 
 class SocketImpl : public Monitor::Impl
@@ -179,8 +181,9 @@ private:
 
 Monitor::Impl* newImpl(Sender& sender)
 {
-    if (dynamic_cast<Publisher*>(&sender))
-        return new XPubImpl(sender);
+    Publisher* publisher = dynamic_cast<Publisher*>(&sender);
+    if (publisher)
+        return new XPubImpl(*publisher);
     return new SocketImpl(sender);
 }
 }
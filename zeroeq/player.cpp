@@ -0,0 +1,147 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include "player.h"
+
+#include "publisher.h"
+
+#include "detail/journal.h"
+#include "log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace zeroeq
+{
+constexpr float Player::SPEED_UNLIMITED;
+
+class Player::Impl
+{
+public:
+    Impl(const std::string& filename, Publisher& publisher)
+        : _journal(filename)
+        , _publisher(publisher)
+    {
+    }
+
+    void setSpeed(const float speed)
+    {
+        _speed = speed < 0.f ? SPEED_UNLIMITED : speed;
+        _restart = true;
+    }
+
+    void seek(const size_t position)
+    {
+        _position = std::min(position, _journal.getNumRecords());
+        _restart = true;
+    }
+
+    bool step()
+    {
+        if (_position >= _journal.getNumRecords())
+            return false;
+
+        detail::Record record;
+        if (!_journal.get(_position++, record))
+        {
+            ZEROEQWARN << "Skipping corrupt journal record " << _position - 1
+                       << std::endl;
+            return false;
+        }
+
+        _wait(record.timestamp);
+
+        if (record.size == 0)
+            return _publisher.publish(record.event);
+
+        // publish from the mapped journal, which is kept alive until sent
+        servus::Serializable::Data data;
+        data.ptr = std::shared_ptr<const void>(_journal.getFile(), record.data);
+        data.size = record.size;
+        return _publisher.publish(record.event, data);
+    }
+
+    detail::JournalReader _journal;
+    float _speed{1.f};
+    size_t _position{0};
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Publisher& _publisher;
+    bool _restart{true};
+    Clock::time_point _startTime;
+    uint64_t _startTimestamp{0};
+
+    void _wait(const uint64_t timestamp)
+    {
+        if (_speed == SPEED_UNLIMITED)
+            return;
+
+        if (_restart || timestamp < _startTimestamp)
+        {
+            _startTime = Clock::now();
+            _startTimestamp = timestamp;
+            _restart = false;
+            return;
+        }
+
+        const std::chrono::duration<double, std::micro> offset(
+            double(timestamp - _startTimestamp) / _speed);
+        std::this_thread::sleep_until(
+            _startTime + std::chrono::duration_cast<Clock::duration>(offset));
+    }
+};
+
+Player::Player(const std::string& filename, Publisher& publisher)
+    : _impl(new Impl(filename, publisher))
+{
+}
+
+Player::~Player()
+{
+}
+
+void Player::setSpeed(const float speed)
+{
+    _impl->setSpeed(speed);
+}
+
+float Player::getSpeed() const
+{
+    return _impl->_speed;
+}
+
+size_t Player::getNumRecords() const
+{
+    return _impl->_journal.getNumRecords();
+}
+
+size_t Player::getPosition() const
+{
+    return _impl->_position;
+}
+
+void Player::seek(const size_t position)
+{
+    _impl->seek(position);
+}
+
+bool Player::step()
+{
+    return _impl->step();
+}
+
+size_t Player::play()
+{
+    size_t published = 0;
+    while (getPosition() < getNumRecords())
+    {
+        if (step())
+            ++published;
+    }
+    return published;
+}
+}
@@ -0,0 +1,86 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include <zeroeq/api.h>
+#include <zeroeq/types.h>
+
+#include <memory>
+#include <string>
+
+namespace zeroeq
+{
+/**
+ * Replays a journal written by a Recorder on a Publisher.
+ *
+ * Events are published at their recorded pace, scaled by the replay speed, or
+ * as fast as possible. Payloads are published directly from the
+ * memory-mapped journal without copying.
+ *
+ * Not thread safe.
+ *
+ * Example: @include tests/journal.cpp
+ */
+class Player
+{
+public:
+    /** Replay speed to publish all events as fast as possible. */
+    static constexpr float SPEED_UNLIMITED = 0.f;
+
+    /**
+     * Create a player for the given journal.
+     *
+     * @param filename the path of the journal
+     * @param publisher the publisher to replay the events on
+     * @throw std::runtime_error if the journal cannot be read
+     */
+    ZEROEQ_API Player(const std::string& filename, Publisher& publisher);
+
+    /** Destroy this player. */
+    ZEROEQ_API ~Player();
+
+    /**
+     * Set the replay speed.
+     *
+     * @param speed the factor to the recorded pace, e.g., 1 for the original
+     *              pace, 2 for twice as fast, or SPEED_UNLIMITED
+     */
+    ZEROEQ_API void setSpeed(float speed);
+
+    /** @return the replay speed. */
+    ZEROEQ_API float getSpeed() const;
+
+    /** @return the number of events in the journal. */
+    ZEROEQ_API size_t getNumRecords() const;
+
+    /** @return the index of the next event to publish. */
+    ZEROEQ_API size_t getPosition() const;
+
+    /** Continue the replay at the given event index. */
+    ZEROEQ_API void seek(size_t position);
+
+    /**
+     * Publish the next event, waiting until it is due.
+     *
+     * @return false at the end of the journal or if the event could not be
+     *         published
+     */
+    ZEROEQ_API bool step();
+
+    /**
+     * Publish all remaining events.
+     *
+     * @return the number of published events
+     */
+    ZEROEQ_API size_t play();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> _impl;
+
+    Player(const Player&) = delete;
+    Player& operator=(const Player&) = delete;
+};
+}
@@ -0,0 +1,354 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include "proxy.h"
+
+#include "detail/common.h"
+#include "detail/constants.h"
+#include "detail/fanOut.h"
+#include "detail/receiver.h"
+#include "detail/sender.h"
+#include "detail/socket.h"
+#include "log.h"
+
+#include <zmq.h>
+
+#include <cstring>
+#include <map>
+
+namespace zeroeq
+{
+class Proxy::Impl : public detail::Receiver
+{
+public:
+    Impl(const URI& uri, const std::string& session)
+        : detail::Receiver(PUBLISHER_SERVICE, session == DEFAULT_SESSION
+                                                  ? getDefaultPubSession()
+                                                  : session)
+        , _relay(uri, ZMQ_XPUB, PUBLISHER_SERVICE, getSession())
+        , _upstream(zmq_socket(getContext(), ZMQ_XSUB),
+                    [](void* s) { ::zmq_close(s); })
+    {
+        _init();
+        _relay.addProperty(KEY_RELAY, getHostName());
+        const std::string& rack = getRackName();
+        if (!rack.empty())
+            _relay.addProperty(KEY_RACK, rack);
+        _relay.announce();
+        update();
+    }
+
+    Impl(const URIs& upstream, const URI& uri)
+        : detail::Receiver(PUBLISHER_SERVICE)
+        , _relay(uri, ZMQ_XPUB)
+        , _upstream(zmq_socket(getContext(), ZMQ_XSUB),
+                    [](void* s) { ::zmq_close(s); })
+    {
+        _init();
+        for (const URI& publisher : upstream)
+        {
+            if (!publisher.isFullyQualified())
+                ZEROEQTHROW(std::runtime_error(
+                    std::string("Non-fully qualified URI used for proxy")));
+
+            const std::string& zmqURI = buildZmqURI(publisher);
+            if (!addConnection(zmqURI))
+                ZEROEQTHROW(std::runtime_error("Cannot connect proxy to " +
+                                               zmqURI + ": " +
+                                               zmq_strerror(zmq_errno())));
+        }
+    }
+
+    ~Impl()
+    {
+        // Hand our children in the fan-out tree back to our upstream
+        const std::vector<std::string>& upstream = getConnectionURIs();
+        if (upstream.empty())
+            return;
+
+        for (const auto& child : _children)
+        {
+            const std::string& topic =
+                detail::fanout::makeRedirectTopic(child.first);
+            const std::string& payload =
+                child.second.uri + "\n" + upstream.front();
+            zmq_send(_relay.socket.get(), topic.data(), topic.size(),
+                     ZMQ_SNDMORE);
+            zmq_send(_relay.socket.get(), payload.data(), payload.size(), 0);
+        }
+    }
+
+    void addSockets(std::vector<detail::Socket>& entries)
+    {
+        for (void* socket : {_upstream.get(), _relay.socket.get()})
+        {
+            detail::Socket entry;
+            entry.socket = socket;
+            entry.events = ZMQ_POLLIN;
+            entries.push_back(entry);
+        }
+    }
+
+    bool process(detail::Socket& socket)
+    {
+        if (socket.socket == _upstream.get())
+            return _forward(_upstream.get(), _relay.socket.get(), false) > 0;
+
+        // (un)subscriptions from downstream subscribers
+        _stats.subscriptions +=
+            _forward(_relay.socket.get(), _upstream.get(), true);
+        return false;
+    }
+
+    const URI& getURI() const { return _relay.uri; }
+    const Stats& getStats() const { return _stats; }
+
+    // Upstream publishers and lanes are all received on one socket
+    zmq::SocketPtr createSocket(const uint128_t&) final { return _upstream; }
+    zmq::SocketPtr createPrioritySocket(const uint128_t&) final
+    {
+        return _upstream;
+    }
+    bool useRelays() const final { return false; }
+
+    /** Tell the publishers about our connections for their fan-out tree. */
+    void connectionsChanged() final
+    {
+        const std::vector<std::string>& uris = getConnectionURIs();
+        const std::string& filter =
+            uris.empty() ? std::string()
+                         : detail::fanout::makeJoinFilter(_node, _getZmqURI(),
+                                                          uris);
+        if (filter == _joinFilter)
+            return;
+
+        if (!_joinFilter.empty())
+            _subscribe(_joinFilter, false);
+        if (!filter.empty())
+            _subscribe(filter, true);
+        _joinFilter = filter;
+    }
+
+private:
+    detail::Sender _relay;
+    zmq::SocketPtr _upstream;
+    Stats _stats;
+
+    struct Child
+    {
+        std::string filter; // latest join filter
+        std::string uri;    // of this proxy, as connected by the child
+    };
+    const uint128_t _node{servus::make_UUID()}; // in the fan-out tree
+    const std::string _redirectTopic{
+        detail::fanout::makeRedirectTopic(_node)};
+    std::string _joinFilter;
+    std::map<uint128_t, Child> _children; // in the fan-out tree
+
+    void _init()
+    {
+        const int hwm = 0;
+        zmq_setsockopt(_upstream.get(), ZMQ_RCVHWM, &hwm, sizeof(hwm));
+
+        const std::string& zmqURI = buildZmqURI(_relay.uri);
+        if (zmq_bind(_relay.socket.get(), zmqURI.c_str()) == -1)
+            ZEROEQTHROW(std::runtime_error(
+                std::string("Cannot bind proxy socket '") + zmqURI + "': " +
+                zmq_strerror(zmq_errno())));
+
+        // forward the subscriptions of late subscribers, which need a
+        // keyframe or the last deduplicated event from the publishers
+        const int on = 1;
+        if (zmq_setsockopt(_relay.socket.get(), detail::XPUB_VERBOSE_OPTION,
+                           &on, sizeof(on)) == -1)
+        {
+            ZEROEQTHROW(std::runtime_error(
+                std::string("Enabling verbose subscriptions failed: ") +
+                zmq_strerror(zmq_errno())));
+        }
+
+        _relay.initURI();
+        _subscribe(_redirectTopic, true);
+    }
+
+    std::string _getZmqURI() const { return buildZmqURI(_relay.uri); }
+
+    /** Send an own (un)subscription to the upstream publishers. */
+    void _subscribe(const std::string& filter, const bool subscribe)
+    {
+        std::string message(1, subscribe ? 1 : 0);
+        message += filter;
+        if (zmq_send(_upstream.get(), message.data(), message.size(), 0) == -1)
+            ZEROEQWARN << "Cannot send subscription upstream: "
+                       << zmq_strerror(zmq_errno()) << std::endl;
+    }
+
+    bool _isRedirect(zmq_msg_t& msg) const
+    {
+        return zmq_msg_size(&msg) == _redirectTopic.size() &&
+               ::memcmp(zmq_msg_data(&msg), _redirectTopic.data(),
+                        _redirectTopic.size()) == 0;
+    }
+
+    /** Move an upstream connection as requested by a publisher. */
+    void _redirect(zmq_msg_t& msg, void* socket)
+    {
+        std::string from, to;
+        while (zmq_msg_more(&msg))
+        {
+            zmq_msg_recv(&msg, socket, 0);
+            if (!zmq_msg_more(&msg))
+                detail::fanout::parseRedirect(zmq_msg_data(&msg),
+                                              zmq_msg_size(&msg), from, to);
+        }
+        if (!from.empty() && !redirect(from, to))
+            ZEROEQINFO << "Cannot redirect from " << from << " to " << to
+                       << std::endl;
+    }
+
+    /** Track the children connected to us from their join filters. */
+    void _updateChildren(zmq_msg_t& msg)
+    {
+        const uint8_t* data = static_cast<const uint8_t*>(zmq_msg_data(&msg));
+        const size_t size = zmq_msg_size(&msg);
+        uint128_t node;
+        std::string relay;
+        std::vector<std::string> uris;
+        if (size <= 1 + detail::fanout::topicSize ||
+            !detail::fanout::parseJoinFilter(data + 1, size - 1, node, relay,
+                                             uris))
+        {
+            return;
+        }
+
+        const std::string filter(reinterpret_cast<const char*>(data) + 1,
+                                 size - 1);
+        if (data[0] == 0)
+        {
+            const auto i = _children.find(node);
+            if (i != _children.end() && i->second.filter == filter)
+                _children.erase(i);
+            return;
+        }
+
+        const std::string& self = _getZmqURI();
+        for (const auto& uri : uris)
+        {
+            if (detail::fanout::matches(uri, self))
+            {
+                _children[node] = {filter, uri};
+                return;
+            }
+        }
+        _children.erase(node);
+    }
+
+    /**
+     * Forward all pending messages without copying.
+     * @return the number of forwarded messages.
+     */
+    uint64_t _forward(void* from, void* to, const bool isSubscription)
+    {
+        uint64_t messages = 0;
+        zmq_msg_t msg;
+        zmq_msg_init(&msg);
+        bool first = true;
+        while (zmq_msg_recv(&msg, from, ZMQ_DONTWAIT) != -1)
+        {
+            if (first && isSubscription)
+                _updateChildren(msg);
+            else if (first && _isRedirect(msg))
+            {
+                _redirect(msg, from);
+                continue;
+            }
+
+            const bool more = zmq_msg_more(&msg);
+            first = !more;
+            if (!isSubscription)
+                _stats.bytes += zmq_msg_size(&msg);
+            if (zmq_msg_send(&msg, to, more ? ZMQ_SNDMORE : 0) == -1)
+                ZEROEQWARN << "Cannot forward message: "
+                           << zmq_strerror(zmq_errno()) << std::endl;
+            if (more)
+                continue;
+
+            ++messages;
+            if (!isSubscription)
+                ++_stats.messages;
+        }
+        zmq_msg_close(&msg);
+        return messages;
+    }
+};
+
+Proxy::Proxy()
+    : Receiver()
+    , _impl(new Impl(URI(), DEFAULT_SESSION))
+{
+}
+
+Proxy::Proxy(const std::string& session)
+    : Receiver()
+    , _impl(new Impl(URI(), session))
+{
+}
+
+Proxy::Proxy(const URI& uri, const std::string& session)
+    : Receiver()
+    , _impl(new Impl(uri, session))
+{
+}
+
+Proxy::Proxy(const URIs& upstream, const URI& uri)
+    : Receiver()
+    , _impl(new Impl(upstream, uri))
+{
+}
+
+Proxy::Proxy(const URIs& upstream, const URI& uri, Receiver& shared)
+    : Receiver(shared)
+    , _impl(new Impl(upstream, uri))
+{
+}
+
+Proxy::~Proxy()
+{
+}
+
+const URI& Proxy::getURI() const
+{
+    return _impl->getURI();
+}
+
+const std::string& Proxy::getSession() const
+{
+    return _impl->getSession();
+}
+
+const Proxy::Stats& Proxy::getStats() const
+{
+    return _impl->getStats();
+}
+
+void Proxy::addSockets(std::vector<detail::Socket>& entries)
+{
+    _impl->addSockets(entries);
+}
+
+bool Proxy::process(detail::Socket& socket)
+{
+    return _impl->process(socket);
+}
+
+void Proxy::update()
+{
+    _impl->update();
+}
+
+bool Proxy::addConnection(const std::string& uri)
+{
+    return _impl->addConnection(uri);
+}
+}
@@ -0,0 +1,119 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include <zeroeq/receiver.h> // base class
+
+#include <memory>
+
+namespace zeroeq
+{
+/**
+ * Relays the events of all publishers of a session to local subscribers.
+ *
+ * A proxy subscribes once to the publishers of its session, and re-publishes
+ * their events to its own subscribers. Events are forwarded without copying,
+ * and subscriptions are forwarded to the publishers. This offloads the
+ * fan-out from publishers with many remote subscribers.
+ *
+ * A proxy is announced as a relay with its host name and the rack set in
+ * ZEROEQ_RACK. Subscribers of the same session prefer a relay on their own
+ * node, then one on their rack, over receiving directly from the publishers.
+ * Proxies do not receive from other relays. The zeroeqProxy application runs
+ * a proxy.
+ *
+ * Proxies also are the inner nodes of the fan-out tree of a Publisher, and
+ * hand their subscribers back to their upstream when destroyed.
+ *
+ * Not thread safe.
+ *
+ * Example: @include tests/proxy.cpp
+ */
+class Proxy : public Receiver
+{
+public:
+    /** Forwarding statistics. */
+    struct Stats
+    {
+        uint64_t messages{0};      //!< forwarded events
+        uint64_t bytes{0};         //!< forwarded event bytes
+        uint64_t subscriptions{0}; //!< forwarded (un)subscriptions
+    };
+
+    /**
+     * Create a proxy for the default session.
+     *
+     * @throw std::runtime_error if socket setup fails
+     */
+    ZEROEQ_API Proxy();
+
+    /**
+     * Create a proxy for the given session.
+     *
+     * @param session the session of the publishers to relay
+     * @throw std::runtime_error if socket setup fails
+     */
+    ZEROEQ_API explicit Proxy(const std::string& session);
+
+    /**
+     * Create a proxy for the given session, publishing on the given URI.
+     *
+     * @param uri publishing URI in the format [scheme://][*|host|IP|IF][:port]
+     * @param session the session of the publishers to relay
+     * @throw std::runtime_error if socket setup fails
+     */
+    ZEROEQ_API Proxy(const URI& uri, const std::string& session);
+
+    /**
+     * Create a proxy for the publishers on the given URIs.
+     *
+     * The proxy is not announced, and is used by subscribers connecting to
+     * its URI or redirected to it by a publisher's fan-out tree.
+     *
+     * @param upstream publisher URIs in the format [scheme://]*|host|IP|IF:port
+     * @param uri publishing URI in the format [scheme://][*|host|IP|IF][:port]
+     * @throw std::runtime_error if an URI is not fully qualified or socket
+     *        setup fails
+     * @sa Publisher::setFanOut()
+     */
+    ZEROEQ_API Proxy(const URIs& upstream, const URI& uri);
+
+    /**
+     * Create a shared proxy for the publishers on the given URIs.
+     *
+     * @sa Proxy(const URIs&, const URI&)
+     *
+     * @param upstream publisher URIs in the format [scheme://]*|host|IP|IF:port
+     * @param uri publishing URI in the format [scheme://][*|host|IP|IF][:port]
+     * @param shared another receiver to share data reception with
+     */
+    ZEROEQ_API Proxy(const URIs& upstream, const URI& uri, Receiver& shared);
+
+    /** Destroy this proxy. */
+    ZEROEQ_API ~Proxy();
+
+    /** @return the URI the relayed events are published on. */
+    ZEROEQ_API const URI& getURI() const;
+
+    /** @return the session of the relayed publishers. */
+    ZEROEQ_API const std::string& getSession() const;
+
+    /** @return the forwarding statistics. */
+    ZEROEQ_API const Stats& getStats() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> _impl;
+
+    Proxy(const Proxy&) = delete;
+    Proxy& operator=(const Proxy&) = delete;
+
+    // Receiver API
+    void addSockets(std::vector<detail::Socket>& entries) final;
+    bool process(detail::Socket& socket) final;
+    void update() final;
+    bool addConnection(const std::string& uri) final;
+};
+}
@@ -5,22 +5,113 @@
  */
 
 #include "publisher.h"
+#include "server.h"
 
 #include "detail/byteswap.h"
 #include "detail/common.h"
 #include "detail/constants.h"
+#include "detail/delta.h"
+#include "detail/fanOut.h"
+#include "detail/hash.h"
+#include "detail/header.h"
+#include "detail/history.h"
 #include "detail/sender.h"
+#include "detail/socket.h"
 #include "log.h"
 
 #include <servus/serializable.h>
 
 #include <zmq.h>
 
+#include <atomic>
 #include <cstring>
 #include <map>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace zeroeq
 {
+namespace
+{
+/**
+ * Topic filters with at least one subscriber on an XPUB socket.
+ *
+ * The subscribers of each filter are counted if the socket passes all
+ * unsubscriptions, otherwise each filter is counted at most once.
+ */
+struct Subscriptions
+{
+    std::unordered_map<uint128_t, size_t> events; // subscribers by event
+    std::map<std::string, size_t> prefixes; // other filters, e.g. subscribe-all
+
+    void update(const uint8_t* data, const size_t size)
+    {
+        // Message is one byte 0=unsub or 1=sub, followed by the filter
+        const bool subscribe = data[0] == 1;
+        if (size > sizeof(uint8_t) + sizeof(uint128_t))
+            return; // never matches an event, e.g., fan-out tree filters
+
+        if (size == sizeof(uint8_t) + sizeof(uint128_t))
+        {
+            uint128_t event;
+            ::memcpy(&event, data + 1, sizeof(event));
+#ifdef ZEROEQ_BIGENDIAN
+            detail::byteswap(event); // convert from little endian wire
+#endif
+            _update(events, event, subscribe);
+            return;
+        }
+
+        const std::string prefix((const char*)data + 1, size - 1);
+        _update(prefixes, prefix, subscribe);
+    }
+
+    /** @return the number of subscribers of the event. */
+    size_t count(uint128_t event) const
+    {
+        const auto i = events.find(event);
+        size_t subscribers = i == events.end() ? 0 : i->second;
+        if (prefixes.empty())
+            return subscribers;
+
+#ifdef ZEROEQ_BIGENDIAN
+        detail::byteswap(event); // filters are in little endian wire format
+#endif
+        for (const auto& prefix : prefixes)
+        {
+            if (prefix.first.size() <= sizeof(event) &&
+                ::memcmp(prefix.first.data(), &event, prefix.first.size()) ==
+                    0)
+            {
+                subscribers += prefix.second;
+            }
+        }
+        return subscribers;
+    }
+
+    bool contains(const uint128_t& event) const { return count(event) > 0; }
+
+private:
+    template <class Map, class Key>
+    static void _update(Map& map, const Key& key, const bool subscribe)
+    {
+        if (subscribe)
+        {
+            size_t& subscribers = map[key];
+            subscribers =
+                detail::XPUB_COUNTS_SUBSCRIBERS ? subscribers + 1 : 1;
+            return;
+        }
+
+        const auto i = map.find(key);
+        if (i != map.end() && --i->second == 0)
+            map.erase(i);
+    }
+};
+}
+
 class Publisher::Impl : public detail::Sender
 {
 public:
@@ -38,56 +129,525 @@ public:
             ZEROEQTHROW(std::runtime_error(
                 std::string("Cannot bind publisher socket '") + zmqURI +
                 "': " + zmq_strerror(zmq_errno())));
+        _setVerbose(socket.get());
+
+        URI priorityURI(uri);
+        priorityURI.setPort(0);
 
         initURI();
+        _fanOut.setURI(buildZmqURI(uri));
         if (session != NULL_SESSION)
+        {
+            _bindPriorityLane(priorityURI);
             announce();
+        }
+    }
+
+    ~Impl()
+    {
+        if (_historyServer)
+            _historyServer->remove(HISTORY_REQUEST);
+    }
+
+    void setNotifier(const std::string& address)
+    {
+        _notifier.reset();
+        if (address.empty())
+            return;
+
+        _notifier.reset(zmq_socket(detail::getContext().get(), ZMQ_PAIR),
+                        [](void* s) { ::zmq_close(s); });
+        if (zmq_connect(_notifier.get(), address.c_str()) == -1)
+            ZEROEQTHROW(std::runtime_error(
+                std::string("Cannot connect monitor notifier: ") +
+                zmq_strerror(zmq_errno())));
+    }
+
+    void processSubscriptions()
+    {
+        _processSubscriptions(socket.get(), _subscriptions, true);
+        if (_prioritySocket)
+            _processSubscriptions(_prioritySocket.get(), _prioritySubscriptions,
+                                  false);
+    }
+
+    void setFanOut(const size_t maxChildren)
+    {
+        processSubscriptions();
+        _fanOut.setMaxChildren(maxChildren, _redirects);
+        _publishRedirects();
+        if (maxChildren > 0)
+            _publishAnnounce();
+    }
+
+    size_t getFanOut() const { return _fanOut.getMaxChildren(); }
+
+    bool hasSubscribers(const uint128_t& event)
+    {
+        processSubscriptions();
+        return _subscriptions.contains(event) ||
+               _prioritySubscriptions.contains(event);
+    }
+
+    void enableDeduplication(const size_t keyframeInterval)
+    {
+        _deduplicate = true;
+        _keyframeInterval = keyframeInterval;
+    }
+
+    void disableDeduplication()
+    {
+        _deduplicate = false;
+        _lastPayloads.clear();
+    }
+
+    uint64_t getNumSuppressed() const { return _numSuppressed; }
+
+    void enableDelta(const uint128_t& event, const size_t keyframeInterval)
+    {
+        _deltas[event].keyframeInterval = keyframeInterval;
+    }
+
+    void disableDelta(const uint128_t& event) { _deltas.erase(event); }
+
+    void enableHistory(const std::string& directory, const uint64_t maxSize,
+                       const uint32_t maxAge)
+    {
+        std::atomic_store(&_history,
+                          std::make_shared<detail::History>(directory, maxSize,
+                                                            maxAge));
+    }
+
+    void disableHistory()
+    {
+        std::atomic_store(&_history, std::shared_ptr<detail::History>());
+    }
+
+    bool serveHistory(Server& server)
+    {
+        if (_historyServer ||
+            !server.handle(HISTORY_REQUEST,
+                           [this](const void* data, const size_t size) {
+                               return _serveHistory(data, size);
+                           }))
+        {
+            return false;
+        }
+        _historyServer = &server;
+        return true;
+    }
+
+    void setPriority(const uint128_t& event, const Publisher::Priority priority)
+    {
+        if (priority == Publisher::PRIORITY_NORMAL)
+            _priorities.erase(event);
+        else
+            _priorities[event] = priority;
+    }
+
+    Publisher::Priority getPriority(const uint128_t& event) const
+    {
+        const auto i = _priorities.find(event);
+        return i == _priorities.end() ? Publisher::PRIORITY_NORMAL : i->second;
     }
 
-    ~Impl() {}
     bool publish(const servus::Serializable& serializable)
     {
+        const uint128_t& event = serializable.getTypeIdentifier();
+        if (!_getHistory() && !hasSubscribers(event)) // nobody to serialize for
+            return true;
+
         const servus::Serializable::Data& data = serializable.toBinary();
-        return publish(serializable.getTypeIdentifier(), data.ptr.get(),
-                       data.size);
+        return publish(event, data.ptr.get(), data.size);
+    }
+
+    bool publish(uint128_t event, const void* data, const size_t size,
+                 const std::shared_ptr<const void>& owner = {})
+    {
+        if (_fanOut.getMaxChildren() > 0) // redirect new subscribers
+            processSubscriptions();
+
+        if (_deduplicate && data && size > 0 && _isDuplicate(event, data, size))
+        {
+            ++_numSuppressed;
+            return true;
+        }
+
+        const auto history = _getHistory();
+        const uint64_t sequence =
+            history ? history->append(event, data, size) : 0;
+
+        if (data && size > 0)
+        {
+            auto delta = _deltas.find(event);
+            if (delta != _deltas.end())
+                return _publishDelta(event, delta->second,
+                                     sequence ? sequence
+                                              : ++delta->second.sequence,
+                                     data, size);
+        }
+
+        if (sequence == 0)
+            return _publish(event, nullptr, data, size, owner);
+
+        detail::Header header; // plain, but sequenced for history catch-up
+        header.sender = _instance;
+        header.sequence = sequence;
+        header.size = size;
+        return _publish(event, &header, data, size, owner);
+    }
+
+private:
+    const uint128_t _instance{servus::make_UUID()}; // sender of the sequences
+    zmq::SocketPtr _prioritySocket;
+    std::unordered_map<uint128_t, Publisher::Priority> _priorities;
+
+    Subscriptions _subscriptions;
+    Subscriptions _prioritySubscriptions;
+    zmq::SocketPtr _notifier; // inproc to Monitor, signals new subscribers
+
+    detail::FanOut _fanOut;
+    detail::FanOut::Redirects _redirects;
+
+    struct LastPayload
+    {
+        uint64_t hash;
+        size_t size;
+        size_t suppressed;
+    };
+    bool _deduplicate{false};
+    size_t _keyframeInterval{0};
+    uint64_t _numSuppressed{0};
+    std::unordered_map<uint128_t, LastPayload> _lastPayloads;
+
+    struct Delta
+    {
+        size_t keyframeInterval{0};
+        uint64_t sequence{0};
+        uint64_t keyframeSequence{0};
+        size_t numDeltas{0};
+        bool needsKeyframe{true};
+        std::vector<uint8_t> keyframe;
+    };
+    std::unordered_map<uint128_t, Delta> _deltas;
+    std::vector<uint8_t> _deltaBuffer;
+
+    // Swapped atomically, the history server may run in another thread
+    std::shared_ptr<detail::History> _history;
+    Server* _historyServer{nullptr};
+
+    std::shared_ptr<detail::History> _getHistory() const
+    {
+        return std::atomic_load(&_history);
+    }
+
+    ReplyData _serveHistory(const void* data, const size_t size)
+    {
+        // request is [event][since sequence][max reply size]
+        uint64_t request[4];
+        const auto history = _getHistory();
+        if (!history || size != sizeof(request))
+            return {uint128_t(), {}};
+
+        ::memcpy(request, data, sizeof(request));
+#ifdef ZEROEQ_BIGENDIAN
+        for (auto& value : request)
+            detail::byteswap(value); // convert from little endian wire
+#endif
+        auto buffer = std::make_shared<std::vector<uint8_t>>();
+        history->query(uint128_t(request[1], request[0]), request[2],
+                       request[3], _instance, *buffer);
+
+        servus::Serializable::Data reply; // owns the buffer until sent
+        reply.ptr = std::shared_ptr<const void>(buffer, buffer->data());
+        reply.size = buffer->size();
+        return {HISTORY_REQUEST, reply};
+    }
+
+    bool _publishDelta(const uint128_t& event, Delta& delta,
+                       const uint64_t sequence, const void* data,
+                       const size_t size)
+    {
+        processSubscriptions(); // new subscribers need a keyframe
+
+        detail::Header header;
+        header.sender = _instance;
+        header.sequence = sequence;
+        header.size = size;
+
+        if (!delta.needsKeyframe &&
+            (delta.keyframeInterval == 0 ||
+             delta.numDeltas < delta.keyframeInterval))
+        {
+            detail::encodeDelta(delta.keyframe.data(), delta.keyframe.size(),
+                                data, size, _deltaBuffer);
+            if (_deltaBuffer.size() < size) // else not worth it
+            {
+                header.encoding = detail::Header::ENCODING_DELTA;
+                header.keyframe = delta.keyframeSequence;
+                ++delta.numDeltas;
+                return _publish(event, &header, _deltaBuffer.data(),
+                                _deltaBuffer.size());
+            }
+        }
+
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        delta.keyframe.assign(bytes, bytes + size);
+        delta.keyframeSequence = header.sequence;
+        delta.numDeltas = 0;
+        delta.needsKeyframe = false;
+
+        header.encoding = detail::Header::ENCODING_KEYFRAME;
+        header.keyframe = header.sequence;
+        return _publish(event, &header, data, size);
     }
 
-    bool publish(uint128_t event, const void* data, const size_t size)
+    bool _publish(uint128_t event, const detail::Header* header,
+                  const void* data, const size_t size,
+                  const std::shared_ptr<const void>& owner = {})
     {
+        void* lane = _getLane(event);
 #ifdef ZEROEQ_BIGENDIAN
         detail::byteswap(event); // convert to little endian wire protocol
 #endif
         const bool hasPayload = data && size > 0;
 
-        zmq_msg_t msgHeader;
-        zmq_msg_init_size(&msgHeader, sizeof(event));
-        memcpy(zmq_msg_data(&msgHeader), &event, sizeof(event));
-        int ret = zmq_msg_send(&msgHeader, socket.get(),
-                               hasPayload ? ZMQ_SNDMORE : 0);
-        zmq_msg_close(&msgHeader);
-        if (ret == -1)
+        if (!_send(lane, &event, sizeof(event),
+                   hasPayload || header ? ZMQ_SNDMORE : 0))
         {
             ZEROEQWARN << "Cannot publish message header, got "
                        << zmq_strerror(zmq_errno()) << std::endl;
             return false;
         }
 
-        if (!hasPayload)
+        if (!hasPayload && !header)
             return true;
 
+        if (header)
+        {
+            uint8_t buffer[detail::Header::wireSize];
+            header->write(buffer);
+            if (!_send(lane, buffer, sizeof(buffer), ZMQ_SNDMORE))
+            {
+                ZEROEQWARN << "Cannot publish message encoding, got "
+                           << zmq_strerror(zmq_errno()) << std::endl;
+                return false;
+            }
+        }
+
+        if (!(owner ? _send(lane, owner, size, 0)
+                    : _send(lane, data, size, 0)))
+        {
+            ZEROEQWARN << "Cannot publish message data, got "
+                       << zmq_strerror(zmq_errno()) << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool _send(void* lane, const void* data, const size_t size,
+               const int flags)
+    {
         zmq_msg_t msg;
         zmq_msg_init_size(&msg, size);
-        ::memcpy(zmq_msg_data(&msg), data, size);
-        ret = zmq_msg_send(&msg, socket.get(), 0);
+        if (size > 0)
+            ::memcpy(zmq_msg_data(&msg), data, size);
+        const int ret = zmq_msg_send(&msg, lane, flags);
         zmq_msg_close(&msg);
-        if (ret == -1)
+        return ret != -1;
+    }
+
+    /** Send without copy, holding a reference on data until sent. */
+    bool _send(void* lane, const std::shared_ptr<const void>& data,
+               const size_t size, const int flags)
+    {
+        auto* ref = new std::shared_ptr<const void>(data);
+        zmq_msg_t msg;
+        if (zmq_msg_init_data(&msg, const_cast<void*>(data.get()), size,
+                              [](void*, void* hint) {
+                                  delete static_cast<
+                                      std::shared_ptr<const void>*>(hint);
+                              },
+                              ref) == -1)
         {
-            ZEROEQWARN << "Cannot publish message data, got "
+            delete ref;
+            return false;
+        }
+        const int ret = zmq_msg_send(&msg, lane, flags);
+        zmq_msg_close(&msg);
+        return ret != -1;
+    }
+
+    void _publishRedirects()
+    {
+        for (const auto& redirect : _redirects)
+        {
+            const std::string& topic =
+                detail::fanout::makeRedirectTopic(redirect.node);
+            const std::string& payload = redirect.from + "\n" + redirect.to;
+            if (!_send(socket.get(), topic.data(), topic.size(),
+                       ZMQ_SNDMORE) ||
+                !_send(socket.get(), payload.data(), payload.size(), 0))
+            {
+                ZEROEQWARN << "Cannot publish fan-out redirect, got "
+                           << zmq_strerror(zmq_errno()) << std::endl;
+            }
+        }
+        _redirects.clear();
+    }
+
+    /** Ask subscribers to send their join filters, see detail::FanOut. */
+    void _publishAnnounce()
+    {
+        const std::string& topic = detail::fanout::makeAnnounceTopic();
+        if (!_send(socket.get(), topic.data(), topic.size(), 0))
+        {
+            ZEROEQWARN << "Cannot publish fan-out announcement, got "
                        << zmq_strerror(zmq_errno()) << std::endl;
+        }
+    }
+
+    void _setVerbose(void* lane)
+    {
+        // pass subscriptions of all subscribers to track new ones
+        const int on = 1;
+        if (zmq_setsockopt(lane, detail::XPUB_VERBOSE_OPTION, &on,
+                           sizeof(on)) == -1)
+        {
+            ZEROEQTHROW(std::runtime_error(
+                std::string("Enabling verbose subscriptions failed: ") +
+                zmq_strerror(zmq_errno())));
+        }
+    }
+
+    bool _isDuplicate(const uint128_t& event, const void* data,
+                      const size_t size)
+    {
+        processSubscriptions(); // new subscribers reset the last payload
+
+        const uint64_t hash = detail::hash64(data, size);
+        auto i = _lastPayloads.find(event);
+        if (i == _lastPayloads.end())
+        {
+            _lastPayloads[event] = {hash, size, 0};
+            return false;
+        }
+
+        LastPayload& last = i->second;
+        if (last.hash != hash || last.size != size ||
+            (_keyframeInterval > 0 && last.suppressed >= _keyframeInterval))
+        {
+            last = {hash, size, 0};
             return false;
         }
+
+        ++last.suppressed;
         return true;
     }
+
+    void _processSubscriptions(void* lane, Subscriptions& subscriptions,
+                               const bool notify)
+    {
+        bool announceFanOut = false;
+        zmq_msg_t msg;
+        zmq_msg_init(&msg);
+        while (zmq_msg_recv(&msg, lane, ZMQ_DONTWAIT) != -1)
+        {
+            const size_t size = zmq_msg_size(&msg);
+            if (size == 0)
+                continue;
+
+            const uint8_t* data = (const uint8_t*)zmq_msg_data(&msg);
+            if (*data > 1)
+            {
+                ZEROEQWARN << "Unhandled subscription message" << std::endl;
+                continue;
+            }
+            if (notify && _fanOut.update(data, size, _redirects))
+                continue;
+            if (notify && *data == 1 &&
+                detail::fanout::isAnnounceTopic(data + 1, size - 1))
+            {
+                announceFanOut = _fanOut.getMaxChildren() > 0;
+            }
+
+            subscriptions.update(data, size);
+            if (*data == 1 && size == sizeof(uint8_t) + sizeof(uint128_t))
+                _onSubscribe(data + 1);
+
+            if (notify && _notifier && *data == 1 &&
+                size == sizeof(uint8_t) + sizeof(uint128_t) &&
+                ::memcmp(data + 1, &MEERKAT, sizeof(uint128_t)) == 0)
+            {
+                zmq_send(_notifier.get(), nullptr, 0, ZMQ_DONTWAIT);
+            }
+        }
+        zmq_msg_close(&msg);
+        if (notify)
+            _publishRedirects();
+        if (announceFanOut)
+            _publishAnnounce();
+    }
+
+    void _onSubscribe(const uint8_t* data)
+    {
+        if (_lastPayloads.empty() && _deltas.empty())
+            return;
+
+        uint128_t event;
+        ::memcpy(&event, data, sizeof(event));
+#ifdef ZEROEQ_BIGENDIAN
+        detail::byteswap(event); // convert from little endian wire
+#endif
+        _lastPayloads.erase(event); // new subscriber needs the current state
+
+        auto delta = _deltas.find(event);
+        if (delta != _deltas.end())
+            delta->second.needsKeyframe = true;
+    }
+
+    /**
+     * @return the high priority lane for prioritized events, unless one of
+     *         their subscribers is only connected to the normal lane. All
+     *         subscribers subscribe on the normal lane.
+     */
+    void* _getLane(const uint128_t& event)
+    {
+        if (!_prioritySocket || _priorities.count(event) == 0)
+            return socket.get();
+
+        processSubscriptions();
+        if (_subscriptions.count(event) > _prioritySubscriptions.count(event))
+            return socket.get();
+        return _prioritySocket.get();
+    }
+
+    void _bindPriorityLane(const URI& priorityURI)
+    {
+        // lane selection needs the number of subscribers on each lane
+        if (!detail::XPUB_COUNTS_SUBSCRIBERS ||
+            uri.getScheme() != DEFAULT_SCHEMA)
+            return;
+
+        zmq::SocketPtr lane(zmq_socket(detail::getContext().get(), ZMQ_XPUB),
+                            [](void* s) { ::zmq_close(s); });
+        const int hwm = 0;
+        zmq_setsockopt(lane.get(), ZMQ_SNDHWM, &hwm, sizeof(hwm));
+        _setVerbose(lane.get());
+
+        const std::string& zmqURI = buildZmqURI(priorityURI);
+        if (zmq_bind(lane.get(), zmqURI.c_str()) == -1)
+        {
+            ZEROEQWARN << "Cannot bind high priority publisher socket '"
+                       << zmqURI << "': " << zmq_strerror(zmq_errno())
+                       << std::endl;
+            return;
+        }
+
+        _prioritySocket = lane;
+        addProperty(KEY_PRIORITY_PORT,
+                    std::to_string(getBoundPort(_prioritySocket.get())));
+    }
 };
 
 Publisher::Publisher()
@@ -119,6 +679,11 @@ bool Publisher::publish(const servus::Serializable& serializable)
     return _impl->publish(serializable);
 }
 
+bool Publisher::hasSubscribers(const uint128_t& event)
+{
+    return _impl->hasSubscribers(event);
+}
+
 bool Publisher::publish(const uint128_t& event)
 {
     return _impl->publish(event, nullptr, 0);
@@ -130,11 +695,89 @@ bool Publisher::publish(const uint128_t& event, const void* data,
     return _impl->publish(event, data, size);
 }
 
+void Publisher::setFanOut(const size_t maxChildren)
+{
+    _impl->setFanOut(maxChildren);
+}
+
+size_t Publisher::getFanOut() const
+{
+    return _impl->getFanOut();
+}
+
+void Publisher::enableHistory(const std::string& directory,
+                              const uint64_t maxSize, const uint32_t maxAge)
+{
+    _impl->enableHistory(directory, maxSize, maxAge);
+}
+
+void Publisher::disableHistory()
+{
+    _impl->disableHistory();
+}
+
+bool Publisher::serveHistory(Server& server)
+{
+    return _impl->serveHistory(server);
+}
+
+bool Publisher::publish(const uint128_t& event,
+                        const servus::Serializable::Data& data)
+{
+    return _impl->publish(event, data.ptr.get(), data.size, data.ptr);
+}
+
+void Publisher::enableDeduplication(const size_t keyframeInterval)
+{
+    _impl->enableDeduplication(keyframeInterval);
+}
+
+void Publisher::disableDeduplication()
+{
+    _impl->disableDeduplication();
+}
+
+uint64_t Publisher::getNumSuppressed() const
+{
+    return _impl->getNumSuppressed();
+}
+
+void Publisher::enableDelta(const uint128_t& event,
+                            const size_t keyframeInterval)
+{
+    _impl->enableDelta(event, keyframeInterval);
+}
+
+void Publisher::disableDelta(const uint128_t& event)
+{
+    _impl->disableDelta(event);
+}
+
+void Publisher::setPriority(const uint128_t& event, const Priority priority)
+{
+    _impl->setPriority(event, priority);
+}
+
+Publisher::Priority Publisher::getPriority(const uint128_t& event) const
+{
+    return _impl->getPriority(event);
+}
+
 std::string Publisher::getAddress() const
 {
     return _impl->getAddress();
 }
 
+void Publisher::processSubscriptions()
+{
+    _impl->processSubscriptions();
+}
+
+void Publisher::setNotifier(const std::string& address)
+{
+    _impl->setNotifier(address);
+}
+
 const std::string& Publisher::getSession() const
 {
     return _impl->getSession();
@@ -26,6 +26,13 @@ namespace zeroeq
 class Publisher : public Sender
 {
 public:
+    /** Delivery lanes for published events, each using its own connection. */
+    enum Priority
+    {
+        PRIORITY_NORMAL, //!< Default lane, used for bulk payloads
+        PRIORITY_HIGH    //!< Lane for small, latency-sensitive events
+    };
+
     /**
      * Create a default publisher.
      *
@@ -86,7 +93,8 @@ public:
     /**
      * Publish the given serializable object to any subscriber.
      *
-     * If there is no subscriber for that serializable, no message will be sent.
+     * If there is no subscriber for that serializable and the history is not
+     * enabled, the object is neither serialized nor sent.
      *
      * @param serializable the object to publish
      * @return true if publish was successful
@@ -116,6 +124,158 @@ public:
     ZEROEQ_API bool publish(const uint128_t& event, const void* data,
                             size_t size);
 
+    /**
+     * Publish the given event with payload to any subscriber without copying
+     * the payload.
+     *
+     * The publisher keeps a reference on data.ptr until the payload has been
+     * sent, so the payload must not be modified until then. Payloads which are
+     * delta-encoded are copied.
+     *
+     * @param event the event identifier to publish
+     * @param data the payload data of the event
+     * @return true if publish was successful
+     */
+    ZEROEQ_API bool publish(const uint128_t& event,
+                            const servus::Serializable::Data& data);
+
+    /**
+     * Check if any subscriber is interested in the given event.
+     *
+     * The subscriptions are tracked from the subscription messages received
+     * from all connected subscribers. A new subscription may become visible
+     * only some time after the subscriber connected.
+     *
+     * @param event the event identifier
+     * @return true if at least one subscriber has subscribed to the event
+     */
+    ZEROEQ_API bool hasSubscribers(const uint128_t& event);
+
+    /**
+     * Enable suppression of unchanged payloads.
+     *
+     * When enabled, a hash of the last published payload is kept for each
+     * event, and publishing an identical payload again is silently dropped.
+     * The payload is sent again as soon as it changes, a new subscriber
+     * subscribes to the event or after keyframeInterval suppressed publishes.
+     * Events without payload are never suppressed.
+     *
+     * @param keyframeInterval the maximum number of consecutive suppressed
+     *        publishes of an event, 0 for unlimited
+     */
+    ZEROEQ_API void enableDeduplication(size_t keyframeInterval = 0);
+
+    /** Disable suppression of unchanged payloads. */
+    ZEROEQ_API void disableDeduplication();
+
+    /** @return the number of publishes suppressed by deduplication. */
+    ZEROEQ_API uint64_t getNumSuppressed() const;
+
+    /**
+     * Enable delta encoding for the given event.
+     *
+     * Instead of the full payload, the difference to the last keyframe is
+     * sent, which is efficient for large payloads changing only partially
+     * between publishes. Subscribers reconstruct the full payload before
+     * calling the event handler. A full keyframe is sent for the first
+     * publish, when a new subscriber subscribes to the event, after
+     * keyframeInterval deltas and whenever the delta is not smaller than the
+     * payload.
+     *
+     * @param event the event identifier
+     * @param keyframeInterval the maximum number of deltas sent between
+     *        keyframes, 0 for unlimited
+     */
+    ZEROEQ_API void enableDelta(const uint128_t& event,
+                                size_t keyframeInterval = 100);
+
+    /** Disable delta encoding for the given event. */
+    ZEROEQ_API void disableDelta(const uint128_t& event);
+
+    /**
+     * Set the delivery lane for the given event.
+     *
+     * Events with high priority are published on a separate connection, which
+     * is announced in the zeroconf record. A Subscriber processes all pending
+     * high priority events before any event from the normal lane, so that
+     * small interactive events are not queued behind large payloads.
+     *
+     * The high priority lane exists only for announced tcp publishers, with
+     * ZeroMQ 4.2 or later. Without it, all events are delivered on the normal
+     * lane. Subscribers using explicit URIs only connect to the normal lane,
+     * and high priority events are delivered on the normal lane to all
+     * subscribers while one of them is subscribed.
+     *
+     * @param event the event identifier
+     * @param priority the delivery lane for the event
+     */
+    ZEROEQ_API void setPriority(const uint128_t& event, Priority priority);
+
+    /** @return the delivery lane of the given event. */
+    ZEROEQ_API Priority getPriority(const uint128_t& event) const;
+
+    /**
+     * Limit the number of direct subscribers by forming a fan-out tree.
+     *
+     * Proxies, and subscribers once a publisher announced its fan-out tree,
+     * tell all publishers about their connections.
+     * When more than maxChildren nodes are connected to the publisher or to a
+     * Proxy, the last joined node is redirected to the highest proxy in the
+     * tree with a free slot, if any, which then re-publishes the events to
+     * it. The publisher is the root of its own tree, redirects are processed
+     * on publish(). Nodes are moved back when a proxy is destroyed, but not
+     * when it crashes. Redirected nodes drop their high priority lane and
+     * receive all events through the proxy.
+     *
+     * @param maxChildren the maximum number of nodes connected to the
+     *        publisher and each proxy, 0 to disable the fan-out tree
+     */
+    ZEROEQ_API void setFanOut(size_t maxChildren);
+
+    /** @return the maximum number of children in the fan-out tree. */
+    ZEROEQ_API size_t getFanOut() const;
+
+    /**
+     * Keep a persistent history of all published events.
+     *
+     * Each published event is appended to its history in segmented journal
+     * files in the given directory, and carries its per-event sequence number
+     * to the subscribers. An existing history in the directory is continued.
+     * When the history of an event exceeds maxSize or its oldest segment is
+     * older than maxAge, the oldest segment is deleted. Limits are applied when
+     * the history is opened, published to or served, and periodically to
+     * events which are no longer published. The newest segment of each event
+     * is kept to continue its sequence.
+     *
+     * @param directory the directory for the history files, created if needed
+     * @param maxSize the maximum size in bytes of the history of each event,
+     *        0 for unlimited
+     * @param maxAge the maximum age in seconds of history records, 0 for
+     *        unlimited
+     * @throw std::runtime_error if the history directory cannot be used
+     * @sa Subscriber::requestHistory()
+     */
+    ZEROEQ_API void enableHistory(const std::string& directory,
+                                  uint64_t maxSize = 1ull << 30,
+                                  uint32_t maxAge = 0);
+
+    /** Stop recording the history, keeping the existing files. */
+    ZEROEQ_API void disableHistory();
+
+    /**
+     * Serve history requests from Subscriber::requestHistory() on the given
+     * server.
+     *
+     * The server has to be valid during the lifetime of the publisher. History
+     * requests are served from the thread calling receive() on the server,
+     * which may run concurrently to publish(), enableHistory() and
+     * disableHistory(). A request in progress completes with the history it
+     * started with.
+     *
+     * @return false if the server already serves a history
+     */
+    ZEROEQ_API bool serveHistory(Server& server);
+
     /**
      * Get the publisher URI.
      *
@@ -130,6 +290,9 @@ public:
     ZEROEQ_API const std::string& getSession() const;
 
     ZEROEQ_API std::string getAddress() const; //!< @internal
+    ZEROEQ_API void processSubscriptions();      //!< @internal
+    /** @internal Signal new subscribers to the given inproc address */
+    ZEROEQ_API void setNotifier(const std::string& address);
 
 private:
     class Impl;
@@ -44,15 +44,14 @@ public:
         const auto startTime = high_resolution_clock::now();
         while (true)
         {
-            for (::zeroeq::Receiver* receiver : _shared)
-                receiver->update();
+            const uint32_t update = _update();
 
             const auto endTime = high_resolution_clock::now();
             const uint32_t elapsed =
                 nanoseconds(endTime - startTime).count() / 1000000;
             uint32_t wait = 0;
             if (elapsed < timeout)
-                wait = std::min(timeout - uint32_t(elapsed), block);
+                wait = std::min({timeout - uint32_t(elapsed), block, update});
 
             if (_receive(wait))
                 return true;
@@ -72,16 +71,27 @@ private:
     {
         while (true)
         {
-            for (::zeroeq::Receiver* receiver : _shared)
-                receiver->update();
+            const uint32_t update = _update();
 
             // Never fully block. Give receivers a chance to update, e.g., to
             // check for new connections from zeroconf (#20)
-            if (_receive(1000))
+            if (_receive(std::min(1000u, update)))
                 return true;
         }
     }
 
+    /** Update all receivers. @return the time until the next update. */
+    uint32_t _update()
+    {
+        uint32_t timeout = TIMEOUT_INDEFINITE;
+        for (::zeroeq::Receiver* receiver : _shared)
+        {
+            receiver->update();
+            timeout = std::min(timeout, receiver->getUpdateTimeout());
+        }
+        return timeout;
+    }
+
     bool _receive(uint32_t timeout)
     {
         // ZMQ notifications on its sockets is edge-triggered, hence we have
@@ -103,9 +113,11 @@ private:
                 intervals.push_back(sockets.size() - before);
             }
 
-            const auto remaining = duration_cast<milliseconds>(
-                                       high_resolution_clock::now() - startTime)
-                                       .count();
+            const auto elapsed = duration_cast<milliseconds>(
+                                     high_resolution_clock::now() - startTime)
+                                     .count();
+            const long remaining =
+                elapsed < long(timeout) ? long(timeout) - elapsed : 0;
 
             switch (zmq_poll(sockets.data(), int(sockets.size()), remaining))
             {
@@ -184,9 +196,10 @@ bool Receiver::receive(const uint32_t timeout)
 }
 
 // LCOV_EXCL_START
-void Receiver::addConnection(const std::string&)
+bool Receiver::addConnection(const std::string&)
 {
     ZEROEQDONTCALL;
+    return false;
 }
 // LCOV_EXCL_STOP
 }
@@ -88,12 +88,21 @@ protected:
      */
     virtual void update() {}
 
+    /**
+     * @return the time in ms until update() has to be called next, e.g., for
+     *         a pending timeout, or TIMEOUT_INDEFINITE if not needed. Limits
+     *         the blocking time of receive() on the shared group.
+     */
+    virtual uint32_t getUpdateTimeout() const { return TIMEOUT_INDEFINITE; }
+
     /**
      * Add the given connection to the list of receiving sockets.
      *
      * @param uri the ZeroMQ address to connect to.
+     * @return true if the connection was added or already exists, false if
+     *         the address cannot be connected.
      */
-    ZEROEQ_API virtual void addConnection(const std::string& uri);
+    ZEROEQ_API virtual bool addConnection(const std::string& uri);
     friend class connection::detail::Broker;
 
 private:
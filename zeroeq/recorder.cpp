@@ -0,0 +1,81 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include "recorder.h"
+
+#include "detail/journal.h"
+#include "log.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace zeroeq
+{
+class Recorder::Impl
+{
+public:
+    explicit Impl(const std::string& filename)
+        : _journal(filename)
+    {
+    }
+
+    bool record(const uint128_t& event, const void* data, const size_t size)
+    {
+        // keep timestamps monotonic for seeking, even if the clock is reset
+        const auto now = std::chrono::system_clock::now().time_since_epoch();
+        _timestamp = std::max(
+            _timestamp,
+            uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(now)
+                         .count()));
+        try
+        {
+            _journal.append(_timestamp, event, data, size);
+            return true;
+        }
+        catch (const std::runtime_error& e)
+        {
+            ZEROEQWARN << "Cannot record event: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    detail::JournalWriter _journal;
+
+private:
+    uint64_t _timestamp{0};
+};
+
+Recorder::Recorder(const std::string& filename)
+    : _impl(new Impl(filename))
+{
+}
+
+Recorder::~Recorder()
+{
+}
+
+bool Recorder::record(const uint128_t& event, const void* data,
+                      const size_t size)
+{
+    return _impl->record(event, data, size);
+}
+
+EventPayloadFunc Recorder::getRecordFunc(const uint128_t& event)
+{
+    Impl* impl = _impl.get();
+    return [impl, event](const void* data, const size_t size) {
+        impl->record(event, data, size);
+    };
+}
+
+size_t Recorder::getNumRecords() const
+{
+    return _impl->_journal.getNumRecords();
+}
+
+void Recorder::flush()
+{
+    _impl->_journal.flush();
+}
+}
@@ -0,0 +1,72 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include <zeroeq/api.h>
+#include <zeroeq/types.h>
+
+#include <memory>
+#include <string>
+
+namespace zeroeq
+{
+/**
+ * Records events into a journal file for later replay by a Player.
+ *
+ * The journal is a memory-mapped, append-only file of (timestamp, event,
+ * payload) records with a compact index in a '<filename>.index' file. Events
+ * are recorded directly using record(), or by subscribing the function
+ * returned by getRecordFunc() to a Subscriber.
+ *
+ * Not thread safe.
+ *
+ * Example: @include tests/journal.cpp
+ */
+class Recorder
+{
+public:
+    /**
+     * Create a recorder writing a new journal.
+     *
+     * Existing journal and index files are replaced.
+     *
+     * @param filename the path of the journal
+     * @throw std::runtime_error if the journal cannot be created
+     */
+    ZEROEQ_API explicit Recorder(const std::string& filename);
+
+    /** Close the journal. */
+    ZEROEQ_API ~Recorder();
+
+    /**
+     * Append the given event with the current time to the journal.
+     *
+     * @return true if the event was recorded, false if the journal cannot be
+     *         grown
+     */
+    ZEROEQ_API bool record(const uint128_t& event, const void* data,
+                           size_t size);
+
+    /**
+     * @return a function recording the given event, e.g., for
+     *         Subscriber::subscribe(). Valid during the lifetime of the
+     *         recorder.
+     */
+    ZEROEQ_API EventPayloadFunc getRecordFunc(const uint128_t& event);
+
+    /** @return the number of recorded events. */
+    ZEROEQ_API size_t getNumRecords() const;
+
+    /** Schedule the write-back of the journal to disk. */
+    ZEROEQ_API void flush();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> _impl;
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+};
+}
@@ -1,27 +1,94 @@
-
 /* Copyright (c) 2017, Human Brain Project
  *                     Stefan.Eilemann@epfl.ch
  */
 
 #include "server.h"
 
+#include "detail/byteswap.h"
+#include "detail/hash.h"
+#include "detail/message.h"
 #include "detail/receiver.h"
+#include "detail/replyCache.h"
 #include "detail/sender.h"
 
 #include <zmq.h>
 
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <limits>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace zeroeq
 {
+namespace
+{
+const size_t maxRequests = 1000; // received per process() call
+
+uint64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/** Replies of asynchronous handlers, which may complete on any thread. */
+struct ReplyQueue
+{
+    std::mutex mutex;
+    std::vector<std::pair<uint64_t, ReplyData>> replies; // by flight
+    zmq::SocketPtr wakeup; // signals the server, reset on its destruction
+
+    void push(const uint64_t flight, const ReplyData& reply)
+    {
+        const ReplyData copy = detail::ReplyCache::copy(reply);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!wakeup)
+            return;
+        replies.emplace_back(flight, copy);
+        if (replies.size() == 1) // server drains the queue on each signal
+            zmq_send(wakeup.get(), nullptr, 0, ZMQ_DONTWAIT);
+    }
+};
+
+/**
+ * Completes a flight once, shared by all copies of its reply function. The
+ * flight fails if the last copy is destroyed without having been called.
+ */
+class Completion
+{
+public:
+    Completion(const std::shared_ptr<ReplyQueue>& queue, const uint64_t flight)
+        : _queue(queue)
+        , _flight(flight)
+    {
+    }
+
+    ~Completion() { reply(ReplyData()); }
+
+    void reply(const ReplyData& data)
+    {
+        if (!_done.exchange(true))
+            _queue->push(_flight, data);
+    }
+
+private:
+    const std::shared_ptr<ReplyQueue> _queue;
+    const uint64_t _flight;
+    std::atomic<bool> _done{false};
+};
+}
+
 class Server::Impl : public detail::Sender
 {
 public:
     Impl(const URI& uri_, const std::string& session)
-        : detail::Sender(uri_, ZMQ_REP, SERVER_SERVICE,
+        : detail::Sender(uri_, ZMQ_ROUTER, SERVER_SERVICE,
                          session == DEFAULT_SESSION ? getDefaultRepSession()
                                                     : session)
+        , _queue(std::make_shared<ReplyQueue>())
     {
         if (session.empty())
             ZEROEQTHROW(
@@ -33,84 +100,544 @@ public:
                 std::runtime_error(std::string("Cannot bind server socket '") +
                                    zmqURI + "': " + zmq_strerror(zmq_errno())));
         initURI();
+        _initReplyQueue();
         if (session != NULL_SESSION)
             announce();
     }
 
-    ~Impl() {}
+    ~Impl()
+    {
+        std::lock_guard<std::mutex> lock(_queue->mutex);
+        _queue->wakeup.reset();
+        _queue->replies.clear();
+    }
 
     bool handle(const uint128_t& request, const HandleFunc& func)
     {
-        if (_handlers.find(request) != _handlers.end())
+        if (_isHandled(request))
             return false;
-
         _handlers[request] = func;
         return true;
     }
 
+    bool handleBatch(const uint128_t& request, const BatchHandleFunc& func)
+    {
+        if (_isHandled(request))
+            return false;
+        _batchHandlers[request] = func;
+        return true;
+    }
+
+    bool handleAsync(const uint128_t& request, const AsyncHandleFunc& func)
+    {
+        if (_isHandled(request))
+            return false;
+        _asyncHandlers[request] = func;
+        return true;
+    }
+
     bool remove(const uint128_t& request)
     {
-        return _handlers.erase(request) > 0;
+        disableCache(request);
+        disableCoalescing(request);
+        return _handlers.erase(request) + _batchHandlers.erase(request) +
+                   _asyncHandlers.erase(request) >
+               0;
     }
 
-    bool process(detail::Socket&)
+    bool enableCache(const uint128_t& request, const uint32_t ttl)
     {
-        uint128_t requestID;
-        const bool payload = _recv(&requestID, sizeof(requestID));
+        if (_handlers.find(request) == _handlers.end())
+            return false;
+        _cached[request] = ttl;
+        return true;
+    }
 
+    bool disableCache(const uint128_t& request)
+    {
+        _cache.invalidate(request);
+        return _cached.erase(request) > 0;
+    }
+
+    void invalidate(const uint128_t& request) { _cache.invalidate(request); }
+    void invalidate(const uint128_t& request, const void* data,
+                    const size_t size)
+    {
+        _cache.invalidate(request, detail::hash128(data, size));
+    }
+
+    void setCacheSize(const size_t bytes) { _cache.setMaxSize(bytes); }
+    size_t getCacheSize() const { return _cache.getMaxSize(); }
+
+    CacheStats getCacheStats() const
+    {
+        CacheStats stats;
+        stats.hits = _cache.getNumHits();
+        stats.misses = _cache.getNumMisses();
+        stats.evictions = _cache.getNumEvictions();
+        stats.entries = _cache.getNumEntries();
+        stats.size = _cache.getSize();
+        return stats;
+    }
+
+    bool enableCoalescing(const uint128_t& request)
+    {
+        if (_handlers.find(request) == _handlers.end() &&
+            _asyncHandlers.find(request) == _asyncHandlers.end())
+        {
+            return false;
+        }
+        _coalesced.insert(request);
+        return true;
+    }
+
+    bool disableCoalescing(const uint128_t& request)
+    {
+        return _coalesced.erase(request) > 0;
+    }
+
+    uint64_t getNumCoalesced() const { return _numCoalesced; }
+
+    void addSockets(std::vector<detail::Socket>& entries)
+    {
+        detail::Sender::addSockets(entries);
+
+        detail::Socket entry;
+        entry.socket = _wakeup.get();
+        entry.events = ZMQ_POLLIN;
+        entries.push_back(entry);
+    }
+
+    bool process(detail::Socket& entry)
+    {
+        if (entry.socket == _wakeup.get())
+            return _processReplies();
+
+        // Identical requests received together are executed once
+        Groups groups;
+        std::unordered_map<Key, size_t, KeyHash> index;
+
+        size_t received = 0;
+        for (; received < maxRequests; ++received)
+        {
+            Request request;
+            if (!request.message.recv(socket.get(), ZMQ_DONTWAIT))
+                break;
+            if (!_parse(request))
+            {
+                ZEROEQWARN << "Dropping malformed request" << std::endl;
+                continue;
+            }
+
+            if (request.batchSize > 0)
+            {
+                _processBatch(request);
+                continue;
+            }
+
+            auto async = _asyncHandlers.find(request.id);
+            if (async != _asyncHandlers.end())
+            {
+                _processAsync(std::move(request), async->second);
+                continue;
+            }
+
+            if (!_coalesced.count(request.id) || !_handlers.count(request.id))
+            {
+                _processRequest(request);
+                continue;
+            }
+
+            const Key key(request.id,
+                          detail::hash128(request.data, request.size));
+            const auto i = index.emplace(key, groups.size());
+            if (i.second)
+                groups.emplace_back();
+            else
+                ++_numCoalesced;
+            groups[i.first->second].push_back(std::move(request));
+        }
+
+        for (Requests& group : groups)
+            _processGroup(group);
+        return received > 0;
+    }
+
+private:
+    using Key = detail::ReplyCache::Key;
+    using KeyHash = detail::ReplyCache::KeyHash;
+
+    /** A request, [envelope...][empty][header][payload...] on the wire. */
+    struct Request
+    {
+        detail::Message message;
+        size_t header{0}; // frame index, preceded by the reply envelope
+        uint128_t id;
+        uint32_t batchSize{0};
+        const void* data{nullptr}; // payload of a single request
+        size_t size{0};
+    };
+    using Requests = std::vector<Request>;
+    using Groups = std::vector<Requests>;
+
+    /** Requests executed by an asynchronous handler, waiting for its reply. */
+    struct Flight
+    {
+        Requests requests; // the first one was passed to the handler
+        bool coalesced{false};
+        Key key;
+    };
+
+    void _initReplyQueue()
+    {
+        void* context = detail::getContext().get();
+        const auto inproc = std::string("inproc://zeroeq.server.") +
+                            servus::make_UUID().getString();
+        _wakeup.reset(::zmq_socket(context, ZMQ_PULL),
+                      [](void* s) { ::zmq_close(s); });
+        zmq::SocketPtr wakeup(::zmq_socket(context, ZMQ_PUSH),
+                              [](void* s) { ::zmq_close(s); });
+        if (::zmq_bind(_wakeup.get(), inproc.c_str()) != 0 ||
+            ::zmq_connect(wakeup.get(), inproc.c_str()) != 0)
+        {
+            ZEROEQTHROW(std::runtime_error(
+                std::string("Cannot create inproc socket: ") +
+                zmq_strerror(zmq_errno())));
+        }
+        _queue->wakeup = wakeup;
+    }
+
+    bool _isHandled(const uint128_t& request) const
+    {
+        return _handlers.find(request) != _handlers.end() ||
+               _batchHandlers.find(request) != _batchHandlers.end() ||
+               _asyncHandlers.find(request) != _asyncHandlers.end();
+    }
+
+    /**
+     * Parse the request ID, followed by the number of requests for a batch.
+     * @return false if the request is malformed
+     */
+    bool _parse(Request& request)
+    {
+        detail::Message& message = request.message;
+        const size_t numFrames = message.getNumFrames();
+        size_t delimiter = 0;
+        while (delimiter < numFrames && message.getSize(delimiter) > 0)
+            ++delimiter;
+
+        request.header = delimiter + 1;
+        if (request.header >= numFrames)
+            return false;
+
+        const size_t size = message.getSize(request.header);
+        if (size != sizeof(request.id) &&
+            size != sizeof(request.id) + sizeof(request.batchSize))
+        {
+            return false;
+        }
+
+        const uint8_t* data =
+            static_cast<const uint8_t*>(message.getData(request.header));
+        memcpy(&request.id, data, sizeof(request.id));
+        if (size > sizeof(request.id))
+            memcpy(&request.batchSize, data + sizeof(request.id),
+                   sizeof(request.batchSize));
 #ifdef ZEROEQ_BIGENDIAN
-        detail::byteswap(requestID); // convert from little endian wire protocol
+        detail::byteswap(request.id); // convert from little endian wire format
+        detail::byteswap(request.batchSize);
 #endif
 
-        zmq_msg_t msg;
-        if (payload)
+        // one payload frame per request of a batch, at most one otherwise
+        const size_t numPayloads = numFrames - request.header - 1;
+        if (size > sizeof(request.id) ? numPayloads != request.batchSize
+                                      : numPayloads > 1)
+        {
+            return false;
+        }
+
+        if (numPayloads == 1)
+        {
+            request.data = message.getData(request.header + 1);
+            request.size = message.getSize(request.header + 1);
+        }
+        return true;
+    }
+
+    void _processRequest(Request& request)
+    {
+        auto i = _handlers.find(request.id);
+        if (i == _handlers.cend())
         {
-            zmq_msg_init(&msg);
-            zmq_msg_recv(&msg, socket.get(), 0);
+            if (_batchHandlers.count(request.id))
+            {
+                const Payloads payloads{Payload{request.data, request.size}};
+                std::vector<char> cached;
+                const std::vector<ReplyData>& replies =
+                    _executeBatch(request.id, payloads, cached);
+                _reply(request, replies.front(), cached.front());
+                return;
+            }
+
+            _reply(request, ReplyData(), false); // no handler, return "0"
+            return;
         }
 
-        auto i = _handlers.find(requestID);
-        if (i == _handlers.cend()) // no handler, return "0"
+        try
+        {
+            bool cached = false;
+            const ReplyData& reply = _execute(request.id, i->second,
+                                              request.data, request.size,
+                                              cached);
+            _reply(request, reply, cached);
+        }
+        catch (...) // handler had exception
         {
-            const uint128_t zero;
-            _send(&zero, sizeof(zero), 0); // request and reply, no playload
+            _reply(request, ReplyData(), false);
         }
-        else
+    }
+
+    /** Execute identical requests once, replying to all of them. */
+    void _processGroup(Requests& requests)
+    {
+        Request& first = requests.front();
+        auto i = _handlers.find(first.id);
+        bool owned = false;
+        ReplyData reply;
+        if (i != _handlers.cend())
         {
             try
             {
-                auto reply =
-                    payload ? i->second(zmq_msg_data(&msg), zmq_msg_size(&msg))
-                            : i->second(nullptr, 0);
-                const bool hasReplyData = reply.second.ptr && reply.second.size;
-#ifdef ZEROEQ_BIGENDIAN
-                detail::byteswap(reply.first); // convert to little endian
-#endif
-                if (_send(&reply.first, sizeof(reply.first),
-                          hasReplyData ? ZMQ_SNDMORE : 0) &&
-                    hasReplyData)
-                {
-                    _send(reply.second.ptr.get(), reply.second.size, 0);
-                }
+                reply = _execute(first.id, i->second, first.data, first.size,
+                                 owned);
             }
             catch (...) // handler had exception
             {
-                const uint128_t zero;
-                _send(&zero, sizeof(zero), 0); // request and reply, no playload
+                reply = ReplyData();
             }
         }
 
-        if (payload)
-            zmq_msg_close(&msg);
+        if (!owned && requests.size() > 1) // send the data once, not copied
+        {
+            reply = detail::ReplyCache::copy(reply);
+            owned = true;
+        }
+        for (Request& request : requests)
+            _reply(request, reply, owned);
+    }
+
+    void _processAsync(Request&& request, const AsyncHandleFunc& func)
+    {
+        const bool coalesced = _coalesced.count(request.id) > 0;
+        Key key;
+        if (coalesced)
+        {
+            key = Key(request.id, detail::hash128(request.data, request.size));
+            const auto i = _inFlight.find(key);
+            if (i != _inFlight.end()) // attach to the running execution
+            {
+                _flights[i->second].requests.push_back(std::move(request));
+                ++_numCoalesced;
+                return;
+            }
+        }
+
+        const uint64_t id = ++_lastFlight;
+        const void* data = request.data;
+        const size_t size = request.size;
+        Flight& flight = _flights[id];
+        flight.requests.push_back(std::move(request));
+        flight.coalesced = coalesced;
+        flight.key = key;
+        if (coalesced)
+            _inFlight[key] = id;
+
+        const auto completion = std::make_shared<Completion>(_queue, id);
+        try
+        {
+            func(data, size, [completion](const ReplyData& reply) {
+                completion->reply(reply);
+            });
+        }
+        catch (...) // handler had exception
+        {
+            completion->reply(ReplyData());
+        }
+    }
+
+    /** @return true if replies of asynchronous handlers were sent. */
+    bool _processReplies()
+    {
+        char signal;
+        while (zmq_recv(_wakeup.get(), &signal, sizeof(signal),
+                        ZMQ_DONTWAIT) != -1)
+        {
+        }
+
+        std::vector<std::pair<uint64_t, ReplyData>> replies;
+        {
+            std::lock_guard<std::mutex> lock(_queue->mutex);
+            replies.swap(_queue->replies);
+        }
+
+        for (const auto& reply : replies)
+        {
+            auto i = _flights.find(reply.first);
+            if (i == _flights.end())
+                continue;
+
+            if (i->second.coalesced)
+                _inFlight.erase(i->second.key);
+            Requests requests = std::move(i->second.requests);
+            _flights.erase(i);
+
+            for (Request& request : requests) // reply data is owned by queue
+                _reply(request, reply.second, true);
+        }
+        return !replies.empty();
+    }
+
+    void _processBatch(Request& request)
+    {
+        detail::Message& message = request.message;
+        Payloads payloads;
+        payloads.reserve(message.getNumFrames() - request.header - 1);
+        for (size_t i = request.header + 1; i < message.getNumFrames(); ++i)
+        {
+            const size_t size = message.getSize(i);
+            payloads.push_back({size ? message.getData(i) : nullptr, size});
+        }
+
+        std::vector<char> cached;
+        const std::vector<ReplyData>& replies =
+            _executeBatch(request.id, payloads, cached);
+
+        if (!_sendEnvelope(request))
+            return;
+        for (size_t i = 0; i < replies.size(); ++i)
+            if (!_sendReply(replies[i], i + 1 < replies.size(), true,
+                            cached[i]))
+            {
+                _closeReply();
+                return;
+            }
+    }
+
+    /**
+     * Execute a batch of requests, or a single request with a batch handler.
+     * Failed requests are replied with "0".
+     *
+     * @param cached set to true for the replies owned by the cache
+     */
+    std::vector<ReplyData> _executeBatch(const uint128_t& requestID,
+                                         const Payloads& payloads,
+                                         std::vector<char>& cached)
+    {
+        std::vector<ReplyData> replies(payloads.size());
+        cached.assign(payloads.size(), false);
+        auto i = _batchHandlers.find(requestID);
+        if (i != _batchHandlers.cend())
+        {
+            try
+            {
+                std::vector<ReplyData> results = i->second(payloads);
+                if (results.size() == payloads.size())
+                    replies = std::move(results);
+                else
+                    ZEROEQWARN << "Batch handler returned " << results.size()
+                               << " replies for " << payloads.size()
+                               << " requests" << std::endl;
+            }
+            catch (...) // handler had exception
+            {
+            }
+            return replies;
+        }
+
+        auto j = _handlers.find(requestID);
+        for (size_t k = 0; j != _handlers.cend() && k < payloads.size(); ++k)
+        {
+            try
+            {
+                bool hit = false;
+                replies[k] = _execute(requestID, j->second, payloads[k].data,
+                                      payloads[k].size, hit);
+                cached[k] = hit;
+            }
+            catch (...) // handler had exception
+            {
+            }
+        }
+        return replies;
+    }
+
+    /**
+     * Call the handler, or serve its reply from the cache if it is cached.
+     * @param cached set to true if the reply is owned by the cache
+     */
+    ReplyData _execute(const uint128_t& requestID, const HandleFunc& func,
+                       const void* data, const size_t size, bool& cached)
+    {
+        const auto ttl = _cached.find(requestID);
+        if (ttl == _cached.end())
+            return func(data, size);
+
+        const uint128_t hash = detail::hash128(data, size);
+        const uint64_t time = now();
+        if (const ReplyData* reply = _cache.get(requestID, hash, time))
+        {
+            cached = true;
+            return *reply;
+        }
+
+        const ReplyData reply = func(data, size);
+        if (reply.first == uint128_t()) // failed request, not cached
+            return reply;
+
+        const uint64_t expires =
+            ttl->second == TIMEOUT_INDEFINITE
+                ? std::numeric_limits<uint64_t>::max()
+                : time + uint64_t(ttl->second) * 1000;
+        const ReplyData* copy = _cache.put(requestID, hash, reply, expires);
+        if (!copy)
+            return reply;
+        cached = true;
+        return *copy;
+    }
+
+    /**
+     * Send [reply ID][reply data], the data frame is omitted if empty unless
+     * it is part of a batch reply. Cached data is sent without copying.
+     */
+    bool _sendReply(ReplyData reply, const bool more, const bool batch,
+                    const bool cached)
+    {
+        const bool hasReplyData = reply.second.ptr && reply.second.size;
+#ifdef ZEROEQ_BIGENDIAN
+        detail::byteswap(reply.first); // convert to little endian
+#endif
+        if (!_send(&reply.first, sizeof(reply.first),
+                   hasReplyData || batch ? ZMQ_SNDMORE : 0))
+        {
+            return false;
+        }
+        if (hasReplyData && cached)
+            return _send(reply.second.ptr, reply.second.size,
+                         more ? ZMQ_SNDMORE : 0);
+        if (hasReplyData)
+            return _send(reply.second.ptr.get(), reply.second.size,
+                         more ? ZMQ_SNDMORE : 0);
+        if (batch)
+            return _send(nullptr, 0, more ? ZMQ_SNDMORE : 0);
         return true;
     }
 
-private:
     bool _send(const void* data, const size_t size, const int flags)
     {
         zmq_msg_t msg;
         zmq_msg_init_size(&msg, size);
-        ::memcpy(zmq_msg_data(&msg), data, size);
+        if (data)
+            ::memcpy(zmq_msg_data(&msg), data, size);
         int ret = zmq_msg_send(&msg, socket.get(), flags);
         zmq_msg_close(&msg);
 
@@ -122,27 +649,79 @@ private:
         return false;
     }
 
-    /** @return true if more data available */
-    bool _recv(void* data, const size_t size)
+    /** Send without copy, holding a reference on data until sent. */
+    bool _send(const std::shared_ptr<const void>& data, const size_t size,
+               const int flags)
     {
+        auto* ref = new std::shared_ptr<const void>(data);
         zmq_msg_t msg;
-        zmq_msg_init(&msg);
-        zmq_msg_recv(&msg, socket.get(), 0);
-        if (zmq_msg_size(&msg) != size)
+        if (zmq_msg_init_data(&msg, const_cast<void*>(data.get()), size,
+                              [](void*, void* hint) {
+                                  delete static_cast<
+                                      std::shared_ptr<const void>*>(hint);
+                              },
+                              ref) == -1)
         {
-            ZEROEQTHROW(std::runtime_error(
-                std::string("Message size mismatch, expected ") +
-                std::to_string(size) + " got " +
-                std::to_string(zmq_msg_size(&msg))));
+            delete ref;
+            return false;
         }
-        else
-            memcpy(data, zmq_msg_data(&msg), size);
-        const bool more = zmq_msg_more(&msg);
+        const int ret = zmq_msg_send(&msg, socket.get(), flags);
         zmq_msg_close(&msg);
-        return more;
+
+        if (ret != -1)
+            return true;
+
+        ZEROEQWARN << "Cannot send reply: " << zmq_strerror(zmq_errno())
+                   << std::endl;
+        return false;
+    }
+
+    /**
+     * Send the envelope routing the reply to the client. A partially sent
+     * envelope is closed.
+     */
+    bool _sendEnvelope(Request& request)
+    {
+        if (request.message.send(socket.get(), 0, request.header, ZMQ_SNDMORE))
+            return true;
+
+        ZEROEQWARN << "Cannot send reply: " << zmq_strerror(zmq_errno())
+                   << std::endl;
+        _closeReply();
+        return false;
+    }
+
+    /**
+     * Terminate a partially sent reply with an empty frame, so the next reply
+     * is not appended to it. The client fails the truncated requests.
+     */
+    void _closeReply() { zmq_send(socket.get(), nullptr, 0, ZMQ_DONTWAIT); }
+
+    /** Send the reply to a single request, see _sendReply(). */
+    bool _reply(Request& request, const ReplyData& reply, const bool owned)
+    {
+        if (!_sendEnvelope(request))
+            return false;
+        if (_sendReply(reply, false, false, owned))
+            return true;
+        _closeReply();
+        return false;
     }
 
     std::unordered_map<uint128_t, HandleFunc> _handlers;
+    std::unordered_map<uint128_t, BatchHandleFunc> _batchHandlers;
+    std::unordered_map<uint128_t, AsyncHandleFunc> _asyncHandlers;
+    std::unordered_map<uint128_t, uint32_t> _cached; // TTL by request
+    detail::ReplyCache _cache;
+
+    std::unordered_set<uint128_t> _coalesced;
+    std::unordered_map<uint64_t, Flight> _flights;
+    std::unordered_map<Key, uint64_t, KeyHash> _inFlight; // coalesced flights
+    uint64_t _lastFlight{0};
+    uint64_t _numCoalesced{0};
+
+    std::shared_ptr<ReplyQueue> _queue;
+    zmq::SocketPtr _wakeup; // receives the signals of _queue
 };
 
 Server::Server()
@@ -215,7 +794,7 @@ bool Server::process(detail::Socket& socket)
     return _impl->process(socket);
 }
 
-void Server::addConnection(const std::string&)
+bool Server::addConnection(const std::string&)
 {
     ZEROEQTHROW(std::runtime_error("Server cannot add connections"));
 }
@@ -230,11 +809,72 @@ bool Server::handle(const uint128_t& request, const HandleFunc& func)
     return _impl->handle(request, func);
 }
 
+bool Server::handleBatch(const uint128_t& request, const BatchHandleFunc& func)
+{
+    return _impl->handleBatch(request, func);
+}
+
+bool Server::handleAsync(const uint128_t& request, const AsyncHandleFunc& func)
+{
+    return _impl->handleAsync(request, func);
+}
+
 bool Server::remove(const uint128_t& request)
 {
     return _impl->remove(request);
 }
 
+bool Server::enableCache(const uint128_t& request, const uint32_t ttl)
+{
+    return _impl->enableCache(request, ttl);
+}
+
+bool Server::disableCache(const uint128_t& request)
+{
+    return _impl->disableCache(request);
+}
+
+void Server::invalidate(const uint128_t& request)
+{
+    _impl->invalidate(request);
+}
+
+void Server::invalidate(const uint128_t& request, const void* data,
+                        const size_t size)
+{
+    _impl->invalidate(request, data, size);
+}
+
+void Server::setCacheSize(const size_t bytes)
+{
+    _impl->setCacheSize(bytes);
+}
+
+size_t Server::getCacheSize() const
+{
+    return _impl->getCacheSize();
+}
+
+Server::CacheStats Server::getCacheStats() const
+{
+    return _impl->getCacheStats();
+}
+
+bool Server::enableCoalescing(const uint128_t& request)
+{
+    return _impl->enableCoalescing(request);
+}
+
+bool Server::disableCoalescing(const uint128_t& request)
+{
+    return _impl->disableCoalescing(request);
+}
+
+uint64_t Server::getNumCoalesced() const
+{
+    return _impl->getNumCoalesced();
+}
+
 zmq::SocketPtr Server::getSocket()
 {
     return _impl->socket;
@@ -15,6 +15,10 @@ namespace zeroeq
 /**
  * Serves request from one or more Client(s).
  *
+ * Requests of all clients are received and replied independently of each
+ * other: handlers registered by handleAsync() reply later, while the server
+ * keeps serving other requests.
+ *
  * The session is tied to ZeroConf announcement and can be disabled by passing
  * zeroeq::NULL_SESSION as the session name.
  *
@@ -23,6 +27,16 @@ namespace zeroeq
 class Server : public Receiver, public Sender
 {
 public:
+    /** Statistics of the reply cache. */
+    struct CacheStats
+    {
+        uint64_t hits{0};      //!< replies served from the cache
+        uint64_t misses{0};    //!< requests of cached handlers executed
+        uint64_t evictions{0}; //!< replies evicted for space
+        size_t entries{0};     //!< cached replies
+        size_t size{0};        //!< size of the cached replies in bytes
+    };
+
     /**
      * Create a default server.
      *
@@ -160,6 +174,46 @@ public:
      */
     ZEROEQ_API bool handle(const uint128_t& request, const HandleFunc& func);
 
+    /**
+     * Register a handler for batches of requests.
+     *
+     * The handler is called with all payloads of a batch sent by
+     * Client::request(const uint128_t&, const Payloads&, ...), e.g., to
+     * vectorize lookups, and returns one reply per payload. Single requests
+     * are passed as a batch of one. Batches for requests with a handler
+     * registered by handle() call it once per payload.
+     *
+     * Exceptions in a request handler, or a wrong number of replies, are
+     * considered an error (0 is returned for all requests of the batch).
+     *
+     * @param request the request to handle
+     * @param func the function to call on receive() of a batch of requests
+     * @return true if subscription was successful, false otherwise
+     */
+    ZEROEQ_API bool handleBatch(const uint128_t& request,
+                                const BatchHandleFunc& func);
+
+    /**
+     * Register an asynchronous request handler.
+     *
+     * The handler starts serving the request and calls the given reply
+     * function once it is done, from any thread, e.g., after a backend has
+     * answered. The reply data is copied by the reply function, and the reply
+     * is sent by receive() on the thread of the server. Other requests are
+     * served in the meantime.
+     *
+     * Exceptions in the handler are considered an error (0 is returned to the
+     * client), as is destroying the reply function without calling it. Only
+     * the first call of the reply function is sent. Batches of requests are
+     * not served by asynchronous handlers.
+     *
+     * @param request the request to handle
+     * @param func the function to call on receive() of a Client::request()
+     * @return true if subscription was successful, false otherwise
+     */
+    ZEROEQ_API bool handleAsync(const uint128_t& request,
+                                const AsyncHandleFunc& func);
+
     /**
      * Remove a registered request handler.
      *
@@ -167,6 +221,76 @@ public:
      */
     ZEROEQ_API bool remove(const uint128_t& request);
 
+    /**
+     * Cache the replies of the handler of the given request.
+     *
+     * The handler has to be a pure function of the request payload. Its
+     * replies are cached by request and payload hash, and served from the
+     * cache without executing the handler and without copying the reply data
+     * until they expire, are invalidated or are evicted. Only successful
+     * replies, with a non-zero reply ID, are cached. Requests in batches are
+     * cached individually, batch handlers are not cached.
+     *
+     * @param request the request of a handler registered by handle()
+     * @param ttl the time to live of the cached replies in milliseconds, or
+     *        TIMEOUT_INDEFINITE
+     * @return true if caching was enabled, false if there is no handler
+     */
+    ZEROEQ_API bool enableCache(const uint128_t& request,
+                                uint32_t ttl = TIMEOUT_INDEFINITE);
+
+    /**
+     * Stop caching the replies of the given request, removing its replies.
+     *
+     * @return true if the replies of the request were cached
+     */
+    ZEROEQ_API bool disableCache(const uint128_t& request);
+
+    /** Remove all cached replies of the given request. */
+    ZEROEQ_API void invalidate(const uint128_t& request);
+
+    /** Remove the cached reply of the given request and payload. */
+    ZEROEQ_API void invalidate(const uint128_t& request, const void* data,
+                               size_t size);
+
+    /**
+     * Set the maximum size of the cached replies, evicting the least
+     * recently used ones. Each reply accounts for its data and a fixed
+     * bookkeeping overhead. The default is 64 MB.
+     */
+    ZEROEQ_API void setCacheSize(size_t bytes);
+
+    /** @return the maximum size of the cached replies. */
+    ZEROEQ_API size_t getCacheSize() const;
+
+    /** @return the statistics of the reply cache. */
+    ZEROEQ_API CacheStats getCacheStats() const;
+
+    /**
+     * Execute identical requests of the given request only once.
+     *
+     * Requests with the same payload, which arrive while the handler of the
+     * first one is running asynchronously or which are received together,
+     * share its execution and reply, e.g., to avoid a thundering herd on an
+     * expensive handler. The handler has to be a pure function of the request
+     * payload. Batches of requests are not coalesced.
+     *
+     * @param request the request of a handler registered by handle() or
+     *        handleAsync()
+     * @return true if coalescing was enabled, false if there is no handler
+     */
+    ZEROEQ_API bool enableCoalescing(const uint128_t& request);
+
+    /**
+     * Stop coalescing identical requests of the given request.
+     *
+     * @return true if the requests were coalesced
+     */
+    ZEROEQ_API bool disableCoalescing(const uint128_t& request);
+
+    /** @return the number of requests served by the execution of another. */
+    ZEROEQ_API uint64_t getNumCoalesced() const;
+
     /**
      * Get the server URI.
      *
@@ -190,7 +314,7 @@ private:
     // Receiver API
     void addSockets(std::vector<detail::Socket>& entries) final;
     bool process(detail::Socket& socket) final;
-    void addConnection(const std::string& uri) final;
+    bool addConnection(const std::string& uri) final;
 
     // Sender API
     ZEROEQ_API zmq::SocketPtr getSocket() final;
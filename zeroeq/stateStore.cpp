@@ -0,0 +1,503 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#include "stateStore.h"
+
+#include "client.h"
+#include "publisher.h"
+#include "server.h"
+#include "subscriber.h"
+
+#include "detail/byteswap.h"
+#include "detail/hashTrie.h"
+#include "log.h"
+
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace zeroeq
+{
+namespace
+{
+enum Operation
+{
+    OPERATION_SET = 0,
+    OPERATION_ERASE = 1
+};
+
+/**
+ * A decoded update: [incarnation][sequence][operation][key size][key][value]
+ *
+ * The incarnation identifies an owner instance, which restarts its sequence.
+ */
+struct Update
+{
+    uint128_t incarnation;
+    uint64_t sequence{0};
+    uint8_t operation{OPERATION_SET};
+    std::string key;
+    StateStore::Value value;
+};
+
+// Little endian wire protocol helpers
+void write(std::vector<uint8_t>& out, uint64_t value)
+{
+#ifdef ZEROEQ_BIGENDIAN
+    detail::byteswap(value);
+#endif
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(value));
+}
+
+void write(std::vector<uint8_t>& out, const uint128_t& value)
+{
+    write(out, value.high());
+    write(out, value.low());
+}
+
+void write(std::vector<uint8_t>& out, const std::string& value)
+{
+    write(out, uint64_t(value.size()));
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+class Reader
+{
+public:
+    Reader(const void* data, const size_t size)
+        : _data(static_cast<const uint8_t*>(data))
+        , _end(_data + size)
+    {
+    }
+
+    bool read(uint64_t& value)
+    {
+        if (size_t(_end - _data) < sizeof(value))
+            return false;
+        ::memcpy(&value, _data, sizeof(value));
+#ifdef ZEROEQ_BIGENDIAN
+        detail::byteswap(value);
+#endif
+        _data += sizeof(value);
+        return true;
+    }
+
+    bool read(uint128_t& value)
+    {
+        uint64_t high, low;
+        if (!read(high) || !read(low))
+            return false;
+        value = uint128_t(high, low);
+        return true;
+    }
+
+    bool read(uint8_t& value)
+    {
+        if (_data == _end)
+            return false;
+        value = *_data++;
+        return true;
+    }
+
+    bool read(std::string& value)
+    {
+        uint64_t size;
+        if (!read(size) || size > uint64_t(_end - _data))
+            return false;
+        value.assign(reinterpret_cast<const char*>(_data), size);
+        _data += size;
+        return true;
+    }
+
+    /** @return the remaining data as a string */
+    std::string rest()
+    {
+        std::string value(reinterpret_cast<const char*>(_data), _end - _data);
+        _data = _end;
+        return value;
+    }
+
+private:
+    const uint8_t* _data;
+    const uint8_t* const _end;
+};
+
+using Content = detail::HashTrie<StateStore::Value>;
+
+/** An immutable version of the store, replaced atomically on modification. */
+struct State
+{
+    State(const Content& content_, const uint64_t sequence_)
+        : content(content_)
+        , sequence(sequence_)
+    {
+    }
+
+    const Content content;
+    const uint64_t sequence;
+
+    /** @return the content as a map, copied once on first use. */
+    StateStore::MapPtr getMap() const
+    {
+        std::call_once(_copied, [this] {
+            auto map = std::make_shared<StateStore::Map>();
+            map->reserve(content.size());
+            content.forEach(
+                [&map](const std::string& key, const StateStore::Value& value) {
+                    map->emplace(key, value);
+                });
+            _map = map;
+        });
+        return _map;
+    }
+
+private:
+    mutable std::once_flag _copied;
+    mutable StateStore::MapPtr _map;
+};
+using StatePtr = std::shared_ptr<const State>;
+}
+
+class StateStore::Impl : public std::enable_shared_from_this<StateStore::Impl>
+{
+public:
+    Impl(const std::string& name, Publisher& publisher, Server& server)
+        : _name(name)
+        , _updateEvent(make_uint128("zeroeq::StateStore::" + name + "::update"))
+        , _snapshotRequest(
+              make_uint128("zeroeq::StateStore::" + name + "::snapshot"))
+        , _state(std::make_shared<State>(Content(), 0))
+        , _incarnation(servus::make_UUID())
+        , _synchronized(true)
+        , _publisher(&publisher)
+        , _server(&server)
+    {
+        if (!_server->handle(_snapshotRequest,
+                             [this](const void*, size_t) {
+                                 return _serveSnapshot();
+                             }))
+        {
+            ZEROEQTHROW(std::runtime_error("Server already serves store " +
+                                           name));
+        }
+    }
+
+    Impl(const std::string& name, Subscriber& subscriber, Client& client)
+        : _name(name)
+        , _updateEvent(make_uint128("zeroeq::StateStore::" + name + "::update"))
+        , _snapshotRequest(
+              make_uint128("zeroeq::StateStore::" + name + "::snapshot"))
+        , _state(std::make_shared<State>(Content(), 0))
+        , _subscriber(&subscriber)
+        , _client(&client)
+    {
+        if (!_subscriber->subscribe(_updateEvent,
+                                    EventPayloadFunc([this](const void* data,
+                                                            const size_t size) {
+                                        _onUpdate(data, size);
+                                    })))
+        {
+            ZEROEQTHROW(std::runtime_error("Subscriber already replicates " +
+                                           name));
+        }
+    }
+
+    ~Impl()
+    {
+        if (_server)
+            _server->remove(_snapshotRequest);
+        if (_subscriber)
+            _subscriber->unsubscribe(_updateEvent);
+    }
+
+    bool set(const std::string& key, Value value)
+    {
+        _checkOwner();
+        return _commit(getState()->content.set(key, value), OPERATION_SET, key,
+                       *value);
+    }
+
+    bool erase(const std::string& key)
+    {
+        _checkOwner();
+        return _commit(getState()->content.erase(key), OPERATION_ERASE, key,
+                       std::string());
+    }
+
+    StatePtr getState() const { return std::atomic_load(&_state); }
+
+    /** Request a snapshot from the owner, buffering updates until reply. */
+    void requestSnapshot()
+    {
+        if (_requested)
+            return;
+
+        _synchronized = false;
+        _requested = true;
+        std::weak_ptr<Impl> impl = shared_from_this();
+        const bool sent =
+            _client->request(_snapshotRequest, nullptr, 0,
+                             [impl](const uint128_t& replyID, const void* data,
+                                    const size_t size) {
+                                 auto self = impl.lock();
+                                 if (self)
+                                     self->_onSnapshot(replyID, data, size);
+                             });
+        if (!sent)
+            _requested = false; // retry on next update
+    }
+
+    const std::string _name;
+    const uint128_t _updateEvent;
+    const uint128_t _snapshotRequest;
+
+    StatePtr _state; // accessed atomically
+    uint128_t _incarnation; // of the owner, 0 until a replica synchronizes
+    std::atomic<bool> _synchronized{false};
+
+private:
+    // owner
+    Publisher* const _publisher{nullptr};
+    Server* const _server{nullptr};
+
+    // replica
+    Subscriber* const _subscriber{nullptr};
+    Client* const _client{nullptr};
+    std::deque<Update> _pending; // received while waiting for a snapshot
+    bool _requested{false};
+
+    void _checkOwner() const
+    {
+        if (!_publisher)
+            ZEROEQTHROW(std::runtime_error("Cannot modify replica of store " +
+                                           _name));
+    }
+
+    bool _commit(const Content& content, const uint8_t operation,
+                 const std::string& key, const std::string& value)
+    {
+        const uint64_t sequence = getState()->sequence + 1;
+        _store(content, sequence);
+
+        std::vector<uint8_t> buffer;
+        buffer.reserve(4 * sizeof(uint64_t) + 1 + key.size() + value.size());
+        write(buffer, _incarnation);
+        write(buffer, sequence);
+        buffer.push_back(operation);
+        write(buffer, key);
+        buffer.insert(buffer.end(), value.begin(), value.end());
+        return _publisher->publish(_updateEvent, buffer.data(), buffer.size());
+    }
+
+    void _store(const Content& content, const uint64_t sequence)
+    {
+        std::atomic_store(&_state,
+                          StatePtr(std::make_shared<State>(content, sequence)));
+    }
+
+    ReplyData _serveSnapshot() const
+    {
+        const auto state = getState(); // content and sequence are consistent
+        auto buffer = std::make_shared<std::vector<uint8_t>>();
+        write(*buffer, _incarnation);
+        write(*buffer, state->sequence);
+        write(*buffer, uint64_t(state->content.size()));
+        state->content.forEach(
+            [&buffer](const std::string& key, const Value& value) {
+                write(*buffer, key);
+                write(*buffer, *value);
+            });
+
+        servus::Serializable::Data data;
+        data.ptr = std::shared_ptr<const void>(buffer, buffer->data());
+        data.size = buffer->size();
+        return {_snapshotRequest, data};
+    }
+
+    void _onUpdate(const void* data, const size_t size)
+    {
+        Update update;
+        Reader reader(data, size);
+        if (!reader.read(update.incarnation) || !reader.read(update.sequence) ||
+            !reader.read(update.operation) ||
+            !reader.read(update.key) || update.operation > OPERATION_ERASE)
+        {
+            ZEROEQWARN << "Ignoring malformed update of store " << _name
+                       << std::endl;
+            return;
+        }
+        update.value = std::make_shared<const std::string>(reader.rest());
+
+        if (update.incarnation != _incarnation) // owner restarted
+            _synchronized = false;
+
+        if (!_synchronized)
+        {
+            // updates of a previous owner are superseded by the new one
+            if (!_pending.empty() &&
+                _pending.back().incarnation != update.incarnation)
+            {
+                _pending.clear();
+            }
+            _pending.push_back(std::move(update));
+            requestSnapshot(); // no-op if outstanding
+            return;
+        }
+
+        const auto state = getState();
+        if (update.sequence <= state->sequence) // outdated
+            return;
+        _pending.push_back(std::move(update));
+        _applyPending(state->content, state->sequence);
+    }
+
+    void _onSnapshot(const uint128_t& replyID, const void* data,
+                     const size_t size)
+    {
+        _requested = false;
+
+        uint128_t incarnation;
+        uint64_t sequence = 0;
+        uint64_t count = 0;
+        Reader reader(data, size);
+        if (replyID != _snapshotRequest || !reader.read(incarnation) ||
+            !reader.read(sequence) || !reader.read(count))
+        {
+            ZEROEQWARN << "Got no snapshot for store " << _name
+                       << ", retrying on next update" << std::endl;
+            return;
+        }
+
+        Content content;
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            std::string key;
+            auto value = std::make_shared<std::string>();
+            if (!reader.read(key) || !reader.read(*value))
+            {
+                ZEROEQWARN << "Got malformed snapshot for store " << _name
+                           << std::endl;
+                return;
+            }
+            content = content.set(key, value);
+        }
+
+        // Pending updates of another owner instance are either outdated, or
+        // newer than this snapshot. Drop them and resynchronize once more in
+        // case of the latter.
+        bool dropped = false;
+        for (auto i = _pending.begin(); i != _pending.end();)
+        {
+            if (i->incarnation == incarnation)
+                ++i;
+            else
+            {
+                i = _pending.erase(i);
+                dropped = true;
+            }
+        }
+        _incarnation = incarnation;
+        _applyPending(content, sequence);
+        if (dropped)
+        {
+            _synchronized = false;
+            requestSnapshot();
+        }
+    }
+
+    /**
+     * Apply all consecutive pending updates newer than sequence to the given
+     * content and publish the result. Requests a new snapshot on a gap.
+     */
+    void _applyPending(Content content, uint64_t sequence)
+    {
+        while (!_pending.empty())
+        {
+            const Update& update = _pending.front();
+            if (update.sequence > sequence + 1) // missed an update
+                break;
+
+            if (update.sequence == sequence + 1)
+            {
+                if (update.operation == OPERATION_ERASE)
+                    content = content.erase(update.key);
+                else
+                    content = content.set(update.key, update.value);
+                sequence = update.sequence;
+            }
+            _pending.pop_front();
+        }
+
+        _store(content, sequence);
+        _synchronized = _pending.empty();
+
+        if (!_synchronized)
+            requestSnapshot();
+    }
+};
+
+StateStore::StateStore(const std::string& name, Publisher& publisher,
+                       Server& server)
+    : _impl(std::make_shared<Impl>(name, publisher, server))
+{
+}
+
+StateStore::StateStore(const std::string& name, Subscriber& subscriber,
+                       Client& client)
+    : _impl(std::make_shared<Impl>(name, subscriber, client))
+{
+    _impl->requestSnapshot();
+}
+
+StateStore::~StateStore()
+{
+}
+
+bool StateStore::set(const std::string& key, const void* data,
+                     const size_t size)
+{
+    return _impl->set(key, std::make_shared<const std::string>(
+                               static_cast<const char*>(data), size));
+}
+
+bool StateStore::set(const std::string& key, const std::string& value)
+{
+    return _impl->set(key, std::make_shared<const std::string>(value));
+}
+
+bool StateStore::erase(const std::string& key)
+{
+    return _impl->erase(key);
+}
+
+StateStore::Value StateStore::get(const std::string& key) const
+{
+    const auto state = _impl->getState();
+    const Value* value = state->content.find(key);
+    return value ? *value : Value();
+}
+
+StateStore::MapPtr StateStore::getSnapshot() const
+{
+    return _impl->getState()->getMap();
+}
+
+uint64_t StateStore::getSequence() const
+{
+    return _impl->getState()->sequence;
+}
+
+bool StateStore::isSynchronized() const
+{
+    return _impl->_synchronized;
+}
+
+const std::string& StateStore::getName() const
+{
+    return _impl->_name;
+}
+}
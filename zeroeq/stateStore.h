@@ -0,0 +1,132 @@
+
+/* Copyright (c) 2026, agent <agent@local>
+ */
+
+#pragma once
+
+#include <zeroeq/api.h>
+#include <zeroeq/types.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace zeroeq
+{
+/**
+ * A replicated key-value store, following the ZeroMQ "clone" pattern.
+ *
+ * The owner of a store modifies it using set() and erase(). Each modification
+ * is published as an incremental update using a Publisher and the current
+ * content is served as a snapshot by a Server.
+ *
+ * A replica subscribes to the updates, requests a snapshot from the owner and
+ * applies all updates newer than the snapshot. A replica which detects a gap in
+ * the update sequence requests a new snapshot, so it never exposes partially
+ * applied state. The replica is updated during receive() of the given
+ * Subscriber and Client, which therefore should form a shared group.
+ *
+ * Each owner instance has a unique incarnation identifier. A replica detects a
+ * restarted owner by its new identifier and resynchronizes from a snapshot,
+ * even though the sequence numbers of the new owner start again at one.
+ *
+ * The given communicators have to outlive the store. Modifications and
+ * receive() are not thread safe: set() and erase() have to be called from the
+ * thread calling receive() on the server which serves the snapshots. Lookups
+ * using get() and getSnapshot() may be called from any thread: modifications
+ * create a new immutable version of the content, which is kept alive as long
+ * as readers reference it. Readers only synchronize on the atomic exchange of
+ * the version pointer, which is not lock-free on all standard libraries, but
+ * they never wait for a modification or a snapshot to be applied.
+ *
+ * Versions share all unmodified entries, so a modification or an applied
+ * update costs O(log n) in the number of entries instead of copying the
+ * content. getSnapshot() copies a version into a map on its first call.
+ *
+ * Example: @include tests/stateStore.cpp
+ */
+class StateStore
+{
+public:
+    using Value = std::shared_ptr<const std::string>;
+    using Map = std::unordered_map<std::string, Value>;
+    using MapPtr = std::shared_ptr<const Map>;
+
+    /**
+     * Create the owning instance of a store.
+     *
+     * @param name the name of the store, identifying it on the network
+     * @param publisher the publisher used to send updates
+     * @param server the server used to serve snapshots
+     * @throw std::runtime_error if the server already serves a store of the
+     *        same name
+     */
+    ZEROEQ_API StateStore(const std::string& name, Publisher& publisher,
+                          Server& server);
+
+    /**
+     * Create a replica of a store.
+     *
+     * @param name the name of the store
+     * @param subscriber the subscriber used to receive updates
+     * @param client the client used to request snapshots, typically sharing
+     *               its receive group with the subscriber. Blocks like
+     *               Client::request() until a server is connected.
+     * @throw std::runtime_error if the subscriber is already subscribed to a
+     *        store of the same name
+     */
+    ZEROEQ_API StateStore(const std::string& name, Subscriber& subscriber,
+                          Client& client);
+
+    /** Destroy this store, unregistering it from its communicators. */
+    ZEROEQ_API ~StateStore();
+
+    /**
+     * Set the value of the given key and publish the update.
+     *
+     * @return true if the update was published
+     * @throw std::runtime_error if called on a replica
+     */
+    ZEROEQ_API bool set(const std::string& key, const void* data, size_t size);
+
+    /** @sa set() */
+    ZEROEQ_API bool set(const std::string& key, const std::string& value);
+
+    /**
+     * Remove the given key and publish the update.
+     *
+     * @return true if the update was published
+     * @throw std::runtime_error if called on a replica
+     */
+    ZEROEQ_API bool erase(const std::string& key);
+
+    /** @return the value of the given key, or nullptr if not set. */
+    ZEROEQ_API Value get(const std::string& key) const;
+
+    /**
+     * @return an immutable, consistent copy of the current content, created
+     *         once per version of the content.
+     */
+    ZEROEQ_API MapPtr getSnapshot() const;
+
+    /** @return the sequence number of the last applied modification. */
+    ZEROEQ_API uint64_t getSequence() const;
+
+    /**
+     * @return true on the owner, and on a replica once it has applied a
+     *         snapshot and all subsequent updates received so far.
+     */
+    ZEROEQ_API bool isSynchronized() const;
+
+    /** @return the name of the store. */
+    ZEROEQ_API const std::string& getName() const;
+
+    class Impl;
+
+private:
+    std::shared_ptr<Impl> _impl;
+
+    StateStore(const StateStore&) = delete;
+    StateStore& operator=(const StateStore&) = delete;
+};
+}
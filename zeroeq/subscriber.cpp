@@ -5,10 +5,14 @@
  */
 
 #include "subscriber.h"
+#include "client.h"
 
 #include "detail/byteswap.h"
 #include "detail/common.h"
 #include "detail/constants.h"
+#include "detail/delta.h"
+#include "detail/fanOut.h"
+#include "detail/header.h"
 #include "detail/receiver.h"
 #include "detail/sender.h"
 #include "detail/socket.h"
@@ -19,8 +23,11 @@
 
 #include <cassert>
 #include <cstring>
+#include <deque>
+#include <iterator>
 #include <map>
 #include <stdexcept>
+#include <unordered_map>
 
 namespace zeroeq
 {
@@ -84,55 +91,306 @@ public:
         if (_eventFuncs.erase(event) == 0)
             return false;
 
+        for (auto i = _keyframes.begin(); i != _keyframes.end();)
+            i = i->first.first == event ? _keyframes.erase(i) : std::next(i);
+        _histories.erase(event);
+        _sequences.erase(event);
         _unsubscribe(event);
         return true;
     }
 
+    bool requestHistory(const uint128_t& event, const uint64_t sequence,
+                        Client& client)
+    {
+        if (_eventFuncs.count(event) == 0)
+            return false;
+
+        History& history = _histories[event];
+        if (history.pending)
+            return false;
+
+        history.pending = true;
+        history.client = &client;
+        _sequences[event] = sequence;
+        if (_requestHistory(event, history))
+            return true;
+
+        _histories.erase(event);
+        return false;
+    }
+
+    uint64_t getSequence(const uint128_t& event) const
+    {
+        const auto i = _sequences.find(event);
+        return i == _sequences.end() ? 0 : i->second;
+    }
+
     bool process(detail::Socket& socket)
     {
-        zmq_msg_t msg;
-        zmq_msg_init(&msg);
-        zmq_msg_recv(&msg, socket.socket, 0);
+        // Always serve pending high priority events first
+        const bool hadPriority = _processPriorityLanes();
+        if (_isPriorityLane(socket.socket))
+            return hadPriority;
+        return _process(socket.socket, 0) || hadPriority;
+    }
 
-        uint128_t type;
-        memcpy(&type, zmq_msg_data(&msg), sizeof(type));
-#ifndef ZEROEQ_LITTLEENDIAN
-        detail::byteswap(type); // convert from little endian wire
+    zmq::SocketPtr createSocket(const uint128_t& instance)
+    {
+        if (instance == _selfInstance)
+            return {};
+        if (!_socket)
+        {
+            _socket = _createSocket();
+            // Learn about publishers with a fan-out tree, see _processAnnounce
+            _setFilter(ZMQ_SUBSCRIBE, detail::fanout::makeAnnounceTopic(),
+                       _socket);
+        }
+        return _socket;
+    }
+
+    zmq::SocketPtr createPrioritySocket(const uint128_t& instance)
+    {
+        if (instance == _selfInstance)
+            return {};
+        if (!_prioritySocket)
+            _prioritySocket = _createSocket();
+        return _prioritySocket;
+    }
+
+    /** Tell the publishers about our connections for their fan-out tree. */
+    void connectionsChanged() final
+    {
+        if (!_socket || !_joinFanOut)
+            return;
+
+        const std::vector<std::string>& uris = getConnectionURIs();
+        const std::string& filter =
+            uris.empty() ? std::string()
+                         : detail::fanout::makeJoinFilter(_node, {}, uris);
+        if (filter == _joinFilter)
+            return;
+
+        if (!_joinFilter.empty())
+            _setFilter(ZMQ_UNSUBSCRIBE, _joinFilter, _socket);
+        if (!filter.empty())
+            _setFilter(ZMQ_SUBSCRIBE, filter, _socket);
+        _joinFilter = filter;
+    }
+
+private:
+    typedef std::map<uint128_t, EventPayloadFunc> EventFuncMap;
+    EventFuncMap _eventFuncs;
+
+    const uint128_t _selfInstance;
+    const uint128_t _node{servus::make_UUID()}; // in the fan-out tree
+    bool _joinFanOut{false}; // after a publisher announced its fan-out tree
+    std::string _joinFilter;
+
+    // One socket per lane, connected to all publishers. Created on first use.
+    zmq::SocketPtr _socket;
+    zmq::SocketPtr _prioritySocket;
+
+    // Sequences and keyframes are per publisher of an event
+    using Source = std::pair<uint128_t, uint128_t>; // event, publisher
+    struct SourceHash
+    {
+        size_t operator()(const Source& source) const
+        {
+            return source.first.low() ^ source.second.low();
+        }
+    };
+
+    struct Keyframe
+    {
+        uint64_t sequence{0};
+        std::vector<uint8_t> data;
+    };
+    std::unordered_map<Source, Keyframe, SourceHash> _keyframes; // for deltas
+    std::vector<uint8_t> _decoded;
+
+    struct Buffered
+    {
+        uint128_t publisher;
+        uint64_t sequence;
+        std::vector<uint8_t> data;
+    };
+
+    struct History
+    {
+        Client* client{nullptr};
+        uint128_t publisher; // serving the history, known after the reply
+        bool pending{false}; // buffer live events until caught up
+        std::deque<Buffered> buffered;
+    };
+    std::unordered_map<uint128_t, History> _histories; // after requestHistory
+    std::unordered_map<uint128_t, uint64_t> _sequences; // last delivered
+    std::shared_ptr<bool> _alive{std::make_shared<bool>(true)}; // for replies
+
+    bool _requestHistory(const uint128_t& event, History& history)
+    {
+        // request is [event][since sequence][max reply size]
+        const size_t maxReplySize = 1 << 20;
+        uint64_t request[] = {event.low(), event.high(), _sequences[event],
+                              maxReplySize};
+#ifdef ZEROEQ_BIGENDIAN
+        for (auto& value : request)
+            detail::byteswap(value); // convert to little endian wire
 #endif
-        const bool payload = zmq_msg_more(&msg);
-        zmq_msg_close(&msg);
+        std::weak_ptr<bool> alive = _alive;
+        return history.client->request(
+            HISTORY_REQUEST, request, sizeof(request),
+            [this, alive, event](const uint128_t& replyID, const void* data,
+                                 const size_t size) {
+                if (alive.lock())
+                    _onHistory(event, replyID, data, size);
+            });
+    }
 
-        if (payload)
+    void _onHistory(const uint128_t& event, const uint128_t& replyID,
+                    const void* data, const size_t size)
+    {
+        auto i = _histories.find(event);
+        auto func = _eventFuncs.find(event);
+        if (i == _histories.end() || !i->second.pending ||
+            func == _eventFuncs.end())
         {
-            zmq_msg_init(&msg);
-            zmq_msg_recv(&msg, socket.socket, 0);
+            return;
         }
 
-        EventFuncMap::const_iterator i = _eventFuncs.find(type);
-        if (i == _eventFuncs.cend())
+        const uint8_t* in = static_cast<const uint8_t*>(data);
+        const uint8_t* const end = in + size;
+        const auto read = [&in, end](uint64_t& value) {
+            if (end - in < ptrdiff_t(sizeof(value)))
+                return false;
+            ::memcpy(&value, in, sizeof(value));
+#ifdef ZEROEQ_BIGENDIAN
+            detail::byteswap(value); // convert from little endian wire
+#endif
+            in += sizeof(value);
+            return true;
+        };
+
+        uint64_t low, high, first, last, count;
+        if (replyID != HISTORY_REQUEST || !read(low) || !read(high) ||
+            !read(first) || !read(last) || !read(count))
         {
-            if (payload)
-                zmq_msg_close(&msg);
+            ZEROEQWARN << "No history available for event " << event
+                       << std::endl;
+            _finishHistory(event, i->second, false);
+            _histories.erase(event); // do not retry on gaps
+            return;
+        }
 
-            ZEROEQTHROW(std::runtime_error("Got unsubscribed event " +
-                                           type.getString()));
+        i->second.publisher = uint128_t(high, low);
+        uint64_t& sequence = _sequences[event];
+        if (first > sequence + 1)
+            ZEROEQWARN << "History of event " << event << " misses "
+                       << first - sequence - 1 << " events" << std::endl;
+
+        const EventPayloadFunc handler = func->second;
+        for (uint64_t j = 0; j < count; ++j)
+        {
+            uint64_t recordSequence, timestamp, recordSize;
+            if (!read(recordSequence) || !read(timestamp) ||
+                !read(recordSize) || recordSize > uint64_t(end - in))
+            {
+                ZEROEQWARN << "Got malformed history for event " << event
+                           << std::endl;
+                break;
+            }
+            if (recordSequence > sequence)
+            {
+                sequence = recordSequence;
+                handler(recordSize ? in : nullptr, recordSize);
+            }
+            in += recordSize;
         }
 
-        if (payload)
+        // continue until caught up with the publisher at reply time
+        if (count > 0 && sequence < last && _requestHistory(event, i->second))
+            return;
+        _finishHistory(event, i->second, count > 0);
+    }
+
+    /**
+     * Deliver the live events buffered during catch-up, requesting the history
+     * again on a gap if refill is set.
+     */
+    void _finishHistory(const uint128_t& event, History& history,
+                        const bool refill)
+    {
+        history.pending = false;
+        const auto func = _eventFuncs.find(event);
+        uint64_t& sequence = _sequences[event];
+        while (!history.buffered.empty() && func != _eventFuncs.end())
         {
-            i->second(zmq_msg_data(&msg), zmq_msg_size(&msg));
-            zmq_msg_close(&msg);
+            const Buffered& buffered = history.buffered.front();
+            if (buffered.publisher != history.publisher) // not caught up
+            {
+                func->second(buffered.data.data(), buffered.data.size());
+                history.buffered.pop_front();
+                continue;
+            }
+
+            if (refill && buffered.sequence > sequence + 1 &&
+                _requestHistory(event, history))
+            {
+                history.pending = true;
+                return;
+            }
+
+            if (buffered.sequence > sequence)
+            {
+                sequence = buffered.sequence;
+                func->second(buffered.data.data(), buffered.data.size());
+            }
+            history.buffered.pop_front();
         }
-        else
-            i->second(nullptr, 0);
-        return true;
+        history.buffered.clear();
     }
 
-    zmq::SocketPtr createSocket(const uint128_t& instance)
+    /**
+     * Events of other publishers than the one serving the history are
+     * delivered without catching up, their sequences are not comparable.
+     *
+     * @return true if the event is to be delivered now
+     */
+    bool _checkSequence(const uint128_t& event, const uint128_t& publisher,
+                        const uint64_t sequence, const void* data,
+                        const size_t size)
     {
-        if (instance == _selfInstance)
-            return {};
+        auto i = _histories.find(event);
+        if (i == _histories.end())
+        {
+            _sequences[event] = sequence;
+            return true;
+        }
+
+        History& history = i->second;
+        if (history.publisher != uint128_t() && publisher != history.publisher)
+            return true;
+
+        uint64_t& last = _sequences[event];
+        if (!history.pending && sequence > last + 1) // missed events
+            history.pending = _requestHistory(event, history);
+
+        if (history.pending) // catching up, deliver later
+        {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            history.buffered.push_back(
+                {publisher, sequence,
+                 std::vector<uint8_t>(bytes, bytes + size)});
+            return false;
+        }
+
+        if (sequence <= last) // already delivered from history
+            return false;
+        last = sequence;
+        return true;
+    }
 
+    zmq::SocketPtr _createSocket()
+    {
         zmq::SocketPtr socket(zmq_socket(getContext(), ZMQ_SUB),
                               [](void* s) { ::zmq_close(s); });
         const int hwm = 0;
@@ -147,6 +405,10 @@ public:
                 zmq_strerror(zmq_errno())));
         }
 
+        // Receive redirects of the fan-out tree
+        _setFilter(ZMQ_SUBSCRIBE, detail::fanout::makeRedirectTopic(_node),
+                   socket);
+
         // Add existing subscriptions to socket
         for (const auto& i : _eventFuncs)
         {
@@ -161,37 +423,235 @@ public:
         return socket;
     }
 
-private:
-    typedef std::map<uint128_t, EventPayloadFunc> EventFuncMap;
-    EventFuncMap _eventFuncs;
+    /** @return true if an event was passed to its handler */
+    bool _process(void* socket, const int flags)
+    {
+        zmq_msg_t msg;
+        zmq_msg_init(&msg);
+        if (zmq_msg_recv(&msg, socket, flags) == -1)
+        {
+            zmq_msg_close(&msg);
+            return false;
+        }
 
-    const uint128_t _selfInstance;
+        if (zmq_msg_size(&msg) == detail::fanout::topicSize)
+        {
+            if (detail::fanout::isAnnounceTopic(zmq_msg_data(&msg),
+                                                zmq_msg_size(&msg)))
+            {
+                return _processAnnounce(msg, socket);
+            }
+            return _processRedirect(msg, socket);
+        }
 
-    void _subscribe(const uint128_t& event)
-    {
-        for (const auto& socket : getSockets())
+        uint128_t type;
+        memcpy(&type, zmq_msg_data(&msg), sizeof(type));
+#ifndef ZEROEQ_LITTLEENDIAN
+        detail::byteswap(type); // convert from little endian wire
+#endif
+        const bool payload = zmq_msg_more(&msg);
+        zmq_msg_close(&msg);
+
+        detail::Header header;
+        if (payload)
         {
-            if (zmq_setsockopt(socket.second.get(), ZMQ_SUBSCRIBE, &event,
-                               sizeof(event)) == -1)
+            zmq_msg_init(&msg);
+            zmq_msg_recv(&msg, socket, 0);
+
+            if (zmq_msg_more(&msg)) // header frame before payload
             {
-                ZEROEQTHROW(std::runtime_error(
-                    std::string("Cannot update topic filter: ") +
-                    zmq_strerror(zmq_errno())));
+                const bool valid =
+                    header.read((const uint8_t*)zmq_msg_data(&msg),
+                                zmq_msg_size(&msg));
+                zmq_msg_close(&msg);
+                zmq_msg_init(&msg);
+                zmq_msg_recv(&msg, socket, 0);
+
+                if (!valid)
+                {
+                    zmq_msg_close(&msg);
+                    ZEROEQWARN << "Dropping event " << type
+                               << " with unknown header" << std::endl;
+                    return false;
+                }
             }
         }
+
+        EventFuncMap::const_iterator i = _eventFuncs.find(type);
+        if (i == _eventFuncs.cend())
+        {
+            if (payload)
+                zmq_msg_close(&msg);
+
+            ZEROEQTHROW(std::runtime_error("Got unsubscribed event " +
+                                           type.getString()));
+        }
+
+        if (!payload)
+        {
+            i->second(nullptr, 0);
+            return true;
+        }
+
+        const void* data = zmq_msg_data(&msg);
+        size_t size = zmq_msg_size(&msg);
+        if (header.encoding != detail::Header::ENCODING_PLAIN &&
+            !_decode(type, header, data, size))
+        {
+            zmq_msg_close(&msg);
+            return false;
+        }
+
+        if (header.sequence != 0 &&
+            !_checkSequence(type, header.sender, header.sequence, data, size))
+        {
+            zmq_msg_close(&msg);
+            return false;
+        }
+
+        i->second(data, size);
+        zmq_msg_close(&msg);
+        return true;
+    }
+
+    /**
+     * Join the fan-out tree of an announcing publisher, delivers no event.
+     *
+     * Join filters list all connections, so they are only sent once they are
+     * used by a publisher. The announcement is not needed afterwards.
+     */
+    bool _processAnnounce(zmq_msg_t& msg, void* socket)
+    {
+        while (zmq_msg_more(&msg))
+        {
+            zmq_msg_close(&msg);
+            zmq_msg_init(&msg);
+            zmq_msg_recv(&msg, socket, 0);
+        }
+        zmq_msg_close(&msg);
+
+        if (_joinFanOut)
+            return false;
+        _joinFanOut = true;
+        _setFilter(ZMQ_UNSUBSCRIBE, detail::fanout::makeAnnounceTopic(),
+                   _socket);
+        connectionsChanged();
+        return false;
+    }
+
+    /** Move a connection as requested by a publisher, delivers no event. */
+    bool _processRedirect(zmq_msg_t& msg, void* socket)
+    {
+        uint128_t node;
+        const bool valid = detail::fanout::parseRedirectTopic(
+                               zmq_msg_data(&msg), zmq_msg_size(&msg), node) &&
+                           node == _node;
+        std::string from, to;
+        while (zmq_msg_more(&msg))
+        {
+            zmq_msg_close(&msg);
+            zmq_msg_init(&msg);
+            zmq_msg_recv(&msg, socket, 0);
+            if (valid && !zmq_msg_more(&msg))
+                detail::fanout::parseRedirect(zmq_msg_data(&msg),
+                                              zmq_msg_size(&msg), from, to);
+        }
+        zmq_msg_close(&msg);
+
+        if (from.empty())
+            ZEROEQWARN << "Dropping malformed fan-out redirect" << std::endl;
+        else if (!redirect(from, to))
+            ZEROEQINFO << "Cannot redirect from " << from << " to " << to
+                       << std::endl;
+        return false;
+    }
+
+    /** Reconstruct the payload of a delta-encoded event in-place */
+    bool _decode(const uint128_t& event, const detail::Header& header,
+                 const void*& data, size_t& size)
+    {
+        Keyframe& keyframe = _keyframes[Source(event, header.sender)];
+        if (header.encoding == detail::Header::ENCODING_KEYFRAME)
+        {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            keyframe.data.assign(bytes, bytes + size);
+            keyframe.sequence = header.sequence;
+            return true;
+        }
+
+        // Delta to a keyframe we did not get, e.g., subscribed meanwhile
+        if (keyframe.sequence != header.keyframe || keyframe.data.empty())
+            return false;
+
+        if (!detail::decodeDelta(keyframe.data.data(), keyframe.data.size(),
+                                 data, size, header.size, _decoded))
+        {
+            ZEROEQWARN << "Dropping malformed delta for event " << event
+                       << std::endl;
+            return false;
+        }
+        data = _decoded.data();
+        size = _decoded.size();
+        return true;
+    }
+
+    bool _processPriorityLanes()
+    {
+        bool processed = false;
+        if (_prioritySocket)
+            while (_hasData(_prioritySocket.get()))
+                processed = _process(_prioritySocket.get(), 0) || processed;
+        return processed;
+    }
+
+    static bool _hasData(void* socket)
+    {
+        int events = 0;
+        size_t size = sizeof(events);
+        zmq_getsockopt(socket, ZMQ_EVENTS, &events, &size);
+        return events & ZMQ_POLLIN;
+    }
+
+    bool _isPriorityLane(const void* socket)
+    {
+        return _prioritySocket && _prioritySocket.get() == socket;
+    }
+
+    void _subscribe(const uint128_t& event)
+    {
+        _setFilter(ZMQ_SUBSCRIBE, event, _socket);
+        _setFilter(ZMQ_SUBSCRIBE, event, _prioritySocket);
     }
 
     void _unsubscribe(const uint128_t& event)
     {
-        for (const auto& socket : getSockets())
+        _setFilter(ZMQ_UNSUBSCRIBE, event, _socket);
+        _setFilter(ZMQ_UNSUBSCRIBE, event, _prioritySocket);
+    }
+
+    void _setFilter(const int option, const uint128_t& event,
+                    const zmq::SocketPtr& socket)
+    {
+        if (!socket) // filters are applied on creation
+            return;
+
+        if (zmq_setsockopt(socket.get(), option, &event, sizeof(event)) == -1)
         {
-            if (zmq_setsockopt(socket.second.get(), ZMQ_UNSUBSCRIBE, &event,
-                               sizeof(event)) == -1)
-            {
-                ZEROEQTHROW(std::runtime_error(
-                    std::string("Cannot update topic filter: ") +
-                    zmq_strerror(zmq_errno())));
-            }
+            ZEROEQTHROW(
+                std::runtime_error(std::string("Cannot update topic filter: ") +
+                                   zmq_strerror(zmq_errno())));
+        }
+    }
+
+    void _setFilter(const int option, const std::string& filter,
+                    const zmq::SocketPtr& socket)
+    {
+        if (zmq_setsockopt(socket.get(), option, filter.data(),
+                           filter.size()) == -1)
+        {
+            ZEROEQTHROW(
+                std::runtime_error(std::string("Cannot update topic filter: ") +
+                                   zmq_strerror(zmq_errno())));
         }
     }
 };
@@ -261,6 +721,17 @@ bool Subscriber::unsubscribe(const uint128_t& event)
     return _impl->unsubscribe(event);
 }
 
+bool Subscriber::requestHistory(const uint128_t& event, const uint64_t sequence,
+                                Client& client)
+{
+    return _impl->requestHistory(event, sequence, client);
+}
+
+uint64_t Subscriber::getSequence(const uint128_t& event) const
+{
+    return _impl->getSequence(event);
+}
+
 const std::string& Subscriber::getSession() const
 {
     return _impl->getSession();
@@ -281,8 +752,8 @@ void Subscriber::update()
     _impl->update();
 }
 
-void Subscriber::addConnection(const std::string& uri)
+bool Subscriber::addConnection(const std::string& uri)
 {
-    _impl->addConnection(uri);
+    return _impl->addConnection(uri);
 }
 }
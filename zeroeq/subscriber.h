@@ -38,7 +38,12 @@ public:
      * Create a default subscriber.
      *
      * Postconditions:
+     * - connects to all publishers set in the comma-separated environment
+     *   variable ZEROEQ_PUBLISHERS, and in the file named by
+     *   ZEROEQ_PUBLISHERS_FILE, watching it for changes
      * - discovers publishers on _zeroeq_pub._tcp ZeroConf service
+     * - connects to the instances in the discovery cache, if enabled by
+     *   ZEROEQ_DISCOVERY_CACHE
      * - filters session \<username\> or ZEROEQ_PUB_SESSION from environment
      *
      * @throw std::runtime_error if ZeroConf is not available
@@ -50,7 +55,12 @@ public:
      * session.
      *
      * Postconditions:
+     * - connects to all publishers set in the comma-separated environment
+     *   variable ZEROEQ_PUBLISHERS, and in the file named by
+     *   ZEROEQ_PUBLISHERS_FILE, watching it for changes
      * - discovers publishers on _zeroeq_pub._tcp ZeroConf service
+     * - connects to the instances in the discovery cache, if enabled by
+     *   ZEROEQ_DISCOVERY_CACHE
      * - filters for given session
      *
      * @param session session name used for filtering of discovered publishers
@@ -161,6 +171,34 @@ public:
 
     ZEROEQ_API bool unsubscribe(const uint128_t& event);
 
+    /**
+     * Request the history of a subscribed event after the given sequence.
+     *
+     * The history is requested from a publisher serving it using
+     * Publisher::serveHistory(), using the given client which should share
+     * its receive group with this subscriber. Historic events are passed to
+     * the event handler in order during receive(), followed by the live events
+     * published meanwhile, without gaps or duplicates. Gaps in the live events
+     * of the event later on are filled in the same way. Catching up follows
+     * the publisher serving the history, the events of other publishers of
+     * the event are delivered as they are received.
+     *
+     * @param event the subscribed event
+     * @param sequence the sequence of the last event already processed, e.g.,
+     *        from getSequence() before a restart, or 0 for the full history
+     * @param client the client to send the history request
+     * @return true if the request was sent, false if the event is not
+     *         subscribed, a request is pending or the request failed
+     */
+    ZEROEQ_API bool requestHistory(const uint128_t& event, uint64_t sequence,
+                                   Client& client);
+
+    /**
+     * @return the sequence of the last received event from a publisher with
+     *         history or delta encoding, 0 if unknown
+     */
+    ZEROEQ_API uint64_t getSequence(const uint128_t& event) const;
+
     /** @return the session name that is used for filtering. */
     ZEROEQ_API const std::string& getSession() const;
 
@@ -172,7 +210,7 @@ private:
     void addSockets(std::vector<detail::Socket>& entries) final;
     bool process(detail::Socket& socket) final;
     void update() final;
-    void addConnection(const std::string& uri) final;
+    bool addConnection(const std::string& uri) final;
 };
 }
 
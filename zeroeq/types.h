@@ -44,9 +44,11 @@
 namespace zeroeq
 {
 using servus::uint128_t;
+class Client;
 class Monitor;
 class Publisher;
 class Sender;
+class Server;
 class Subscriber;
 class URI;
 
@@ -61,12 +63,49 @@ using EventPayloadFunc = std::function<void(const void*, size_t)>;
 /** Callback for the reply of a Client::request() (reply ID, reply data). */
 using ReplyFunc = std::function<void(const uint128_t&, const void*, size_t)>;
 
+/** Reply of one server to a Client::broadcast(). */
+struct BroadcastReply
+{
+    std::string server;              //!< the URI of the server
+    bool replied{false};             //!< false if no reply before the timeout
+    uint128_t replyID;               //!< the reply identifier
+    servus::Serializable::Data data; //!< the reply payload
+};
+using BroadcastReplies = std::vector<BroadcastReply>;
+
+/** Callback for the replies of all servers to a Client::broadcast(). */
+using BroadcastFunc = std::function<void(const BroadcastReplies&)>;
+
 /** Return value of Server::handle() function (reply ID, reply data) */
 using ReplyData = std::pair<uint128_t, servus::Serializable::Data>;
 
 /** Callback for serving a Client::request() in Server::handle(). */
 using HandleFunc = std::function<ReplyData(const void*, size_t)>;
 
+/** A payload of a batch of requests, valid during the callback. */
+struct Payload
+{
+    const void* data; //!< the payload data, may be nullptr
+    size_t size;      //!< the size of the payload data, may be 0
+};
+using Payloads = std::vector<Payload>;
+
+/**
+ * Callback for serving a batch of Client::request() in Server::handleBatch(),
+ * returning one reply per request payload.
+ */
+using BatchHandleFunc = std::function<std::vector<ReplyData>(const Payloads&)>;
+
+/** Callback completing a request served by Server::handleAsync(). */
+using AsyncReplyFunc = std::function<void(const ReplyData&)>;
+
+/**
+ * Callback for serving a Client::request() in Server::handleAsync(). The
+ * request is replied once the given reply function is called, from any thread.
+ */
+using AsyncHandleFunc =
+    std::function<void(const void*, size_t, const AsyncReplyFunc&)>;
+
 #ifdef WIN32
 typedef SOCKET SocketDescriptor;
 #else
@@ -84,6 +123,13 @@ static const std::string NULL_SESSION("__null_session");
 static const std::string TEST_SESSION(servus::TEST_DRIVER);
 static const std::string ENV_PUB_SESSION("ZEROEQ_PUB_SESSION");
 static const std::string ENV_REP_SESSION("ZEROEQ_SERVER_SESSION");
+static const std::string ENV_DISCOVERY_CACHE("ZEROEQ_DISCOVERY_CACHE");
+static const std::string ENV_PUBLISHERS("ZEROEQ_PUBLISHERS");
+static const std::string ENV_PUBLISHERS_FILE("ZEROEQ_PUBLISHERS_FILE");
+static const std::string ENV_SERVERS("ZEROEQ_SERVERS");
+static const std::string ENV_SERVERS_FILE("ZEROEQ_SERVERS_FILE");
+static const std::string ENV_DIRECTORY("ZEROEQ_DIRECTORY");
+static const std::string ENV_RACK("ZEROEQ_RACK");
 
 namespace detail
 {